@@ -0,0 +1,145 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "frustum.hpp"
+#include "job_system.hpp"
+
+/* BVH CLASS
+ *
+ * A bounding volume hierarchy is a binary tree of axis aligned bounding boxes, where each leaf holds the bounds of a single object (e.g.
+ * a model) and each internal node holds the union of its children. Spatial queries (frustum, sphere, box, ray) only descend into nodes
+ * whose bounds pass the test, so they cost roughly O(log n + k) for k results rather than O(n).
+ *
+ * Objects are added as proxies. A proxy keeps an id supplied by the user (e.g. the index of a model in the scene), which is what queries
+ * return, and is identified by an integer that stays valid until the proxy is removed.
+ *
+ * The tree is dynamic:
+ *  - Leaves store "fat" bounds (the object's bounds grown by a margin), so an object that moves a small distance still fits in its leaf and
+ *    the tree does not change at all. Otherwise, the leaf is removed and reinserted next to the sibling that grows the tree the least, and
+ *    only the leaf's ancestors are refit.
+ *  - Repeated reinsertion slowly degrades the tree. When enough leaves have been reinserted, maintain() measures the tree's cost (the
+ *    surface area heuristic) and, if it has grown too much since the last build, rebuilds the tree from scratch as a background job. The
+ *    old tree stays usable until the new one is ready; changes made in the meantime are replayed onto the new tree when it is swapped in.
+ *
+ * The tree is not thread safe: apart from the background build (which only reads a copy of the leaves), it should only be used from the
+ * thread that owns it.
+ */
+class BVH {
+public:
+    // the margin (in world units) that leaves are grown by
+    BVH(const float margin = 0.1f) : margin(margin) {}
+    ~BVH() { if (building) JobSystem::get().wait(buildDone); }
+
+    BVH(const BVH&) = delete;
+    void operator=(const BVH&) = delete;
+
+    // add an object to the tree, returns the proxy used to refer to it
+    int insert(const AABB& bounds, const int userID);
+    // remove an object from the tree
+    void remove(const int proxy);
+    // give an object new bounds, returns true if its leaf had to be reinserted
+    bool update(const int proxy, const AABB& bounds);
+
+    // rebuild the whole tree immediately (e.g. after a scene is loaded)
+    void rebuild();
+    // finish a background rebuild if it is ready, or start one if the tree has degraded (call once per frame)
+    void maintain();
+
+    // each query appends the user ids of the objects whose (fat) bounds pass the test to results
+    void query(const Frustum& frustum, std::vector<int>& results) const
+        { traverse([&](const AABB& bounds) { return frustum.intersects(bounds); }, results); }
+    void query(const AABB& box, std::vector<int>& results) const
+        { traverse([&](const AABB& bounds) { return overlaps(bounds, box); }, results); }
+    void query(const glm::vec3 center, const float radius, std::vector<int>& results) const
+        { traverse([&](const AABB& bounds) { return distance2(bounds, center) <= radius * radius; }, results); }
+    void raycast(const glm::vec3 origin, const glm::vec3 dir, const float maxDistance, std::vector<int>& results) const;
+    // find the object whose bounds the ray enters first, returns its user id (or -1 if nothing is hit)
+    int pick(const glm::vec3 origin, const glm::vec3 dir, const float maxDistance = INFINITY) const;
+
+    // surface area heuristic cost: the sum of the surface areas of the internal nodes relative to the root
+    float getCost() const;
+    int getHeight() const;
+    unsigned int size() const { return nProxies; }
+    bool isRebuilding() const { return building; }
+
+    void print() const;
+
+private:
+    struct Node {
+        AABB bounds;
+        int parent = -1, left = -1, right = -1;
+        int proxy = -1;                             // only set for leaves
+        bool isLeaf() const { return left == -1; }
+    };
+    struct Proxy {
+        AABB bounds;                                // fat bounds
+        int userID = -1;
+        int leaf = -1;                              // node that holds the proxy
+        bool alive = false;
+    };
+    // a finished background build
+    struct Tree {
+        std::vector<Node> nodes;
+        int root = -1;
+    };
+
+    float margin;
+
+    std::vector<Node> nodes;
+    std::vector<int> freeNodes;
+    int root = -1;
+
+    std::vector<Proxy> proxies;
+    std::vector<int> freeProxies;
+    unsigned int nProxies = 0;
+
+    // rebuild bookkeeping
+    unsigned int nReinserts = 0;    // reinsertions since the last build
+    float builtCost = 0.0f;         // cost of the tree right after the last build
+    bool building = false;
+    JobCounter buildDone;           // the background build is a job on the engine's job system (see job_system.hpp)
+    Tree pendingBuild;
+    std::vector<int> changed;       // proxies inserted, removed, or moved while a background build was running
+
+    int allocateNode();
+    void freeNode(const int node) { nodes[node] = Node(); freeNodes.push_back(node); }
+    void insertLeaf(const int proxy);
+    void removeLeaf(const int leaf);
+    void refit(int node);
+
+    // take a copy of the live proxies and build a new tree from it (static so that it can run on another thread)
+    std::vector<std::pair<int, AABB>> getLeaves() const;
+    static Tree build(std::vector<std::pair<int, AABB>> leaves);
+    static int build(Tree& tree, std::vector<std::pair<int, AABB>>& leaves, const int begin, const int end, const int parent);
+    // replace the current tree with a newly built one
+    void swap(Tree&& tree);
+
+    static float surfaceArea(const AABB& box);
+    static bool overlaps(const AABB& a, const AABB& b);
+    static float distance2(const AABB& box, const glm::vec3 point);
+    // distance along the ray at which it enters the box (INFINITY if it misses)
+    static float intersectRay(const AABB& box, const glm::vec3 origin, const glm::vec3 invDir);
+
+    // visit every node that passes the test, collecting the user ids of the leaves
+    template <typename Test>
+    void traverse(Test test, std::vector<int>& results) const {
+        if (root == -1) return;
+        std::vector<int> stack = { root };
+        while (!stack.empty()) {
+            int node = stack.back();
+            stack.pop_back();
+            if (!test(nodes[node].bounds)) continue;
+            if (nodes[node].isLeaf()) results.push_back(proxies[nodes[node].proxy].userID);
+            else { stack.push_back(nodes[node].left); stack.push_back(nodes[node].right); }
+        }
+    }
+};
+
+#endif
@@ -21,7 +21,11 @@ enum rendering_styles {
     // Renders in 3D with lighting
     R_LIGHTING_3D = 2,
     // Renders a 3D cubemap that has orientation but no spatial position, just surrouds the viewer
-    R_SKYBOX = 3
+    R_SKYBOX = 3,
+    // Renders the material data of lit 3D models to a G-buffer without lighting them (first pass of deferred shading)
+    R_GBUFFER_3D = 4,
+    // Lights every pixel of a G-buffer by drawing a pane over the screen (second pass of deferred shading)
+    R_DEFERRED_LIGHTING = 5
 };
 enum material_styles {
     // No materials style, default setting when lighting is not enabled
@@ -33,7 +37,9 @@ enum material_styles {
     // Mateirals have both diffusive and specular lighting values (can also reflect light)
     M_DS_MAP = 3,
     // Materials have diffusive, specular, and emmissive lighting values (can emit light)
-    M_DSE_MAP = 4
+    M_DSE_MAP = 4,
+    // Any of the material styles above, chosen per draw by the type stored in the material table (see Scene::enableUberShaders())
+    M_UBER = 5
 };
 enum lighting_styles {
     // No lighting
@@ -62,7 +68,9 @@ enum texture_styles {
     // 2D textures
     T_BASIC_2D = 1,
     // 6 2D textures stitched together into a cube shape
-    T_CUBE = 2
+    T_CUBE = 2,
+    // 2D textures read from layers of 2D texture arrays (see TextureArray)
+    T_ARRAY_2D = 3
 };
 enum output_buffers {
     // Shader outputs a 3 dimensional color buffer
@@ -94,8 +102,23 @@ enum postprocessing {
 
 extern void printMat(glm::mat4 mat);        // prints a metrix to the screen
 
+// BUILD RULES
+
+// compiles the shader component files into the program, so that shaders are generated without reading /res/shaders/components/ (run
+// tools/embed_components.cpp first to generate gui/shader_components.hpp, and again whenever a component file changes)
+#define EMBED_SHADER_COMPONENTS false
+// only loads shaders that were baked to /res/shaders/saves/ by tools/shader_baker.cpp and never generates them at runtime (shaders that
+// were not baked are never ready, see Shader::isReady())
+#define REQUIRE_BAKED_SHADERS false
+
 // DEFAULT VALUES
 #define FRAME_SLOT 3
+// the targets of a G-buffer are read by the deferred lighting pass from these slots (see gbuffer_targets in frame_buffer.hpp)
+#define GBUFFER_SLOT 8
+// the light grid's texture buffers use the last slots guaranteed by OpenGL 3.3 so that they are never displaced by texture groups or frames
+#define LIGHT_DATA_SLOT 13
+#define LIGHT_GRID_SLOT 14
+#define LIGHT_INDEX_SLOT 15
 
 #define ANTI_ALIASING_SAMPLE_SIZE 4
 
@@ -0,0 +1,61 @@
+#ifndef EXTENSIONS_HPP
+#define EXTENSIONS_HPP
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <glad/glad.h>
+
+/* EXTENSIONS
+ * The engine targets the OpenGL 3.3 core profile, and GLAD only loads the functions of that profile. Some newer features are also
+ * available on most 3.3 drivers as extensions, and are worth using where they exist. r_LoadExtensions() looks for them in the bound
+ * context and loads their functions (it is called by the window whenever GLAD is loaded). Code that uses an extension must check that
+ * it is supported first, and keep a fallback that only uses the core profile.
+ */
+
+// GL_ARB_get_program_binary (core since 4.1): linked programs can be saved and loaded again without compiling their source
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#define GL_PROGRAM_BINARY_FORMATS 0x87FF
+#endif
+typedef void (APIENTRYP PFN_R_GETPROGRAMBINARY)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP PFN_R_PROGRAMBINARY)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP PFN_R_PROGRAMPARAMETERI)(GLuint program, GLenum pname, GLint value);
+extern PFN_R_GETPROGRAMBINARY r_glGetProgramBinary;
+extern PFN_R_PROGRAMBINARY r_glProgramBinary;
+extern PFN_R_PROGRAMPARAMETERI r_glProgramParameteri;
+
+// GL_KHR_parallel_shader_compile (or the ARB version): the driver compiles and links on its own threads, and can be asked whether a
+// shader or program is finished without waiting for it
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+typedef void (APIENTRYP PFN_R_MAXSHADERCOMPILERTHREADS)(GLuint count);
+extern PFN_R_MAXSHADERCOMPILERTHREADS r_glMaxShaderCompilerThreads;
+
+// GL_ARB_buffer_storage (core since 4.4): buffers with immutable storage, which can stay mapped while OpenGL reads from them
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+typedef void (APIENTRYP PFN_R_BUFFERSTORAGE)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+extern PFN_R_BUFFERSTORAGE r_glBufferStorage;
+
+// look for supported extensions in the bound context and load their functions
+extern void r_LoadExtensions(GLADloadproc load);
+// whether the bound context can save and load program binaries (with at least one binary format)
+extern bool r_HasProgramBinaries();
+// whether the bound context compiles shaders in parallel and can report their completion status
+extern bool r_HasParallelShaderCompile();
+// whether the bound context can create buffers that are persistently mapped
+extern bool r_HasBufferStorage();
+// the vendor, renderer, and version of the driver, which decide whether a saved program binary can be loaded
+extern const std::string& r_GetDriverString();
+
+#endif
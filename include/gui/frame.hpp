@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "../io/serializer.hpp"
@@ -28,6 +29,11 @@ public:
     int addPane(std::shared_ptr<RenderGroup>& renderGroup, std::unique_ptr<Pane>&& pane);
 
     void render();
+    /* Warm up every render group in the frame and its subframes, in the order they are rendered (see RenderGroup::warmUp()). Each frame's
+     * groups draw into a copy of its frame buffer that is only a few pixels wide, so that the draws cost almost nothing, but have the same
+     * format as the frame's (the default frame is taken to be a basic color buffer). The time each group took is added to times.
+     */
+    void warmUp(std::vector<std::pair<const RenderGroup*, double>>& times);
     std::shared_ptr<Texture> getFrame() const { return frameBuffer->getBuffer(); }
     bool isDefault() const { return (frameBuffer == nullptr); }
 
@@ -58,6 +64,9 @@ public:
 private:
     float paneDims[4] { -1.0f, -1.0f, 2.0f, 2.0f };
     std::shared_ptr<Model> paneModel;
+
+    // create the model that draws the frame's output(s) onto the pane
+    std::shared_ptr<Model> makePaneModel(std::shared_ptr<VertexArray> paneGeometry);
 };
 
 
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <memory>
+#include <vector>
 
 #include <glad/glad.h>
 
@@ -39,8 +40,21 @@ enum frame_buffer_call_formats {
 enum frame_buffer_types {
     FB_BASIC = 0,           // basic frame buffers simply render to an output texture
     FB_ANTI_ALIASING = 1,   // anti aliasing buffers apply anti aliasing to the output texture
-    FB_DEPTH_MAP = 2        // depth maps output a depth buffer (still in the format of a texture) instead of a color buffer
+    FB_DEPTH_MAP = 2,       // depth maps output a depth buffer (still in the format of a texture) instead of a color buffer
+    FB_GBUFFER = 3          // G-buffers output several color buffers at once plus a depth buffer, all as textures (see below)
 };
+/* G-buffer targets, in the order of their color attachments. The geometry pass of deferred shading writes view space normals (with the
+ * material's shininess in w), and the ambient, diffuse, and specular colors of the material (with the emission color spread over their 
+ * alpha channels). The lighting pass reconstructs positions from the depth target.
+ */
+enum gbuffer_targets {
+    GB_NORMAL = 0,
+    GB_AMBIENT = 1,
+    GB_DIFFUSE = 2,
+    GB_SPECULAR = 3,
+    GB_DEPTH = 4
+};
+#define N_GBUFFER_TARGETS 5
 
 /* FRAME BUFFER CLASS
  * 
@@ -94,6 +108,9 @@ public:
 
     // retrieve a pointer to the frame buffer's output texture
     std::shared_ptr<Texture> getBuffer() { return t_buffer; }
+    // retrieve one of the output textures of a frame buffer with several outputs (e.g. a G-buffer target)
+    std::shared_ptr<Texture> getBuffer(const unsigned int target) { return t_targets[target]; }
+    unsigned int nBuffers() const { return (t_targets.size() > 0) ? t_targets.size() : 1; }
 
     // determining which rendering options are enabled for the frame buffer
     bool isDepthEnabled() const { return depth_enabled; }
@@ -102,6 +119,10 @@ public:
     // apply anti aliasing post-processing to the frame
     void applyAntiAliasing();
 
+    // create a frame buffer of the same type and format that is only size x size pixels (e.g. to warm up shaders, see Frame::warmUp())
+    std::unique_ptr<FrameBuffer> makeCopy(const int size) const
+        { return std::make_unique<FrameBuffer>(type, call_format, size, size, n_channels, depth_enabled); }
+
     Serializer getJSON();
 private:
     // id used to refer to the parallel openGL frame buffer object
@@ -113,6 +134,7 @@ private:
     int width, height;
     unsigned int n_channels;
     std::shared_ptr<Texture> t_buffer = nullptr;
+    std::vector<std::shared_ptr<Texture>> t_targets;    // only used by frame buffers with several outputs
 
     // parameters related to the depth buffer
     bool depth_enabled;
@@ -127,6 +149,7 @@ private:
     void makeBasic();           // sets up a basic frame buffer
     void makeAntiAliasing();    // sets up an anti aliasing frame buffer
     void makeDepthMap();        // sets up a depth map
+    void makeGBuffer();         // sets up a G-buffer
 
     // a bind function that allows the openGL object's id to be specified (instead of assuming that it is frameBufferID)
     // used when there are multiple OpenGL frame buffer objects
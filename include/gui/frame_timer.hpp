@@ -0,0 +1,62 @@
+#ifndef FRAME_TIMER_HPP
+#define FRAME_TIMER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+#include <glad/glad.h>
+
+#include "elements.hpp"
+
+/* FRAME TIMER CLASS
+ *
+ * The frame timer measures how long each frame takes on the CPU and on the GPU, so that rendering settings can be compared on the same
+ * scene (e.g. one program per material style against uber shaders, see Scene::enableUberShaders()). CPU time is the wall time between
+ * begin() and end(). GPU time is measured by a timer query (GL_TIME_ELAPSED) around the same commands.
+ *
+ * Like occlusion queries, a frame's timer query is only read back once the GPU has finished with it, so the CPU never waits on the GPU.
+ * The timer keeps a small ring of queries and results arrive a few frames late. If every query in the ring is still pending, the frame
+ * is timed on the CPU only. Times are averaged over every frame since the last reset().
+ *
+ * Like other objects with parallel OpenGL objects, frame timers should not be copied.
+ */
+class FrameTimer {
+public:
+    FrameTimer();
+    ~FrameTimer();
+
+    FrameTimer(const FrameTimer&) = delete;
+    void operator=(const FrameTimer&) = delete;
+
+    // wrap the commands of a frame
+    void begin();
+    void end();
+    // forget the frames timed so far (results of queries that are still pending are dropped)
+    void reset();
+
+    // average time per frame in milliseconds, and the number of frames each average is taken over
+    double getCPUTime() const { return (nCPUFrames > 0) ? cpuTime / nCPUFrames : 0.0; }
+    double getGPUTime() const { return (nGPUFrames > 0) ? gpuTime / nGPUFrames : 0.0; }
+    unsigned int nFrames() const { return nCPUFrames; }
+
+    void print() const;
+private:
+    static const unsigned int N_QUERIES = 4;
+    struct Query {
+        unsigned int queryID;
+        bool pending = false;       // issued but not yet read back
+    };
+    Query queries[N_QUERIES];
+    unsigned int next = 0;          // the query that times the next frame
+    bool timing = false;            // whether the current frame is inside a timer query
+
+    std::chrono::steady_clock::time_point start;
+    double cpuTime = 0.0, gpuTime = 0.0;
+    unsigned int nCPUFrames = 0, nGPUFrames = 0;
+
+    // read back the results of any queries that have finished (never waits for the GPU)
+    void update();
+};
+
+#endif
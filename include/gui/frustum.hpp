@@ -0,0 +1,60 @@
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <glm/glm.hpp>
+
+/* AABB STRUCT
+ *
+ * An axis aligned bounding box, stored by its minimum and maximum corners. Vertex arrays store the bounds of their vertices in mesh space
+ * and models store the bounds of their vertex array in world space, which are used to cull models that cannot be seen.
+ *
+ * A default constructed box is empty (min > max); expanding it by any point makes it valid.
+ */
+struct AABB {
+    glm::vec3 min = glm::vec3(INFINITY), max = glm::vec3(-INFINITY);
+
+    AABB() {}
+    AABB(const glm::vec3 min, const glm::vec3 max) : min(min), max(max) {}
+
+    // an empty box has no points in it, empty boxes are never culled since nothing is known about the geometry
+    bool isEmpty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+    glm::vec3 getCenter() const { return 0.5f * (min + max); }
+    glm::vec3 getExtent() const { return 0.5f * (max - min); }
+
+    // grow the box to contain a point or another box
+    void expand(const glm::vec3 point) { min = glm::min(min, point); max = glm::max(max, point); }
+    void expand(const AABB& other) { min = glm::min(min, other.min); max = glm::max(max, other.max); }
+
+    // find the box that bounds this box after it has been transformed (e.g. from mesh space to world space)
+    AABB transform(const glm::mat4& mat) const;
+
+    void print() const;
+};
+
+/* FRUSTUM CLASS
+ *
+ * The frustum is the volume of space that a projection can see, bounded by 6 planes (left, right, bottom, top, near, far). The planes are
+ * extracted directly from a clip space transformation (projection * view), so the same class works for the camera and for the
+ * orthographic and perspective transformations of shadow casting lights (see Light::getLightTransform()).
+ *
+ * Plane normals point into the frustum. A box is outside of the frustum if it is entirely behind any one plane. The test is conservative:
+ * a box near a corner of the frustum may be kept even though it is not visible, but a visible box is never culled.
+ */
+class Frustum {
+public:
+    // extract the frustum planes from a clip space transformation
+    Frustum(const glm::mat4& clipMat);
+
+    // test whether any part of a (world space) box might be inside the frustum
+    bool intersects(const AABB& box) const;
+
+private:
+    // each plane is stored as (normal, distance), so a point p is inside the plane if dot(normal, p) + distance >= 0
+    glm::vec4 planes[6];
+};
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+/* JOB COUNTER
+ *
+ * A job counter tracks how many jobs of a batch have not finished yet. Submitting a job with a counter increments it and the job decrements
+ * it when it is done, so the batch is finished once the counter is back at zero. Other jobs can depend on a counter, in which case they are
+ * only queued once it reaches zero (see JobSystem::submitAfter()).
+ *
+ * A counter must outlive the jobs that use it (wait on it before destroying it), and should not be reused for a new batch until the jobs that
+ * depend on it have been queued.
+ */
+class JobCounter {
+public:
+    JobCounter() {}
+
+    JobCounter(const JobCounter&) = delete;
+    void operator=(const JobCounter&) = delete;
+
+    bool isDone() const { return count.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    // a job waiting on this counter (and the counter of that job)
+    struct Dependent {
+        std::function<void()> func;
+        JobCounter* counter = nullptr;
+        bool background = false;
+    };
+
+    std::atomic<int> count = 0;
+    std::mutex dependentsLock;
+    std::vector<Dependent> dependents;
+};
+
+/* JOB SYSTEM CLASS
+ *
+ * The job system runs small pieces of work (jobs) on a fixed set of worker threads, so that any part of the engine (culling, mesh generation,
+ * texture decoding, serialization) can spread its work over every core without creating threads of its own.
+ *
+ * Scheduling is work stealing: every thread has its own deque of jobs. A thread pushes the jobs it submits to the back of its own deque and
+ * takes jobs from the back as well, so related work stays on the same core, while an idle thread steals the oldest job from the front of
+ * another thread's deque. Workers keep looking for work as long as any job is queued and only sleep once every deque is empty.
+ *
+ * The thread that creates the job system is its main thread, which is expected to own the OpenGL context. The main thread has a deque of
+ * its own (it runs jobs while it waits on a counter), and it also has a separate queue of jobs that only it may run, for work that has to
+ * call OpenGL (e.g. uploading a texture that a worker has decoded). Those jobs run when the main thread calls runMainJobs() or waits.
+ *
+ * Affinity works the other way too: background jobs (see submitBackground()) are only ever run by workers, for long work that the frame
+ * doesn't wait on (e.g. decoding a texture or rebuilding a tree). They are pushed to the workers' deques, and a waiting main thread only
+ * steals the jobs around them, so a frame never picks up a background job while it waits on its own. Jobs submitted by a background job
+ * are background jobs as well. There is always at least one worker, so background jobs make progress even on a single core.
+ *
+ * Jobs should not block on anything other than JobSystem::wait(), which keeps running other jobs until the counter is done.
+ */
+class JobSystem {
+public:
+    // creates nWorkers threads (at least one) in addition to the calling thread, which becomes the main thread
+    JobSystem(const unsigned int nWorkers = std::max(2u, std::thread::hardware_concurrency()) - 1);
+    // jobs that are still queued when the job system is destroyed are never run
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    void operator=(const JobSystem&) = delete;
+
+    // the engine wide job system, created on first use (which should happen on the main thread)
+    static JobSystem& get();
+
+    // queue a job, incrementing counter (if given) until the job has run
+    void submit(std::function<void()> job, JobCounter* counter = nullptr);
+    // queue a job once dependency reaches zero (the job's counter is incremented immediately)
+    void submitAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter = nullptr);
+    // queue a job that can only be run by the main thread
+    void submitMain(std::function<void()> job, JobCounter* counter = nullptr);
+    // queue a job that can only be run by a worker
+    void submitBackground(std::function<void()> job, JobCounter* counter = nullptr);
+
+    // run other jobs until the counter reaches zero (the main thread leaves background jobs to the workers)
+    void wait(JobCounter& counter);
+    // run every job queued for the main thread (call once per frame from the main thread)
+    void runMainJobs();
+
+    // call func(i) for every i in [0, n), in jobs of up to batchSize indices each, and wait for all of them to finish
+    template <typename Func>
+    void parallelFor(const unsigned int n, const unsigned int batchSize, Func func) {
+        if (n == 0) return;
+        // a single batch is not worth the overhead of a job
+        if (n <= batchSize) {
+            for (unsigned int i = 0; i < n; i++) func(i);
+            return;
+        }
+        JobCounter counter;
+        for (unsigned int begin = 0; begin < n; begin += batchSize) {
+            unsigned int end = std::min(begin + batchSize, n);
+            submit([&func, begin, end]() { for (unsigned int i = begin; i < end; i++) func(i); }, &counter);
+        }
+        wait(counter);
+    }
+
+    unsigned int nWorkers() const { return threads.size(); }
+    bool isMainThread() const { return std::this_thread::get_id() == mainThread; }
+
+    void print() const;
+
+private:
+    struct Job {
+        std::function<void()> func;
+        JobCounter* counter = nullptr;
+        bool background = false;        // whether only workers may run the job
+    };
+    struct Deque {
+        std::mutex lock;
+        std::deque<Job> jobs;
+    };
+
+    std::thread::id mainThread;
+    std::vector<std::thread> threads;
+    // deque 0 belongs to the main thread, deque i to worker i - 1
+    std::vector<std::unique_ptr<Deque>> deques;
+    Deque mainJobs;
+
+    // number of jobs in the deques, workers only sleep when it is zero
+    std::atomic<int> pending = 0;
+    std::atomic<bool> stopping = false;
+    std::mutex sleepLock;
+    std::condition_variable wake;
+
+    // used to spread background jobs and jobs submitted from threads without a deque of their own over the workers
+    std::atomic<unsigned int> nextDeque = 0;
+
+    void workerLoop(const unsigned int index);
+    // push a job to the calling thread's deque (or to a worker's deque if the calling thread doesn't have one, or if it is the main thread
+    // and the job is a background job)
+    void push(Job&& job);
+    // take a job from the back of the calling thread's deque, or steal one from the front of another deque (skipping background jobs if
+    // the calling thread is the main thread)
+    bool pop(const int index, Job& job);
+    void run(Job& job);
+    // called when a job finishes, queues the jobs that depended on its counter if it reached zero
+    void finish(JobCounter* counter);
+};
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef LIGHT_HPP
 #define LIGHT_HPP
 
+#include <cmath>
 #include <iostream>
 #include <string>
 
@@ -17,17 +18,32 @@
  * Lights store data used for lighting calculations within a shader. Lights should be not be thought of as actual light models that appear 
  * on screen. Rather, these are abstract light objects strictly used to make calculations. 
  * 
- * The light object can be easily written to or animated and the shader class can recieve it as a format to be easily update uniforms in
- * the shader program itself. Even though there are multiple types of lights, all lights are stored as a single uniform array within the shader program. The shader 
- * knows how to differentiate between light types and can, to some degree, mix and match light types where possible.
+ * The light object can be easily written to or animated, and each frame the scene packs every light into the light grid's buffers (see
+ * light_grid.hpp), so there is no limit on the number of lights. Even though there are multiple types of lights, all lights are stored in
+ * the same format. The shader knows how to differentiate between light types and can, to some degree, mix and match light types where
+ * possible.
  * 
  * Light objects also store shadow maps that are used to buffer shadow data which is later sent to a second pass rendering pipeline. The
  * light object is also responsable for making calculations related to shadow geometry, and as such also stores certain data related to 
  */
 
 // type list for lights
-extern const int MAX_LIGHTS;    // shaders cannot store dynamic arrays so the max number of lights in a scene must be specified
-extern const std::string LIGHT_NAME;    // the name of the uniform used to store light data in a shader
+extern const int MAX_SHADOW_MAPS;   // shaders cannot index sampler arrays freely, so only this many lights (the first ones) cast shadows
+
+/* LIGHT DATA STRUCT
+ *
+ * Packed form of a light as it is stored in the light grid's light buffer (see light_grid.hpp), where each light takes 6 RGBA32F texels.
+ * Each vec3 is followed by a scalar that fills the rest of its texel, and the type is stored as the bits of an int (read with
+ * floatBitsToInt() in f_lighting.glsl). The field order here must match fetchLight() in the shader exactly.
+ */
+struct LightData {
+    glm::vec3 pos;      int type;
+    glm::vec3 dir;      float constant;
+    glm::vec3 ambient;  float linear;
+    glm::vec3 diffuse;  float quadratic;
+    glm::vec3 specular; float inner;
+    float outer;        float padding[3];
+};
 
 struct Light {
     /* The light class contains all possible lighting parameters so that lights are, to some degree, not rigidly constrained to the kind of
@@ -112,6 +128,11 @@ struct Light {
     void setLightTransform(const glm::vec3 target);
     glm::mat4 getLightTransform() const { return lightTransform; };
 
+    // distance beyond which the light's attenuation drops below the cutoff, infinite for lights that light the whole scene
+    float getRange() const;
+    // pack the light into its buffer layout, converting spatial vectors into the view space of the camera
+    LightData getData(const glm::mat4& view) const;
+
     void setShadowMapSlot(const int slot) { shadowMap = slot; }
     // modify and retrieve the slot value of shadow maps (necessary for properly slotting them when rendering a complete scene)
     int getShadowMapSlot() const { return shadowMap; }
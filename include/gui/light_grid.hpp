@@ -0,0 +1,89 @@
+#ifndef LIGHT_GRID_HPP
+#define LIGHT_GRID_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "camera.hpp"
+#include "elements.hpp"
+#include "light.hpp"
+#include "texture.hpp"
+
+// number of clusters the view fustrum is divided into along the screen's x and y axes and along the view depth
+extern const int CLUSTERS_X, CLUSTERS_Y, CLUSTERS_Z;
+
+/* LIGHT GRID BLOCK
+ *
+ * CPU side mirror of the "Lights" uniform block (f_lighting.glsl), which tells fragment shaders how to find their cluster.
+ */
+struct LightGridBlock {
+    glm::ivec4 dim;     // number of clusters along x, y and z, w is the number of global lights (listed first in the index buffer)
+    glm::vec4 scale;    // x, y: clusters per pixel, z: depth slices per unit of log depth, w: near plane of the camera
+    int nLights;        // total number of lights in the light buffer
+    int padding[3];
+};
+
+/* LIGHT GRID CLASS
+ *
+ * The light grid implements clustered forward shading, which allows a scene to have any number of lights while each fragment only
+ * shades the lights that can actually reach it. The camera's view fustrum is divided into CLUSTERS_X * CLUSTERS_Y screen tiles and
+ * CLUSTERS_Z depth slices (spaced exponentially, so that clusters stay roughly cubic), and every frame each light is assigned to the
+ * clusters that its range overlaps. A fragment finds its cluster from its screen position and view depth, then loops over that cluster's
+ * lights only.
+ *
+ * The result is stored in three texture buffers, which shaders read with texelFetch():
+ *  - light data:       every light in view space (6 RGBA32F texels per light, see LightData in light.hpp)
+ *  - light grid:       an (offset, count) pair for every cluster (RG32UI)
+ *  - light indices:    the global lights (those with an infinite range, e.g. directional lights), followed by the light list of every
+ *                      cluster (R32UI)
+ *
+ * Lights are assigned on the CPU using a conservative screen space bound of their range, so a light may be listed in a few clusters it
+ * does not quite reach, but never left out of one it does.
+ */
+class LightGrid {
+public:
+    // the grid needs the size (in pixels) of the frame that lit shaders render to
+    LightGrid(const int width, const int height);
+
+    LightGrid(const LightGrid&) = delete;
+    void operator=(const LightGrid&) = delete;
+
+    // assign lights to clusters for the camera's current view and upload the results to the texture buffers
+    void update(const std::vector<std::shared_ptr<Light>>& lights, const Camera& camera);
+    // bind all texture buffers to their slots
+    void bind() const { lightData.bind(); lightGrid.bind(); lightIndices.bind(); }
+
+    // retrieve the uniform block data that describes the grid (written by the scene to the "Lights" uniform buffer)
+    const LightGridBlock& getBlock() const { return block; }
+
+    // print statistics about the last light assignment
+    void print() const;
+private:
+    // the range of clusters a light overlaps (inclusive), if the light is not visible, valid will be false
+    struct ClusterBounds {
+        bool valid = false;
+        glm::ivec3 min, max;
+    };
+
+    int width, height;
+    LightGridBlock block;
+
+    TextureBuffer lightData, lightGrid, lightIndices;
+
+    // buffers are kept between frames so they do not need to be reallocated
+    std::vector<LightData> data;
+    std::vector<ClusterBounds> bounds;
+    std::vector<unsigned int> grid, indices;
+
+    // find the clusters overlapped by a sphere in view space
+    ClusterBounds getClusterBounds(const glm::vec3 center, const float radius, const glm::mat4& proj) const;
+    // convert a view depth into a depth slice
+    int getSlice(const float depth) const;
+};
+
+#endif
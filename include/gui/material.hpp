@@ -1,6 +1,7 @@
 #ifndef MATERIAL_HPP
 #define MATERIAL_HPP
 
+#include <cstddef>
 #include <iostream>
 #include <string>
 
@@ -22,7 +23,24 @@
 ///TODO: Functions for returning various material types instead of having to fill out the array manually
 
 extern const unsigned int N_TEXTURES[]; // each material requires a specific number of textures, e.g. N_TEXTURES[D_MAP] = 1
-extern const std::string MAT_NAME[];    // each material uses a specific variable name, e.g. MAT_NAME[D_MAP] = "dMap"
+extern const std::string MAP_NAME[];    // each texture type is read by a specific sampler, e.g. MAP_NAME[DIFFUSE] = "maps.diffuse"
+const unsigned int N_MATERIAL_MAPS = 3;     // the most maps a material can have (diffuse, specular, and emission)
+extern const unsigned int MAX_MATERIALS;    // size of the material table in shaders (must match MAX_MATERIALS in f_material.glsl)
+
+/* MATERIAL DATA STRUCT
+ *
+ * Every material in a scene is packed into a single table (the "Materials" uniform block in f_material.glsl) when the scene is loaded, so
+ * a draw call only needs to tell the shader the index of its material. This is the std140 layout of a table entry: three vec4 colors,
+ * where the w component of specular holds the shininess, and the texture array layers of the diffuse, specular and emission maps. Values
+ * that a material takes from textures are left at zero, as are the layers of maps that are not stored in texture arrays. The w component
+ * of maps holds the material's type, which uber shaders branch on to shade every material style with one program (see M_UBER).
+ */
+struct MaterialData {
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    glm::ivec4 maps;
+};
 
 struct Material {
     unsigned int type;
@@ -52,7 +70,14 @@ struct Material {
     Material(int diffuse, int specular, int emission, float shininess);
     Material(Serializer& object);
 
-    bool operator==(Material& other);
+    bool operator==(const Material& other) const;
+    // hash of the material's values (consistent with operator==), so that a scene can find an equal material with one hash lookup
+    std::size_t hash() const;
+
+    // pack the material into its table entry
+    MaterialData getData() const;
+    // the texture slot of one of the material's maps (DIFFUSE, SPECULAR or EMISSION), or -1 if the material doesn't have that map
+    int getSlot(const unsigned int map) const;
 
     Serializer getJSON();
 };
@@ -13,7 +13,9 @@
 #include "elements.hpp"
 #include "light.hpp"
 #include "material.hpp"
+#include "model_store.hpp"
 #include "texture.hpp"
+#include "transform.hpp"
 #include "vertex_array.hpp"
 
 /* MODEL STRUCT
@@ -83,18 +85,38 @@ public:
                color == other.color;
     }
 
-    // change the position, size, or orientation of the model
-    void move(const glm::vec3 pos) { this->pos = pos; setModel(); }
-    void grow(const glm::vec3 scale) { this->scale = scale; setModel(); }
-    void rotate(const glm::vec3 aos, const float angle) { this->aos = aos; this->angle = angle; setModel(); }
+    /* Change the position, size, or orientation of the model. Once the model is part of a loaded scene, these are relative to the model's
+     * parent (see Scene::attachModel()) and the model matrix is updated by the scene's transform hierarchy before the next frame is drawn.
+     */
+    void move(const glm::vec3 pos) { this->pos = pos; (hierarchy != nullptr) ? hierarchy->setPos(node, pos) : setModel(); }
+    void grow(const glm::vec3 scale) { this->scale = scale; (hierarchy != nullptr) ? hierarchy->setScale(node, scale) : setModel(); }
+    void rotate(const glm::vec3 aos, const float angle) {
+        this->aos = aos;
+        this->angle = angle;
+        (hierarchy != nullptr) ? hierarchy->setRotation(node, aos, angle) : setModel();
+    }
 
     // get/set model transformation that transforms from mesh space to world space
     void setModel();
-    glm::mat4 getModel() const { return model; }
+    glm::mat4 getModel() const { return (store != nullptr) ? store->getTransform(handle) : model; }
+    // the normal matrix transforms normals from mesh to world space, it only changes with the model so it is cached here
+    glm::mat3 getNormal() const { return (store != nullptr) ? store->getNormal(handle) : normal; }
+    // bounds of the model in world space, used to cull models that are outside of the camera's (or a light's) view
+    const AABB& getBounds() const { return (store != nullptr) ? store->getBounds(handle) : bounds; }
+
+    /* Copy the model's per frame data into a model store (see model_store.hpp), after which the store holds the model's transformation and
+     * the model only acts as a handle to it. A model can only belong to one store.
+     */
+    void addToStore(std::shared_ptr<ModelStore> store);
+    // copy the model's transformation back out of its store and free its handle, after which the model can be added to a store again
+    void removeFromStore();
+    unsigned int getHandle() const { return handle; }
 
     // retrieve the current position of the model in world space
     unsigned int getType() const { return type; }
     unsigned int getMaterialType() const { return (material != nullptr) ? material->type : M_DISABLED; }
+    // index of the model's material in the scene's material table (assigned when the scene is loaded)
+    int getMaterialIndex() const { return materialIndex; }
     unsigned int getTextureType() const { return (textureGroup != nullptr) ? textureGroup->getType() : T_DISABLED; }
     glm::vec3 getPos() const { return pos; }
     glm::vec3 getColor() const { return color; }
@@ -102,7 +124,7 @@ public:
     // retrieve non-modifiable copies of the constituent parts of the model
     std::shared_ptr<VertexArray> getVertexArray() const { return vertexArray; }
     std::shared_ptr<TextureGroup> getTextureGroup() const { return textureGroup; }
-    std::shared_ptr<Material> getMaterial() const { return material; }
+    const std::shared_ptr<Material>& getMaterial() const { return material; }
 
     // based on existing texture data, create a material for a model
     void generateMaterial(const glm::vec3 specular, const float shininess);
@@ -119,6 +141,7 @@ private:
     std::shared_ptr<VertexArray> vertexArray;
     std::shared_ptr<TextureGroup> textureGroup = nullptr;
     std::shared_ptr<Material> material = nullptr;
+    int materialIndex = 0;
 
     // transformation information for translating from mesh to world space
     // pos - translates to center on pos vector; scale – scales by coefficients in scale vector; 
@@ -127,6 +150,16 @@ private:
     float angle;
     // transformation matrix from mesh to world space
     glm::mat4 model;
+    // inverse transpose of the model matrix (for lighting)
+    glm::mat3 normal;
+    // world space bounds of the vertex array (updated with the model matrix)
+    AABB bounds;
+    // the transform hierarchy that owns the model's transformation (set by the scene when it is loaded) and the model's node in it
+    TransformHierarchy* hierarchy = nullptr;
+    int node = -1;
+    // the store that holds the model's per frame data, and the model's handle in it
+    std::shared_ptr<ModelStore> store = nullptr;
+    unsigned int handle = 0;
 
     // non-lighted models sometimes need a color
     glm::vec3 color;
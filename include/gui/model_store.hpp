@@ -0,0 +1,90 @@
+#ifndef MODEL_STORE_HPP
+#define MODEL_STORE_HPP
+
+#include <iostream>
+#include <unordered_map>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "frustum.hpp"
+#include "texture.hpp"
+#include "vertex_array.hpp"
+
+struct Model;
+
+// per model flags kept by the model store
+enum model_flags {
+    MF_MOVED = 1    // the model's transformation changed since the scene last updated its bounds in the model tree
+};
+
+/* MODEL STORE CLASS
+ *
+ * The model store holds the data that is read for every model every frame (transformations, bounds, mesh, texture group, material index,
+ * color, and flags) in dense arrays, one array per component. Per frame loops (culling, sorting, setting uniforms, drawing) walk these
+ * arrays by handle instead of following each model's pointers to its vertex array, texture group, and material.
+ *
+ * Meshes and texture groups are stored once each in a table, and models refer to them by ID. The IDs double as state keys for sorting,
+ * since models with the same IDs can be drawn without binding anything new.
+ *
+ * A handle is the index of a model's components. A handle stays valid until its model is removed from the store, after which the slot is
+ * reused by the next model that is added.
+ * The Model object remains the interface to a model: once it is added to a store, it writes changes to its transformation through to the
+ * store (see Model::setModel()).
+ */
+class ModelStore {
+public:
+    ModelStore() {}
+
+    ModelStore(const ModelStore&) = delete;
+    void operator=(const ModelStore&) = delete;
+
+    // copy a model's components into the store, returns the model's handle
+    unsigned int add(const Model& model);
+    // free a model's slot (see Model::removeFromStore())
+    void remove(const unsigned int handle);
+    // write a new transformation (and the bounds that follow from it) to the store, and flag the model as moved
+    void setTransform(const unsigned int handle, const glm::mat4& transform, const glm::mat3& normal, const AABB& bounds);
+    void setTransform(const unsigned int handle, const glm::mat4& transform, const glm::mat3& normal)
+        { setTransform(handle, transform, normal, getMesh(handle).getBounds().transform(transform)); }
+    void clearMoved(const unsigned int handle) { flags[handle] &= ~MF_MOVED; }
+
+    const glm::mat4& getTransform(const unsigned int handle) const { return transforms[handle]; }
+    const glm::mat3& getNormal(const unsigned int handle) const { return normals[handle]; }
+    const AABB& getBounds(const unsigned int handle) const { return bounds[handle]; }
+    int getMaterialIndex(const unsigned int handle) const { return materialIndices[handle]; }
+    glm::vec3 getColor(const unsigned int handle) const { return colors[handle]; }
+    bool isMoved(const unsigned int handle) const { return flags[handle] & MF_MOVED; }
+
+    unsigned int getMeshID(const unsigned int handle) const { return meshIDs[handle]; }
+    unsigned int getTextureGroupID(const unsigned int handle) const { return textureGroupIDs[handle]; }
+    const VertexArray& getMesh(const unsigned int handle) const { return *meshes[meshIDs[handle]]; }
+    // nullptr if the model has no textures
+    const std::shared_ptr<const TextureGroup>& getTextureGroup(const unsigned int handle) const
+        { return textureGroups[textureGroupIDs[handle]]; }
+
+    // the number of slots (handles are always less than this), some of which may be free
+    unsigned int size() const { return transforms.size(); }
+
+    void print() const;
+
+private:
+    // components, indexed by handle
+    std::vector<glm::mat4> transforms;
+    std::vector<glm::mat3> normals;
+    std::vector<AABB> bounds;
+    std::vector<unsigned int> meshIDs, textureGroupIDs;
+    std::vector<int> materialIndices;
+    std::vector<glm::vec3> colors;
+    std::vector<unsigned char> flags;
+    std::vector<unsigned int> freeHandles;
+
+    // tables of the meshes and texture groups used by the models (texture group 0 is always "no textures")
+    std::vector<std::shared_ptr<const VertexArray>> meshes;
+    std::vector<std::shared_ptr<const TextureGroup>> textureGroups = { nullptr };
+    std::unordered_map<const VertexArray*, unsigned int> mesh_lookup;
+    std::unordered_map<const TextureGroup*, unsigned int> textureGroup_lookup = { { nullptr, 0 } };
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef OCCLUSION_HPP
+#define OCCLUSION_HPP
+
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "elements.hpp"
+
+/* OCCLUSION QUERIES CLASS
+ *
+ * Occlusion queries ask the GPU whether any samples of a draw call passed the depth test. A render group that uses occlusion culling keeps
+ * one query per model: each frame, a visible model's draw is wrapped in its query, and the result is read back in a later frame, once the
+ * GPU has finished with it, so the CPU never waits on the GPU. Models whose last result was "no samples passed" are not drawn; instead, a
+ * box around their bounds is drawn with color and depth writes disabled, inside the same query, to find out when they become visible
+ * again (see RenderGroup::cullOccluded() and RenderGroup::testOccluded()).
+ *
+ * If a query issued for a visible model has not finished by the next frame, the model is drawn with conditional rendering on that query
+ * instead, which lets the GPU skip the draw if the query turns out to have failed, again without stalling the CPU.
+ *
+ * Like other objects with parallel OpenGL objects, occlusion queries should not be copied.
+ */
+class OcclusionQueries {
+public:
+    OcclusionQueries() {}
+    ~OcclusionQueries();
+
+    OcclusionQueries(const OcclusionQueries&) = delete;
+    void operator=(const OcclusionQueries&) = delete;
+
+    // make sure there is a query for each of n models (new models start out visible)
+    void resize(const unsigned int n);
+    // the query of model last takes the place of model m's (which was removed), and m's query is kept at the end for the next model added
+    void remove(const unsigned int m, const unsigned int last);
+    // read back the results of any queries that have finished (never waits for the GPU)
+    void update();
+
+    // the model was hidden according to its most recent finished query
+    bool isOccluded(const unsigned int m) const { return queries[m].occluded; }
+    // the model's query was issued but its result is not available yet
+    bool isPending(const unsigned int m) const { return queries[m].pending; }
+
+    // wrap a draw call: starts the model's query, or conditional rendering on it if the last query is still pending
+    void begin(const unsigned int m);
+    void end(const unsigned int m);
+
+private:
+    struct Query {
+        unsigned int queryID;
+        bool pending = false;       // issued but not yet read back
+        bool occluded = false;      // result of the last query that was read back
+        bool conditional = false;   // the current draw is using conditional rendering rather than issuing a new query
+    };
+    std::vector<Query> queries;
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// mix the hash of a value into a seed, used to build content keys for resources that can be deduplicated by value
+template <typename V>
+inline void hashCombine(std::size_t& seed, const V& value) {
+    seed ^= std::hash<V>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+/* HANDLE STRUCT
+ *
+ * A handle refers to a resource in a pool by the index of its slot and the generation of that slot. When a resource is removed, its slot's
+ * generation is incremented, so any handle to the old resource stops being valid (instead of silently referring to whatever resource is put
+ * in the slot next). Handles are typed, so a handle to a light can't be used to look up a shader.
+ */
+template <typename T>
+struct Handle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool isNull() const { return index == UINT32_MAX; }
+    bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+/* POOL CLASS
+ *
+ * A pool holds the resources of a scene (shaders, meshes, texture groups, materials, lights) and hands out handles to them. Resources are
+ * stored in slots, which are kept in contiguous arrays (one for the resources, one for the slot generations), and a handle finds its
+ * resource in O(1) without hashing or searching. Adding a resource that is already in the pool returns its existing handle (a hash lookup
+ * on the resource's address, rather than a search through the pool).
+ *
+ * Lifetime is explicit: the pool holds a reference to each resource until remove() is called or the pool is destroyed, and removed slots
+ * are reused by later resources. Resources are still shared pointers, since they are usually created and modified outside of the scene,
+ * but get() and operator[] only return references, so code that reads the pool every frame never touches a reference count.
+ */
+template <typename T>
+class Pool {
+public:
+    Pool() {}
+
+    // add a resource to the pool (or find it, if it was already added), returns its handle
+    Handle<T> add(std::shared_ptr<T> resource) {
+        Handle<T> handle = find(resource.get());
+        if (!handle.isNull() || resource == nullptr) return handle;
+        if (freeSlots.empty()) {
+            handle.index = resources.size();
+            resources.push_back(std::move(resource));
+            generations.push_back(0);
+        } else {
+            handle.index = freeSlots.back();
+            freeSlots.pop_back();
+            resources[handle.index] = std::move(resource);
+        }
+        handle.generation = generations[handle.index];
+        lookup.emplace(resources[handle.index].get(), handle.index);
+        return handle;
+    }
+    // release the pool's reference to a resource, after which handles to it are no longer valid
+    void remove(const Handle<T> handle) {
+        if (!isValid(handle)) {
+            std::cout << "ERROR::POOL::INVALID_HANDLE: Tried to remove a resource that is not in the pool." << std::endl;
+            return;
+        }
+        lookup.erase(resources[handle.index].get());
+        resources[handle.index] = nullptr;
+        generations[handle.index]++;
+        freeSlots.push_back(handle.index);
+    }
+
+    // make room for n more resources, so that adding many resources at once grows the arrays and the lookup a single time
+    void reserve(const unsigned int n) {
+        resources.reserve(resources.size() + n);
+        generations.reserve(generations.size() + n);
+        lookup.reserve(lookup.size() + n);
+    }
+
+    bool isValid(const Handle<T> handle) const
+        { return handle.index < resources.size() && generations[handle.index] == handle.generation && resources[handle.index] != nullptr; }
+    // find the handle of a resource that is in the pool (a null handle if it isn't)
+    Handle<T> find(const T* resource) const {
+        auto slot = lookup.find(resource);
+        return (slot == lookup.end()) ? Handle<T>() : Handle<T>{ slot->second, generations[slot->second] };
+    }
+    // the handle of the resource in a slot
+    Handle<T> getHandle(const unsigned int index) const { return { index, generations[index] }; }
+
+    // access a resource by handle (the handle must be valid)
+    T& get(const Handle<T> handle) const { return *resources[handle.index]; }
+    // access the resource in a slot (nullptr if the slot is free)
+    const std::shared_ptr<T>& operator[](const unsigned int index) const { return resources[index]; }
+
+    // the number of slots, which is the number of resources unless some have been removed
+    unsigned int size() const { return resources.size(); }
+    bool empty() const { return resources.size() == freeSlots.size(); }
+    // every slot in order (free slots hold nullptr)
+    const std::vector<std::shared_ptr<T>>& getResources() const { return resources; }
+    typename std::vector<std::shared_ptr<T>>::const_iterator begin() const { return resources.begin(); }
+    typename std::vector<std::shared_ptr<T>>::const_iterator end() const { return resources.end(); }
+
+private:
+    std::vector<std::shared_ptr<T>> resources;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<const T*, uint32_t> lookup;
+};
+
+#endif
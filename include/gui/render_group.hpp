@@ -1,6 +1,10 @@
 #ifndef SHADER_GROUP_HPP
 #define SHADER_GROUP_HPP
 
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -10,7 +14,10 @@
 
 #include "camera.hpp"
 #include "frame_buffer.hpp"
+#include "frustum.hpp"
 #include "model.hpp"
+#include "model_store.hpp"
+#include "occlusion.hpp"
 #include "renderer.hpp"
 #include "shader.hpp"
 #include "elements.hpp"
@@ -35,35 +42,113 @@
  */
 class RenderGroup {
 public:
-    RenderGroup(std::shared_ptr<Shader> shader) : shader(shader)
-        { for (int l = 0; l < MAX_LIGHTS; l++) l_view.push_back(glm::mat4(1.0f)); }
+    RenderGroup(std::shared_ptr<Shader> shader) : shader(shader) {}
     RenderGroup(Serializer& object);
 
-    // models, lights and cameras are specified later
+    // models, lights and cameras are specified later (models can also be added after the group is loaded, see the scene's change queue)
     void addModel(std::shared_ptr<Model> model);
+    // remove a model by swapping the group's last model into its place (the last model's index becomes m), after the group is loaded
+    void removeModel(const int m);
     ///TODO: light slotting should be done by the scene, not the render group 
     void addLight(std::shared_ptr<Light> light);
+    // put a light in slot l (nullptr for an empty slot), so that light indices match the scene's light slots
+    void setLight(const unsigned int l, std::shared_ptr<Light> light);
     void addCamera(std::shared_ptr<Camera> camera) { this->camera = camera; }
 
+    /* Read the per frame data of the group's models from a store shared with other groups (must be called before load()). Otherwise the
+     * group copies its models into a store of its own when it is loaded.
+     */
+    void setModelStore(std::shared_ptr<ModelStore> store);
+
     // calling load() or render() simply calls the specified callback function taking the shadergroup object as an argument
+    // (the init sequence, which sets uniforms that never change, e.g. sampler slots, runs once the group's shader is ready, and render()
+    // skips the group until then)
     void load();
     void render();
-
-    // retrieve pointers to render group elements
-    ///NOTE: all of these should be const pointer consts but temporarily need to keep them available for outside use
-    const std::shared_ptr<const Shader> getShader() const { return shader; }
+    // run the init sequence again (e.g. after a shadow casting light is added to a loaded group), if the shader is ready
+    void init();
+    /* Draw the group once before the first frame, so that it is drawn at full speed from the first frame on. Drivers may only finish a
+     * program once it is drawn with a given vertex layout, frame buffer format and render state, so this waits for the group's shaders,
+     * runs the init sequence, and draws one model of each vertex layout with the group's render sequence (without occlusion queries) to
+     * the frame buffer that is bound (see Frame::warmUp()). Returns how long it took in milliseconds.
+     */
+    double warmUp();
+
+    /* Per frame CPU work (culling, camera and per model transforms, sorting) is kept out of render() so that the scene can run it on worker
+     * threads before any group is drawn (see Scene::prepare()). None of it touches OpenGL and each group only writes to its own data, so
+     * different groups, and different batches of one group's visible list, can be prepared at the same time. render() then only submits.
+     */
+    // run the prepare sequence, which fills the visible list (unless the scene already has) and culls it
+    void prepare();
+    // compute the per model transforms and sort keys of visible[begin, end)
+    void prepareModels(const unsigned int begin, const unsigned int end);
+    // order the visible list by sort key, so that models sharing textures and meshes are drawn together, front to back
+    void sortVisible();
+
+    // remove models whose bounds are entirely outside of the frustum from this frame's visible list
+    void cull(const Frustum& frustum);
+    /* Let the scene supply the visible list each frame from its BVH (see Scene::cullModels()) instead of testing each model in the group.
+     * Must be called before load(), after which the group no longer culls its own models.
+     */
+    void enableSceneCulling() { sceneCulling = true; }
+    void clearVisible() { visible.clear(); }
+    void addVisible(const int m) { visible.push_back(m); }
+    // retrieve the number of models drawn and culled (by frustum) in the last frame
+    unsigned int nVisible() const { return visible.size(); }
+    unsigned int nCulled() const { return models.size() - visible.size() - occluded.size(); }
+
+    /* Draw lit models after a depth pre-pass has already filled the depth buffer (must be called before load()). Only fragments whose
+     * depth equals the stored depth are shaded and depth is not written again, so each pixel is lit at most once.
+     */
+    void enableDepthPrepass() { depthPrepass = true; }
+
+    /* Use occlusion queries to skip models that were hidden in an earlier frame (must be called before load()). Hidden models are tested
+     * again each frame by drawing their bounds with the proxy shader (a basic 3D shader) and the proxy box (see VertexArray::makeBox()).
+     */
+    void enableOcclusionCulling(std::shared_ptr<Shader> proxyShader, std::shared_ptr<VertexArray> proxyBox);
+    // remove models that were occluded according to their last query from this frame's visible list
+    void cullOccluded();
+    // draw the bounds of each occluded model inside its query to find out whether it has become visible
+    void testOccluded();
+    // wrap a model's draw call in its occlusion query
+    void beginOcclusionQuery(const int m) { occlusion->begin(m); }
+    void endOcclusionQuery(const int m) { occlusion->end(m); }
+    // retrieve the number of models and triangles that occlusion culling rejected in the last frame
+    unsigned int nOccluded() const { return occluded.size(); }
+    unsigned int nOccludedTriangles() const { return occludedTriangles; }
+
+    // retrieve pointers to render group elements (plain pointers, since these are called for every group and model every frame and
+    // shouldn't touch reference counts, the group keeps the elements alive)
+    const Shader* getShader() const { return shader.get(); }
     const std::shared_ptr<const Model> getModel(const unsigned int index = 0) const { return models[index]; }
     unsigned int nModels() const { return models.size(); }
-    const std::shared_ptr<const Light> getLight(const unsigned int index = 0) const { return lights[index]; }
+    const Light* getLight(const unsigned int index = 0) const { return lights[index].get(); }
     unsigned int nLights() const { return lights.size(); }
-    const std::shared_ptr<const Camera> getCamera() const { return camera; }
+    const Camera* getCamera() const { return camera.get(); }
+
+    // per frame model data, read from the dense arrays of the model store rather than through each model's pointers
+    const ModelStore& getStore() const { return *store; }
+    unsigned int getHandle(const int m) const { return handles[m]; }
+    const glm::mat4& getModelMat(const int m) const { return store->getTransform(handles[m]); }
+    const glm::mat3& getNormalMat(const int m) const { return store->getNormal(handles[m]); }
+    const AABB& getBounds(const int m) const { return store->getBounds(handles[m]); }
+    const VertexArray& getMesh(const int m) const { return store->getMesh(handles[m]); }
+    const std::shared_ptr<const TextureGroup>& getTextureGroup(const int m) const { return store->getTextureGroup(handles[m]); }
+    int getMaterialIndex(const int m) const { return store->getMaterialIndex(handles[m]); }
+    const Material* getMaterial(const int m) const { return models[m]->getMaterial().get(); }
+    // point the material samplers at the slots of a material's maps, skipping samplers that already read the right slot
+    void setMaterialMaps(const Material& material);
+    glm::vec3 getColor(const int m) const { return store->getColor(handles[m]); }
 
     glm::mat4 getCamView() const { return c_view; }
     glm::mat4 getCamProj() const { return c_proj; }
-    glm::mat4 getLightView(const int l) const { return l_view.at(l); }
+    glm::mat4 getCamClip() const { return c_clip; }
     void setCamView(glm::mat4 c_view) { this->c_view = c_view; }
     void setCamProj(glm::mat4 c_proj) { this->c_proj = c_proj; }
-    void setLightView(glm::mat4 l_view, const int l) { this->l_view.at(l) = l_view; }
+    void setCamClip(glm::mat4 c_clip) { this->c_clip = c_clip; }
+    // per model transforms computed while preparing the frame (only valid for visible models)
+    glm::mat4 getTransform(const int m) const { return transforms[m]; }
+    void setTransform(const int m, const glm::mat4& transform) { transforms[m] = transform; }
 
     Serializer getJSON();
 
@@ -76,14 +161,41 @@ private:
     ///TODO: divert framebuffer operations to scene
     std::shared_ptr<Shader> shader;
     std::vector<std::shared_ptr<Model>> models;
+    std::shared_ptr<ModelStore> store;
+    std::vector<unsigned int> handles;     // handle of each model in the store
     std::vector<std::shared_ptr<Light>> lights;
     std::shared_ptr<Camera> camera;
-
-    glm::mat4 c_view, c_proj;
-    std::vector<glm::mat4> l_view;
-
-    std::vector<void (*)(RenderGroup&)> renderSequence, postRenderSequence;
-    std::vector<void (*)(RenderGroup&, int)> modelSequence, lightSequence;
+    // indices of the models that will be drawn this frame (all models, minus those removed by cull functions)
+    std::vector<int> visible;
+    bool loaded = false;
+    bool initialized = false;   // whether the init sequence has run (which waits for the shader to be built)
+    bool sceneCulling = false;
+    bool depthPrepass = false;
+
+    // occlusion culling state (occlusion is nullptr unless occlusion culling is enabled)
+    std::unique_ptr<OcclusionQueries> occlusion;
+    std::shared_ptr<Shader> proxyShader;
+    std::shared_ptr<VertexArray> proxyBox;
+    std::vector<int> occluded;
+    unsigned int occludedTriangles = 0;
+
+    glm::mat4 c_view, c_proj, c_clip;
+
+    // draw ordering: models that share a texture group and vertex array share a state key, which is the high half of the sort key (the low
+    // half is the distance to the camera when sorting front to back)
+    bool sortModels = false, frontToBack = false;
+    std::vector<uint32_t> stateKeys;
+    std::vector<uint64_t> sortKeys;
+    std::vector<glm::mat4> transforms;
+    // the slot each material sampler was last set to during this render() (-1 if it hasn't been set yet)
+    int mapSlots[N_MATERIAL_MAPS] = { -1, -1, -1 };
+
+    // a model's texture group ID in the high half and mesh ID in the low half
+    uint32_t getStateKey(const unsigned int handle) const
+        { return (std::min(store->getTextureGroupID(handle), 0xFFFFu) << 16) | std::min(store->getMeshID(handle), 0xFFFFu); }
+
+    std::vector<void (*)(RenderGroup&)> initSequence, prepareSequence, renderSequence, postRenderSequence;
+    std::vector<void (*)(RenderGroup&, int)> prepareModelSequence, modelSequence, lightSequence;
 };
 
 /* RENDER FUNCTIONS
@@ -96,22 +208,38 @@ extern void BIND_SHADER(RenderGroup& rg);
 
 extern void SET_DEPTH_TEST_LE(RenderGroup& rg);
 extern void SET_DEPTH_TEST_L(RenderGroup& rg);
+extern void SET_DEPTH_TEST_EQ(RenderGroup& rg);
+extern void DISABLE_COLOR_WRITES(RenderGroup& rg);
+extern void ENABLE_COLOR_WRITES(RenderGroup& rg);
+extern void DISABLE_DEPTH_WRITES(RenderGroup& rg);
+extern void ENABLE_DEPTH_WRITES(RenderGroup& rg);
 extern void TOGGLE_CULLING(RenderGroup& rg);
 
 extern void CALC_TRANS_V(RenderGroup& rg);
 extern void CALC_TRANS_VP(RenderGroup& rg);
-extern void CALC_TRANS_S(RenderGroup& rg, int l);
-
-extern void SET_LIGHT(RenderGroup& rg, int l);
+extern void CALC_TRANS_SM(RenderGroup& rg, int m);
+
+extern void CULL_CAMERA(RenderGroup& rg);
+extern void CULL_LIGHT(RenderGroup& rg);
+extern void CULL_OCCLUDED(RenderGroup& rg);
+extern void TEST_OCCLUDED(RenderGroup& rg);
+extern void BEGIN_OCCLUSION_QUERY(RenderGroup& rg, int m);
+extern void END_OCCLUSION_QUERY(RenderGroup& rg, int m);
+
+extern void SET_LIGHT_GRID(RenderGroup& rg);
+extern void SET_SHADOW_MAPS(RenderGroup& rg);
+extern void SET_MATERIAL_MAPS(RenderGroup& rg, int m);
+extern void SET_GBUFFER_MAPS(RenderGroup& rg, int m);
+extern void SET_INV_TRANS(RenderGroup& rg);
 extern void SET_MATERIAL(RenderGroup& rg, int m);
 extern void SET_TRANS(RenderGroup& rg, int m);
 extern void SET_TRANS_L(RenderGroup& rg, int m);
-extern void SET_TRANS_S(RenderGroup& rg, int m);
 extern void SET_TRANS_SM(RenderGroup& rg, int m); 
-extern void SET_TRANS_SKYBOX(RenderGroup& rg, int m);
+extern void SET_TRANS_D(RenderGroup& rg, int m);
 extern void SET_VALUE(RenderGroup& rg, int m);
 extern void SET_VALUE_T(RenderGroup& rg, int m);
 
 extern void RENDER_MODEL(RenderGroup& rg, int m);
+extern void RENDER_DEPTH(RenderGroup& rg, int m);
 
 #endif
\ No newline at end of file
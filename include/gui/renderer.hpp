@@ -25,26 +25,33 @@ extern void r_ClearDepthBuffer();
 extern void r_DrawVertices(const VertexArray &vao, const Shader &shader, 
                            const std::shared_ptr<const Texture>* texture = nullptr, const unsigned int nTextures = 0);
 extern void r_DrawVertices(const VertexArray &vao, const Shader &shader, 
-                           const std::shared_ptr<const TextureGroup> textureGroup);
+                           const std::shared_ptr<const TextureGroup>& textureGroup);
 extern void r_DrawVertices(const VertexArray &vao, const Shader &shader,
-                           std::vector<std::shared_ptr<TextureGroup>> textureGroups);
+                           const std::vector<std::shared_ptr<const TextureGroup>>& textureGroups);
 // as above, but uses index data instead of vertex data
 extern void r_DrawIndices(const VertexArray &vao, const Shader &shader, 
                           const std::shared_ptr<const Texture>* texture = nullptr, const unsigned int nTextures = 0);
 extern void r_DrawIndices(const VertexArray &vao, const Shader &shader, 
-                          const std::shared_ptr<const TextureGroup> textureGroup);
+                          const std::shared_ptr<const TextureGroup>& textureGroup);
 extern void r_DrawIndices(const VertexArray &vao, const Shader &shader,
-                          std::vector<std::shared_ptr<const TextureGroup>> textureGroups);
+                          const std::vector<std::shared_ptr<const TextureGroup>>& textureGroups);
 
 // tells openGL context to draw using a depth buffer (for 3D only)
 enum depth_tests {          // there are different kinds of depth test rules openGL can use
     D_LESS = GL_LESS,       // check if the current z value is less than the buffered z value
-    D_LEQUAL = GL_LEQUAL    // check if the current z value is less than or equal to the buffered z value
+    D_LEQUAL = GL_LEQUAL,   // check if the current z value is less than or equal to the buffered z value
+    D_EQUAL = GL_EQUAL      // check if the current z value is equal to the buffered z value (used after a depth pre-pass)
 };
 extern void r_EnableDepthBuffer();
 extern void r_DisableDepthBuffer();
 extern void r_SetDepthTest(unsigned int depthTest); // set a depth test rule
 
+// tells openGL whether to write to the color and depth buffers (tests still run when writes are disabled, e.g. for occlusion queries)
+extern void r_EnableColorWrites();
+extern void r_DisableColorWrites();
+extern void r_EnableDepthWrites();
+extern void r_DisableDepthWrites();
+
 // tells openGL to allow multisampling (used for anti aliasing)
 extern void r_EnableMultisample();
 extern void r_DisableMultisample();
@@ -53,6 +60,7 @@ extern void r_DisableMultisample();
 extern void r_EnableFaceCulling();
 extern void r_DisableFaceCulling();
 extern void r_ToggleFaceCulling();
+extern bool r_IsFaceCullingEnabled();
 extern void r_CullFront();  // cull front facing polygons
 extern void r_CullBack();   // cull back facing polygons
 
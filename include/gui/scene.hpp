@@ -1,20 +1,31 @@
 #ifndef SCENE_HPP
 #define SCENE_HPP
 
+#include <algorithm>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <set>
+#include <span>
+#include <unordered_map>
 #include <vector>
 
 #include <glm/glm.hpp>
 
 #include "../io/serializer.hpp"
 
+#include "bvh.hpp"
 #include "elements.hpp"
 #include "frame.hpp"
+#include "frame_timer.hpp"
+#include "job_system.hpp"
+#include "light_grid.hpp"
+#include "pool.hpp"
 #include "shader.hpp"
 #include "render_group.hpp"
 #include "texture.hpp"
+#include "transform.hpp"
+#include "uniform_buffer.hpp"
 
 /* SCENE CLASS
  * 
@@ -33,6 +44,15 @@
  * Elements can be stored in the scene itself by storing dynamic pointers, or they can be created else where in the program and simply
  * linked to the scene. The scene will only delete pointers to objects that are stored in the scene itself and will not delete pointers
  * declared elsewhere.
+ *
+ * Each kind of element is kept in a pool (see pool.hpp), which holds the scene's reference to the element until it is removed or the
+ * scene is destroyed. Elements can be retrieved by index or by handle, and the handle of an element is found in O(1) from its address.
+ * Shaders, meshes, and materials are also deduplicated by content: adding one that is equal to an element already in the scene returns
+ * the existing element, which is found with a hash lookup on the element's content key.
+ *
+ * Models and lights can be added and removed after the scene is loaded. Changes are queued and applied at the start of the next draw(),
+ * and each one only touches what it needs: a new model finds (or creates and loads) the render group of its shader, a new light gets a
+ * shadow pass if it is one of the first MAX_SHADOW_MAPS lights, and a removed model is swapped out of each of its groups in O(1).
  */
 
 class Scene {
@@ -43,6 +63,7 @@ public:
             : viewportWidth(width), viewportHeight(height), pixelWidth(pixelWidth), camera(camera) {}
     Scene(const int width, const int height, std::shared_ptr<Camera> camera) 
             : viewportWidth(width), viewportHeight(height), camera(camera) {}
+    ~Scene();
 
     // Add a shader to the scene by reference to an existing shader
     const std::shared_ptr<Shader> addShader(std::shared_ptr<Shader> shader);
@@ -51,11 +72,17 @@ public:
                                             const unsigned int MATERIAL_STYLE, const unsigned int LIGHTING_STYLE, 
                                             const unsigned int SHADOW_STYLE, const unsigned int TEXTURE_STYLE, 
                                             const unsigned int POSTPROCESSING);
-    // Retrieve a shader from the scene by index
+    // Retrieve a shader from the scene by index or handle
     Shader& getShader(const unsigned int index) const { return *shaders[index]; }
+    Shader& getShader(const Handle<Shader> handle) const { return shaders.get(handle); }
+    Handle<Shader> getHandle(const Shader* shader) const { return shaders.find(shader); }
+    // release the scene's reference to a shader (models and render groups that use it keep it alive)
+    void removeShader(const Handle<Shader> handle);
 
     // Add a model to the scene by reference to an existing model
     const std::shared_ptr<Model> addModel(std::shared_ptr<Model> model) { return addModel(model, true); }
+    // Add many existing models at once (storage is reserved once for all of them)
+    void addModels(std::span<const std::shared_ptr<Model>> models);
     // Create a new 3D light source model by referencing existing mesh and light objects
     const std::shared_ptr<Model> addPane(std::shared_ptr<VertexArray> vertexArray, std::shared_ptr<Texture> texture);
     const std::shared_ptr<Model> addLightModel(std::shared_ptr<VertexArray> vertexArray, const std::shared_ptr<const Light> light,
@@ -91,8 +118,22 @@ public:
                                                   const glm::vec3 pos = glm::vec3(0.0f), 
                                                   const glm::vec3 scale = glm::vec3(1.0f), 
                                                   const glm::vec3 aos = glm::vec3(0.0, 1.0, 0.0), const float rotation = 0.0f);
-    // retrieve a scene based model by index
+    /* Remove a model from the scene. Before the scene is loaded, models attached to it become roots. Afterwards, the model is removed from
+     * its render groups between frames (models attached to it keep following its node).
+     */
+    void removeModel(std::shared_ptr<Model> model);
+    // retrieve a scene based model by index or handle (a removed model leaves an empty slot)
     Model& getModel(const unsigned int index) const { return *models[index]; }
+    Model& getModel(const Handle<Model> handle) const { return models.get(handle); }
+    Handle<Model> getHandle(const Model* model) const { return models.find(model); }
+    // retrieve the tree of world space model bounds (built when the scene is loaded), whose queries return model indices
+    const BVH& getModelTree() const { return *modelTree; }
+    /* Make a 3D model's transformation relative to another 3D model (e.g. a moon orbiting a planet), so that it moves with its parent.
+     * Both models are added to the scene if they aren't already. Must be called before load().
+     */
+    void attachModel(std::shared_ptr<Model> model, std::shared_ptr<Model> parent);
+    // retrieve the transformations of the scene's 3D models (built when the scene is loaded)
+    const TransformHierarchy& getTransforms() const { return *transforms; }
 
     // add an existing mesh object to the scene
     const std::shared_ptr<VertexArray> addVertexArray(std::shared_ptr<VertexArray> vertexArray);
@@ -104,11 +145,17 @@ public:
     const std::shared_ptr<VertexArray> addSphereMap(const unsigned int resolution, const unsigned int function, 
                                                     const unsigned int draw_type);
     const std::shared_ptr<VertexArray> addVertexArray(const std::string& fileName, const unsigned int renderStrategy);
-    // retrieve a mesh object from the scene by index
+    // retrieve a mesh object from the scene by index or handle
     VertexArray& getVertexArray(const unsigned int index) const { return *vertexArrays[index]; }
+    VertexArray& getVertexArray(const Handle<VertexArray> handle) const { return vertexArrays.get(handle); }
+    Handle<VertexArray> getHandle(const VertexArray* vertexArray) const { return vertexArrays.find(vertexArray); }
+    // release the scene's reference to a mesh (models that use it keep it alive)
+    void removeVertexArray(const Handle<VertexArray> handle);
 
     // add an existing light object to the scene
     const std::shared_ptr<Light> addLight(std::shared_ptr<Light> light);
+    // add many existing lights at once
+    void addLights(std::span<const std::shared_ptr<Light>> lights);
     // create a directional light in the scene
     const std::shared_ptr<Light> addDirLight(const glm::vec3 dir, 
                                              const glm::vec3 ambient, const glm::vec3 diffuse, const glm::vec3 specular);
@@ -121,8 +168,12 @@ public:
                                               const glm::vec3 ambient, const glm::vec3 diffuse, const glm::vec3 specular, 
                                               const float constant, const float linear, const float quadratic, 
                                               const float inner, const float outer);
-    // retrieve a light from the scene by index
+    // retrieve a light from the scene by index or handle (a light's index is its slot in the light grid and shadow maps)
     Light& getLight(const unsigned int index) const { return *lights[index]; }
+    Light& getLight(const Handle<Light> handle) const { return lights.get(handle); }
+    Handle<Light> getHandle(const Light* light) const { return lights.find(light); }
+    // remove a light from the scene, leaving its slot (and shadow map, if it has one) to the next light that is added
+    void removeLight(std::shared_ptr<Light> light);
 
     // add an existing material object to the scene
     const std::shared_ptr<Material> addMaterial(std::shared_ptr<Material> material);
@@ -140,8 +191,12 @@ public:
     const std::shared_ptr<Material> addDSEMap(const std::shared_ptr<const TextureGroup> textureGroup, const float shininess);
     // create a dseMap in the scene by referenceing scene-based textures
     const std::shared_ptr<Material> addDSEMap(const unsigned int texGroupID, const float shininess);
-    // retrieve a material from the scene by index
+    // retrieve a material from the scene by index or handle
     Material& getMaterial(const unsigned int index) const { return *materials[index]; }
+    Material& getMaterial(const Handle<Material> handle) const { return materials.get(handle); }
+    Handle<Material> getHandle(const Material* material) const { return materials.find(material); }
+    // release the scene's reference to a material (models that use it keep it alive)
+    void removeMaterial(const Handle<Material> handle);
 
     // add an existing texture to the scene
     const std::shared_ptr<TextureGroup> addTextureGroup(std::shared_ptr<TextureGroup> textureGroup);
@@ -157,53 +212,186 @@ public:
     // add an existing texture to a group
     void addTextureToGroup(const unsigned int textureGroupID, const std::shared_ptr<Texture> texture)
         { getTextureGroup(textureGroupID).addTexture(texture); }
-    // retrieve a texture from the scene by reference
+    // retrieve a texture from the scene by index or handle
     TextureGroup& getTextureGroup(const unsigned int index) const { return *textureGroups[index]; }
+    TextureGroup& getTextureGroup(const Handle<TextureGroup> handle) const { return textureGroups.get(handle); }
+    Handle<TextureGroup> getHandle(const TextureGroup* textureGroup) const { return textureGroups.find(textureGroup); }
+    // release the scene's reference to a texture group (models and materials that use it keep it alive)
+    void removeTextureGroup(const Handle<TextureGroup> handle) { textureGroups.remove(handle); }
 
     void enableAntiAliasing() { aa_enabled = true; }
     void disableAntiAliasin() { aa_enabled = false; }
     void enableBlur() { blur = true; }
     void disableBlur() { blur = false; }
+    // pack the 2D textures of lit models into texture arrays so that models with different textures don't need to rebind them
+    void enableTextureArrays() { textureArraysEnabled = true; }
+    void disableTextureArrays() { textureArraysEnabled = false; }
+    // skip models that were hidden behind other models in an earlier frame (uses occlusion queries, see OcclusionQueries)
+    void enableOcclusionCulling() { occlusionCulling = true; }
+    void disableOcclusionCulling() { occlusionCulling = false; }
+    // draw lit models into the depth buffer before shading them, so that each pixel runs the lighting shader at most once
+    void enableDepthPrepass() { depthPrepass = true; }
+    void disableDepthPrepass() { depthPrepass = false; }
+    // write the material data of lit models to a G-buffer, then shade every pixel once in a single lighting pass over the screen
+    void enableDeferredShading() { deferredShading = true; }
+    void disableDeferredShading() { deferredShading = false; }
+    /* Shade lit models of every material style with one uber shader per texture style, which branches on the type stored in each model's
+     * material table entry, and shade every type of light with runtime branching on the light's type (must be called before load()). Lit
+     * models then share one program and one render group instead of being split by material style, at the cost of a larger shader.
+     */
+    void enableUberShaders() { uberShaders = true; }
+    void disableUberShaders() { uberShaders = false; }
+    // time every frame on the CPU and GPU (must be called before load()), to compare settings on the same scene (see printRenderStats())
+    void enableFrameTimer() { frameTiming = true; }
+    void disableFrameTimer() { frameTiming = false; }
+    /* Draw every render group once at the end of load(), so that the first frame isn't slowed down by the driver finishing programs (see
+     * Frame::warmUp()). On by default. load() then waits for every shader to be built, rather than drawing groups as their shaders finish.
+     */
+    void enableWarmUp() { warmUpEnabled = true; }
+    void disableWarmUp() { warmUpEnabled = false; }
     void setPixelWidth(const int pixelWidth) { this->pixelWidth = pixelWidth; }
     void setShadowStyle(const unsigned int shadowStyle) { this->shadowStyle = shadowStyle; }
 
     // load the scene (occurs before render loop)
     void load();
-    // draw the scene (draw the scene to the framebuffer each frame)
+    // draw the scene (draw the scene to the framebuffer each frame), after applying the models and lights added or removed since last frame
+    // and streaming the next few textures to the GPU (see TextureCache::upload())
     void draw();
 
     void save(const std::string& path);
     void print() const;
+    // print how many models each render group drew, culled, and rejected by occlusion culling in the last frame
+    void printCullingStats() const;
+    /* Print how many render groups (each of which binds its own program) and draw calls the last frame took, and the average frame time
+     * since the last reset (if the frame timer is enabled).
+     */
+    void printRenderStats() const;
+    void resetRenderStats() { if (timer != nullptr) timer->reset(); }
+    // print how long each program took to warm up when the scene was loaded
+    void printWarmUpTimes() const;
 private:
     // a list of shader groups, each of which will be drawn every frame
     std::shared_ptr<Camera> camera;
     std::unique_ptr<Frame> frame;
     std::vector<std::shared_ptr<RenderGroup>> renderGroups;
+    // models that share a shader share a render group
+    std::unordered_map<const Shader*, std::shared_ptr<RenderGroup>> shader_groups;
+    // per frame data of every model drawn by the scene (see model_store.hpp), per model data below is indexed by store handle
+    std::shared_ptr<ModelStore> modelStore;
+    // transformations of every 3D model, stored parents first so that world matrices are updated in a single sweep
+    std::unique_ptr<TransformHierarchy> transforms;
+    std::vector<int> modelParents;      // index of each model's parent (-1 if the model is a root)
+    std::vector<int> node_handles;      // handle of the model at each node of the hierarchy (-1 if its model was removed)
+    // data shared by all shader programs (camera, lights, light space transforms) is written to these buffers once per frame
+    std::unique_ptr<UniformBuffer> cameraBuffer, lightBuffer, shadowBuffer;
+    // every material in the scene is packed into this buffer when the scene is loaded (models added later append their entries)
+    std::unique_ptr<UniformBuffer> materialBuffer;
+    std::vector<MaterialData> materialData;
+    std::map<std::pair<std::shared_ptr<Material>, std::shared_ptr<TextureGroup>>, int> material_entries;
+    // lights are assigned to view space clusters every frame so that each fragment only shades the lights that reach it
+    std::unique_ptr<LightGrid> lightGrid;
+    // world space bounds of every model, used to find the models that each pass (the camera or a shadow casting light) can see
+    std::unique_ptr<BVH> modelTree;
+    std::vector<int> modelProxies;      // proxy of each model in the tree (-1 if the model has no bounds)
+    std::vector<int> unboundedModels;   // models without bounds are never culled
+    // the render groups that draw each model (and the model's index in each group), and the pass that decides whether it is visible
+    // (-1 for the camera, otherwise the index of the shadow casting light, or -2 for groups that the scene doesn't cull)
+    struct GroupEntry {
+        RenderGroup* renderGroup;
+        int index, pass;
+    };
+    std::vector<std::vector<GroupEntry>> model_groups;
+    std::vector<RenderGroup*> culledGroups;
+    // groups that shade lights, and the shadow pass of each shadow casting light slot (nullptr if the slot has none)
+    std::vector<RenderGroup*> litGroups;
+    std::vector<RenderGroup*> shadowGroups;
+    std::vector<int> shadowMapSlots;
+    // the frames that render groups are added to (the G-buffer only exists with deferred shading), and the depth pre-pass group
+    Frame* sceneFrame = nullptr;
+    Frame* gbufferFrame = nullptr;
+    std::shared_ptr<RenderGroup> depthPrepassGroup;
+    // measures the time each frame takes (nullptr unless the frame timer is enabled)
+    std::unique_ptr<FrameTimer> timer;
+    // the time each render group took to warm up (see Frame::warmUp())
+    std::vector<std::pair<const RenderGroup*, double>> warmUpTimes;
+    // models hidden by occlusion culling are tested by drawing a box around their bounds with this shader
+    std::shared_ptr<Shader> occlusionShader;
+    std::shared_ptr<VertexArray> occlusionBox;
 
-    // Lists of elements
-    std::vector<std::shared_ptr<Shader>> shaders;
-    std::vector<std::shared_ptr<Model>> models;
-    std::vector<std::shared_ptr<VertexArray>> vertexArrays;
-    std::vector<std::shared_ptr<Light>> lights;
-    std::vector<std::shared_ptr<Material>> materials;
-    std::vector<std::shared_ptr<TextureGroup>> textureGroups;
-
-    std::map<std::shared_ptr<RenderGroup>, int> renderGroup_lookup;
-    std::map<std::shared_ptr<Shader>, int> shader_lookup;
-    std::map<std::shared_ptr<Model>, int> model_lookup;
-    std::map<std::shared_ptr<VertexArray>, int> vertexArray_lookup;
-    std::map<std::shared_ptr<Light>, int> light_lookup;
-    std::map<std::shared_ptr<Material>, int> material_lookup;
-    std::map<std::shared_ptr<TextureGroup>, int> textureGroup_lookup;
+    // Pools of elements (a removed element leaves an empty slot, which is skipped when the scene is saved or printed)
+    Pool<Shader> shaders;
+    Pool<Model> models;
+    Pool<VertexArray> vertexArrays;
+    Pool<Light> lights;
+    Pool<Material> materials;
+    Pool<TextureGroup> textureGroups;
+    std::vector<std::shared_ptr<TextureArray>> textureArrays;
+    // content keys of the pooled shaders, meshes, and materials (meshes and materials are hashed, so equal hashes are confirmed with ==)
+    std::unordered_map<uint64_t, Handle<Shader>> shader_keys;
+    std::unordered_multimap<std::size_t, Handle<VertexArray>> vertexArray_keys;
+    std::unordered_multimap<std::size_t, Handle<Material>> material_keys;
 
     int viewportWidth, viewportHeight, pixelWidth = 1;
 
+    // changes made after the scene is loaded, applied in order at the start of the next frame
+    enum scene_changes { C_ADD_MODEL, C_REMOVE_MODEL, C_ADD_LIGHT, C_REMOVE_LIGHT };
+    struct Change {
+        scene_changes type;
+        std::shared_ptr<Model> model;
+        std::shared_ptr<Light> light;
+    };
+    std::vector<Change> changes;
+    bool loaded = false;
+    unsigned int lightingStyle = L_DISABLED;
+    bool shadowsEnabled = false;     // whether any lit shader reads shadow maps
+
     // post processing settings
     bool aa_enabled = false;
     bool blur = false;
 
     // 3D rendering settings
     unsigned int shadowStyle = S_DISABLED;
+    bool textureArraysEnabled = false;
+    bool occlusionCulling = false;
+    bool depthPrepass = false;
+    bool deferredShading = false;
+    bool uberShaders = false;
+    bool frameTiming = false;
+    bool warmUpEnabled = true;
+
+    // pack the textures of lit models into texture arrays (each array holds textures with the same slot, size, and format)
+    void packTextures();
+    // pack all materials into the material table and give each model the index of its material
+    void loadMaterials();
+    // find (or add) the table entry of a model's material
+    int getMaterialEntry(const Model& model);
+    // the material and texture styles of the shader that draws a model (lit models share uber shaders if they are enabled)
+    unsigned int getMaterialStyle(const Model& model) const;
+    unsigned int getTextureStyle(const Model& model) const;
+    // add a model to the render group of its shader (creating the group if needed), the depth pre-pass, and the shadow passes
+    void addModelToGroups(const std::shared_ptr<Model>& model);
+    // insert a model's bounds into the model tree (models without bounds are never culled)
+    void addModelToTree(const Model& model);
+    // give each of the first MAX_SHADOW_MAPS lights a shadow pass, if lit shaders read shadow maps
+    void updateShadowPasses();
+    void addShadowPass(const unsigned int l);
+    // apply the queued changes, each of which only updates the groups, passes, and structures it affects
+    void applyChanges();
+    void loadModel(const std::shared_ptr<Model>& model);
+    void unloadModel(const std::shared_ptr<Model>& model);
+    void loadLight(const std::shared_ptr<Light>& light);
+    void unloadLight(const std::shared_ptr<Light>& light);
+    /* Each frame is drawn in two phases. prepare() does all of the frame's CPU work on worker threads: light transforms, culling, per model
+     * transforms and sorting (see RenderGroup::prepare()). Then the thread that owns the OpenGL context writes the uniform buffers and
+     * renders the frame, which only submits what was prepared.
+     */
+    void prepare();
+    // update the world transformations of moved models (and their descendants) and copy them to the model store
+    void updateTransforms();
+    // update moved models in the model tree and fill the visible lists of every culled render group
+    void cullModels();
+    // write the current camera and light data to the shared uniform buffers (called once per frame, before any group is rendered)
+    void updateUniformBuffers();
 
     // Add shader group by linking a shader, a list of models, and a list of lights.
     const std::shared_ptr<RenderGroup> addRenderGroup(std::shared_ptr<Shader> shader) { return addRenderGroup(-1, shader); }
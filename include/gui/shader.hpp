@@ -1,9 +1,14 @@
 #ifndef SHADER_HPP
 #define SHADER_HPP
 
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <glad/glad.h>
 
@@ -14,8 +19,14 @@
 #include "../io/serializer.hpp"
 
 #include "elements.hpp"
+#include "extensions.hpp"
 #include "light.hpp"
 #include "material.hpp"
+#include "shader_template.hpp"
+#include "uniform_buffer.hpp"
+
+// the location of the shader save files, and the manifest of baked shaders within it (see tools/shader_baker.cpp)
+const char SHADER_SAVE_PATH[] = "../res/shaders/saves/", SHADER_MANIFEST_FILE[] = "manifest.json";
 
 /* TODO - specific uniforms are needed by specific snippets of glsl files. Can create uniform objects (strings and values) that
  * need to be set or there is an error.
@@ -43,6 +54,11 @@
  * files is faster than creating the shader scripts from scratch. If this fails, then load() will call the appropriate genShader()
  * method which will piece together snippets of code from /res/shaders/components/. Once the shader source code is obtained, then
  * load() will attempt to compile the code and link the various shaders together.
+ *
+ * Before any of that, load() looks for a program binary that an earlier run saved to /res/shaders/saves/p_shaders/ once it linked the
+ * same program. A binary is only used if it was saved by the same driver (vendor, renderer, and version) from the same component files,
+ * otherwise the program is built from source and the binary is replaced. Binaries are only saved and loaded if the driver supports
+ * GL_ARB_get_program_binary (see extensions.hpp).
  * 
  * Once the shader program is successfully compiled and bound to the openGL context, the shader object can also be used to interact
  * with the shader program in the OpenGL context. The "use()" method binds the shader program in the OpenGL context so it can be used
@@ -57,16 +73,41 @@ public:
     // Shader can also recieve a format object that converts from the json file format to an object.
     Shader(Serializer& object);
     // The load function completes the construction of the shader after it has been determined that there are no duplicates already.
+    // The program may still be compiling when it returns (see isReady()).
     void load();
+    /* Whether the program has been built and can be used. The first call after load() that finds the program finished checks it for
+     * errors, so shaders that failed to compile or link are never ready. Drivers with GL_KHR_parallel_shader_compile are asked without
+     * waiting, otherwise the call waits for the driver to finish the program.
+     */
+    bool isReady();
+    // Wait for the driver to finish the program (e.g. to warm it up before the first frame), returns whether it can be used.
+    bool wait();
     // Need to make sure the shader is removed from the OpenGL context when it is destroyed
     ~Shader();
 
+    /* Generate the shader's source from the component files and write it to /res/shaders/saves/, replacing any earlier save, so that
+     * load() never has to run the component assembler (see tools/shader_baker.cpp). Doesn't need an OpenGL context. Returns false if a
+     * placeholder was never defined, i.e. the parameters don't make a shader that can be built (nothing is written).
+     */
+    bool bake();
+    // Generate the shader's source from the component files without saving or loading it (see tools/shader_template_test.cpp). Doesn't
+    // need an OpenGL context. Returns false if a placeholder couldn't be filled.
+    bool generate();
+    const std::string& getVertexSource() const { return v_source; }
+    const std::string& getFragmentSource() const { return f_source; }
+    // Compile and link the baked source in a program that is thrown away, returns false (and prints the errors) if the program doesn't
+    // build. Needs an OpenGL context.
+    bool validate();
+
     // Shaders should not be copied as they have a one-to-one correspondence with shaders in the OpenGL context
     Shader(const Shader&) = delete;
     void operator=(const Shader&) = delete;
 
     // It is pointless to create multiple shaders that have the same parameters, so we can check two shaders for this kind of equality
-    bool operator==(const Shader& compare);
+    bool operator==(const Shader& compare) const;
+    // The parameters packed into a single value, so that a scene can find a shader with the same parameters with one hash lookup.
+    // Shaders with the same key are equal (and vice versa).
+    uint64_t getKey() const;
 
     // Bind the program in the OpenGL context (required before setting any uniforms or rendering)
     void use() const { glUseProgram(programID); }
@@ -90,11 +131,6 @@ public:
         { glUniformMatrix3fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat)); }
     void setUniform(const std::string &name, const glm::mat4 mat) const 
         { glUniformMatrix4fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat)); }
-    // structs have fixed names within the shader, so a name is not required
-    void setUniform(const std::shared_ptr<Material> material) const;
-    void setUniform(const unsigned int index, const Light& light, const glm::mat4 view) const 
-        { setUniform(LIGHT_NAME + "[" + std::to_string(index) + "]", light, view); }
-    void setUniform(const std::string &name, const Light& light, const glm::mat4 view) const;
 
     // Return shader parameters
     const unsigned int getRenderingStyle() const { return rendering_style; }
@@ -104,6 +140,26 @@ public:
     const unsigned int getShadowStyle() const { return shadow_style; }
     const unsigned int getTextureStyle() const { return texture_style; }
     const unsigned int getPostprocessing() const { return postprocessing; }
+    /* Lit geometry with a depth output buffer is a depth pre-pass: it transforms positions exactly like the lighting shaders (so that
+     * the lighting pass can depth test with D_EQUAL) and writes nothing but depth. The material, lighting, shadow, and texture
+     * parameters are ignored.
+     */
+    bool isDepthPrepass() const { return rendering_style == R_LIGHTING_3D && output_buffer == B_DEPTH; }
+    /* The passes of deferred shading share their vertex stage with other rendering styles: the G-buffer pass transforms vertices like a
+     * lit shader and the lighting pass draws a 2D pane. Returns the rendering style whose vertex shader is used.
+     */
+    unsigned int getVertexStyle() const {
+        switch(rendering_style) {
+        case R_GBUFFER_3D: return R_LIGHTING_3D;
+        case R_DEFERRED_LIGHTING: return R_BASIC_2D;
+        default: return rendering_style;
+        }
+    }
+
+    // This function will generate a unique vertex shader file name based on the shader parameters defined by the constructor.
+    std::string genVertexShaderName() const;
+    // This function will generate a unique fragment shader file name based on the shader parameters defined by the constructor.
+    std::string genFragmentShaderName() const;
 
     // Encode a format object with data that can be used to recreate the shader. The format object can save object data in a json file.
     Serializer getJSON();
@@ -111,8 +167,12 @@ public:
     // Print information about shader parameters
     void print() const;
 private:
-    // the OpenGL context returns an unsigned int which can be used to reference the program in the context
-    unsigned int programID;
+    // the OpenGL context returns an unsigned int which can be used to reference the program in the context (0 until load())
+    unsigned int programID = 0;
+    // the compiled shaders, which are deleted once the program is linked
+    unsigned int vertexShader = 0, fragmentShader = 0;
+    // whether the program was issued but not yet checked, and whether it linked successfully
+    bool pending = false, linked = false;
 
     /* Shader parameters are used to generate shader programs that can be run in the OpenGL context. See elements.hpp for explanations
      * of individual parameter settings.
@@ -135,12 +195,25 @@ private:
 
     // complete vertex and fragment shader code generated by stitching together code snippets from ./res/shaders/components
     std::string v_source, f_source;
-
-    // creates a shader program in the OpenGL context by linking vertex and fragment shaders
-    bool createProgram(const unsigned int& vertexShader, const unsigned int& fragmentShader);
+    // whether every placeholder in the generated code was filled
+    bool generated = true;
+
+    // creates a shader program in the OpenGL context by linking vertex and fragment shaders (without waiting for the link to finish)
+    void linkProgram();
+    // check a program that is no longer pending for errors (waiting for it, if the driver hasn't finished it), then set it up for use
+    bool finishProgram();
+    // check the compiled shaders and the linked program for errors, then delete the shaders
+    bool checkProgram();
+    // links the uniform blocks declared in the program to the fixed binding points of the shared uniform buffers
+    void bindUniformBlocks() const;
+    // load the program from a saved binary (false if there is no valid binary), and save the binary of a program linked from source
+    bool loadBinary();
+    void saveBinary() const;
+    // the file name of the program's binary, determined by the shader parameters
+    std::string genBinaryName() const;
     // a function that compiles glsl code and creates a shader object in the OpenGl context, giving us an int to reference it
+    // (errors are only checked once the program is linked, see checkProgram())
     const unsigned int compileShader(const std::string& source, const unsigned int type);
-    const unsigned int compileShader(const std::string& source, const unsigned int type, const std::string fileName);
     // a function that checks if there were linking errors when linking the shaders into a single program
     bool checkLinkingErrors() const;
     bool checkLinkingErrors(std::string vFilePath, std::string fFilePath) const;
@@ -150,11 +223,13 @@ private:
 
     // a function that loads shader source code from a glsl file
     std::string loadFile(std::string fileName, std::string path);
-    // This function will generate a unique vertex shader file name based on the shader parameters defined by the constructor.
-    std::string genVertexShaderName();
-    // This function will generate a unique fragment shader file name based on the shader parameters defined by the constructor.
-    std::string genFragmentShaderName();
-
+    // load a source saved to the save directory, if it was generated from the current component files (returns false otherwise, leaving
+    // source unchanged), and save a source stamped with the current component files
+    bool loadSavedSource(const std::string& fileName, std::string& source);
+    void saveSource(const std::string& fileName, const std::string& source) const;
+    // the blocks of the component files that the vertex and fragment sources are assembled from, in order (see ShaderTemplate)
+    std::vector<const ShaderTemplate::Block*> getVertexComponents() const;
+    std::vector<const ShaderTemplate::Block*> getFragmentComponents() const;
     // This function will generate vertex shader source code based on the shader parameters defined by the constructor. It will 
     // compose this code by taking snippets from the component files located at ./res/shaders/components.
     // Certain layout variables can be defined during runtime.
@@ -164,17 +239,12 @@ private:
     std::string& generateFragmentShader();
     // This function will generate a GLSL version declaration to be used in shader source code based on parameters set in elements.cpp.
     std::string getVersion();
-    // This function copies keyed sections from code component files and appends them to the input string.
-    void addComponent(std::string& components, const std::string fileName, const std::string key, const unsigned int shaderType);
-    // This function orders the list of input components then replaces placeholder values with actual code. The result is (almost) 
-    // source code.
-    void assembleSource(std::string& source, const std::string components);
-    // A number of placeholder terms will exist in section code that is not compilable. This function will find placeholders then
-    // replace them with the code snippets that actually belongs there.
-    void fillPlaceholders(std::string& section, char flag);
-    // A number of placeholder terms will exist in section code that is not compilable. This function will find placeholders then
-    // replace them with the code snippets that actually belongs there.
-    void fillPlaceholders(std::string& section, std::string flag);
+    // This function finds keyed sections from code component files and appends them to the input list.
+    void addComponent(std::vector<const ShaderTemplate::Block*>& components, const std::string fileName, const std::string key, 
+                      const unsigned int shaderType) const;
+    // This function orders the list of input components by section then replaces placeholder values with actual code (see
+    // ShaderTemplate). The result is (almost) source code. Returns false if a placeholder was never defined.
+    bool assembleSource(std::string& source, const std::vector<const ShaderTemplate::Block*>& components);
 
     // this function prints source code in a user friendly way (for debugging)
     void printSource(std::string source);
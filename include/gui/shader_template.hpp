@@ -0,0 +1,99 @@
+#ifndef SHADER_TEMPLATE_HPP
+#define SHADER_TEMPLATE_HPP
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../io/file_io.hpp"
+
+#include "elements.hpp"
+
+// the location of the shader component files
+const char SHADER_COMPONENTS_PATH[] = "../res/shaders/components/";
+// the number of structural sections a shader is made of (global, structs, in, out, uniforms, functions, main)
+const unsigned int N_SHADER_SECTIONS = 7;
+
+/* SHADER TEMPLATE CLASS
+ *
+ * The shader template holds the component files in /res/shaders/components/ parsed into a tree that shader source is generated from
+ * (see component_rules.txt for the format). Each keyed block of a component file (@@KEY ... @@) is split into the sections it adds to
+ * (@SECTION ... @), and each section into "&&" tokens: text, placeholder definitions (a name and the text that replaces it) and
+ * placeholder references.
+ *
+ * A shader's source is assembled from the blocks of its components section by section: each section gathers its tokens from every block,
+ * references are matched to definitions by name and the text is written out once. '&' placeholders are filled the same way in a second
+ * pass over that text (their definitions may be made of "&&" references), which is written to a buffer reserved up front.
+ *
+ * The template is an index of every component file, which is read and parsed once, the first time a shader is generated, and then shared
+ * by every shader. Blocks are looked up by their exact key. Nothing changes after that, so sources can be generated on several threads at
+ * once. With EMBED_SHADER_COMPONENTS (see elements.hpp) the component files are compiled into the program instead (as generated by
+ * tools/embed_components.cpp), and no component file is read at runtime.
+ *
+ * The output is the same as filling the placeholders in one at a time by splicing the section text (tools/shader_template_test.cpp
+ * checks this for every shader). A section that can't be filled from its tokens (a reference that is never defined, or placeholder flags
+ * that can't be paired) is an error: it is reported and written without its placeholders filled, and the shader won't compile.
+ */
+class ShaderTemplate {
+public:
+    enum token_types {
+        TOKEN_TEXT,
+        TOKEN_DEFINITION,
+        TOKEN_REFERENCE
+    };
+    struct Token {
+        unsigned int type;
+        std::string_view name;      // name of the placeholder that is defined or referenced
+        std::string_view text;      // the text (or the text that replaces the placeholder, for definitions)
+    };
+    // one occurrence of a section in a block
+    struct Section {
+        std::string_view text;
+        std::vector<Token> tokens;
+        bool regular = true;        // whether the text could be split into tokens (the section can't be filled otherwise)
+    };
+    struct Block {
+        std::string text;
+        std::vector<Section> sections[N_SHADER_SECTIONS];
+    };
+
+    // the template shared by every shader
+    static const ShaderTemplate& get();
+
+    ShaderTemplate(const ShaderTemplate&) = delete;
+    void operator=(const ShaderTemplate&) = delete;
+
+    // find the block of a component file (e.g. "f_lighting.glsl") with the given key (nullptr if the key isn't in the file)
+    const Block* getBlock(const std::string& fileName, const std::string& key) const;
+    // hash of the text of every component file (computed once, when the template is created)
+    uint64_t getHash() const { return hash; }
+    // append the source made from a list of blocks (taken in order) to source, one section at a time with every placeholder filled in
+    // (returns false if a placeholder can't be filled, in which case the source won't compile)
+    bool assemble(std::string& source, const std::vector<const Block*>& blocks) const;
+
+private:
+    // every component file is parsed when the template is created, which is the only time it changes
+    ShaderTemplate();
+
+    // the blocks of each component file by key (blocks are kept by pointer, since their sections refer to their text)
+    std::unordered_map<std::string, std::unordered_map<std::string, std::unique_ptr<Block>>> components;
+    uint64_t hash = 0;
+
+    // split the text of a component file into blocks
+    void addComponent(const std::string& fileName, const std::string& text);
+    // split the text of a block into sections and tokenize them
+    void addBlock(Block* block, const std::string& text, const std::string& name);
+
+    // fill in one section of the source from its tokens, returns false (and reports why) if a placeholder can't be filled, in which case
+    // the section is written without filling any of them
+    bool fillSection(std::string& source, const std::vector<const Block*>& blocks, const unsigned int s) const;
+};
+
+#endif
@@ -1,9 +1,14 @@
 #ifndef TEXTURE_HPP
 #define TEXTURE_HPP
 
+#include <array>
+#include <deque>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <string.h>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 #include <glad/glad.h>
@@ -13,6 +18,8 @@
 #include "io/serializer.hpp"
 
 #include "elements.hpp"
+#include "extensions.hpp"
+#include "job_system.hpp"
 
 // texture formats encode for OpenGL what kind of texture structure to use
 enum texture_formats {
@@ -24,6 +31,7 @@ enum texture_formats {
 enum buffer_component {
     COLOR_BUFFER = GL_RGB,
     ALPHA_BUFFER = GL_RGBA,
+    FLOAT_BUFFER = GL_RGBA16F,      // half float color buffer for data that needs more precision than 8 bits (e.g. normals)
     DEPTH_BUFFER = GL_DEPTH_COMPONENT
 };
 // Texture type indicates how the texture will be used
@@ -44,19 +52,181 @@ enum wrapper_type {
     WRAPPER_CLAMP_TO_EDGE = GL_CLAMP_TO_EDGE,
     WRAPPER_CLAMP_TO_BORDER = GL_CLAMP_TO_BORDER
 };
+// the most image data the texture cache copies to the GPU in a frame (see TextureCache::upload()), and the number of frames that can be
+// uploading at once (each has its own region of the pixel buffer)
+const size_t TEXTURE_UPLOAD_BUDGET = 16 * 1024 * 1024;
+const unsigned int N_UPLOAD_REGIONS = 3;
+
 // Mipmaps are smaller versions of textures that OpenGL will refer to when rendering small textures to avoid unintended visual artifacts
 enum mipmap_type {
     MIPMAP_LINEAR = 1,
     MIPMAP_NEAREST = 2
 };
 
+/* TEXTURE IMAGE CLASS
+ * 
+ * A texture image is the OpenGL texture object that holds the data of an image file (or the 6 files of a cube map), without any sampling
+ * parameters (see Sampler). Images are made by the texture cache, which shares a single image between every texture made from the same
+ * file, so an image file is only read and copied to the GPU once however many textures use it.
+ * 
+ * Images are loaded in the background: the files are decoded by a background job (see JobSystem::submitBackground()), which only the
+ * job system's workers run, so a decode never stalls the main thread in the middle of a frame. The texture cache copies the decoded data
+ * to the GPU a little at a time, between frames (see TextureCache::upload()). Until then the texture object holds a single grey texel, so
+ * an image can be bound and drawn with as soon as it is created. Its size and format are 0 until its files are decoded.
+ * 
+ * Images that are mipmapped have their mipmap generated when they are uploaded.
+ */
+class TextureImage {
+public:
+    // create the texture object and start decoding the image files of a texture (see TextureCache::getImage())
+    TextureImage(const unsigned int textureFormat, const std::vector<std::string>& filePaths, const bool mipmapped);
+    ~TextureImage();
+
+    TextureImage(const TextureImage&) = delete;
+    void operator=(const TextureImage&) = delete;
+
+    // whether the files have been decoded, and whether the texture object holds their data rather than the placeholder
+    bool isDecoded() const { return decoded.isDone(); }
+    bool isResident() const { return resident; }
+    // wait until the files are decoded (running other jobs in the meantime)
+    void wait() const { JobSystem::get().wait(decoded); }
+
+    unsigned int getID() const { return textureID; }
+    unsigned int getFormat() const { return textureFormat; }
+    unsigned int getType() const { return textureType; }
+    int getWidth() const { return isDecoded() ? width : 0; }
+    int getHeight() const { return isDecoded() ? height : 0; }
+    int getChannels() const { return isDecoded() ? nChannels : 0; }
+    bool isMipmapped() const { return mipmapped; }
+
+private:
+    friend class TextureCache;
+
+    // the decoded data of one file (data is nullptr if the file couldn't be read)
+    struct Face {
+        unsigned char* data = nullptr;
+        int width = 0, height = 0, nChannels = 0;
+
+        size_t size() const { return (size_t) width * height * nChannels; }
+    };
+
+    unsigned int textureID, textureFormat, textureType;
+    int width = 0, height = 0, nChannels = 0;
+    bool mipmapped;
+
+    // written by the decoding job, and only read once it is done
+    std::vector<Face> faces;
+    mutable JobCounter decoded;
+    bool resident = false;
+
+    // read every file (run by a worker)
+    void decode(const std::vector<std::string> filePaths);
+    // total size of the decoded data
+    size_t getDataSize() const;
+    // replace the placeholder with the decoded data and free it. Each face is read from sources[face], which is an offset into the bound
+    // pixel unpack buffer, or a pointer to the data itself if no buffer is bound.
+    void upload(const std::vector<const void*>& sources);
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/* SAMPLER CLASS
+ * 
+ * A sampler is an OpenGL sampler object, which holds the parameters that a texture is sampled with (filter, wrapper, mipmap and border
+ * color). A sampler bound to a slot overrides the parameters of the texture bound to the same slot, so textures that share an image can
+ * still be sampled differently. Like images, samplers are made and shared by the texture cache.
+ * 
+ * Parameters that are 0 are left at OpenGL's defaults, as they are for textures.
+ */
+class Sampler {
+public:
+    Sampler(const unsigned int filter, const unsigned int wrapper, const unsigned int mipmap, const std::array<float, 4>& borderColor);
+    ~Sampler();
+
+    Sampler(const Sampler&) = delete;
+    void operator=(const Sampler&) = delete;
+
+    unsigned int getID() const { return samplerID; }
+
+private:
+    unsigned int samplerID;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/* TEXTURE CACHE CLASS
+ * 
+ * The texture cache shares texture images and samplers between every texture that is made from a file. Images are looked up by the
+ * texture format, the path of each file, the time each file was last written, and whether the image is mipmapped, so an image file that
+ * changes on disk is loaded again rather than reusing a stale image. Samplers are looked up by their parameters.
+ * 
+ * The cache only keeps weak references: an image or sampler is deleted as soon as the last texture that uses it is, just like a texture
+ * that isn't shared, and is loaded again if it is needed later. There is a single cache for the OpenGL context (see get()).
+ * 
+ * The cache also streams decoded images to the GPU. upload() is called once per frame (by Scene::draw()) and copies images, in the order
+ * they were created, into one region of a pixel buffer, from which OpenGL reads them without the frame waiting on the copy. At most
+ * TEXTURE_UPLOAD_BUDGET bytes are copied in a frame (an image that is larger than that is uploaded on its own, straight from memory), so
+ * loading many textures is spread over several frames instead of stalling one. The buffer is split into N_UPLOAD_REGIONS regions that are
+ * used in turn, each guarded by a fence, and a frame that would write into a region OpenGL is still reading from skips its upload. If the
+ * context supports GL_ARB_buffer_storage, the buffer is mapped once and stays mapped, otherwise each region is mapped while it is written.
+ */
+class TextureCache {
+public:
+    // the cache shared by every texture
+    static TextureCache& get();
+
+    TextureCache(const TextureCache&) = delete;
+    void operator=(const TextureCache&) = delete;
+
+    // find the image read from a texture file (the name and extension of a texture, as given to Texture), loading it if it isn't in use
+    std::shared_ptr<const TextureImage> getImage(const unsigned int textureFormat, const std::string& fileName, const std::string& extn, 
+                                                 const bool mipmapped);
+    // find the sampler with the given parameters, creating it if it isn't in use
+    std::shared_ptr<const Sampler> getSampler(const unsigned int filter, const unsigned int wrapper, const unsigned int mipmap,
+                                              const std::array<float, 4>& borderColor);
+
+    // copy decoded images to the GPU, up to TEXTURE_UPLOAD_BUDGET bytes (call once per frame from the main thread)
+    void upload();
+    // wait for every image to be decoded and upload all of them, however long it takes
+    void finishUploads();
+
+    // print the number of images and samplers in use and how many requests they saved
+    void print() const;
+
+private:
+    // the pixel buffer lives as long as the OpenGL context, so it is never deleted
+    TextureCache() {}
+
+    std::unordered_map<std::string, std::weak_ptr<TextureImage>> images;
+    // images that haven't been uploaded yet, in the order they were created
+    std::deque<std::weak_ptr<TextureImage>> uploads;
+    std::map<std::tuple<unsigned int, unsigned int, unsigned int, std::array<float, 4>>, std::weak_ptr<const Sampler>> samplers;
+
+    // number of requests that found an image or sampler in the cache, and number that had to load or create one
+    unsigned int imageHits = 0, imageLoads = 0, samplerHits = 0, samplerLoads = 0;
+
+    unsigned int pixelBufferID = 0;
+    unsigned char* mapped = nullptr;            // the whole buffer, if it is persistently mapped
+    GLsync fences[N_UPLOAD_REGIONS] = {};       // signaled once OpenGL has read the uploads of each region
+    unsigned int region = 0;                    // the region the next upload writes to
+
+    void createPixelBuffer();
+    // upload as many images as fit in size bytes, returns false if there was nothing to upload or the region is still in use
+    bool uploadBatch(const size_t size);
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 /* TEXTURE CLASS
  * 
  * The texture class is used to interface with stored texture data in the openGL context and give OpenGL instructions on how to render
  * those textures. The texture class requires a path to a texture image file and several rendering parameters.
  * 
- * Like other interfaces with the openGL context, textures should be held in a strict 1 to 1 correspondence with OpenGL texture objects.
- * Textures should not be copied but instead passed by reference or pointer.
+ * Textures made from a file don't own their OpenGL objects: the image and the sampler are shared through the texture cache, so several
+ * textures (e.g. of different models, or in different slots) can be made from the same file without reading it twice, and changing the
+ * filter or wrapper of one texture swaps its sampler rather than changing the others. Empty textures (e.g. frame buffer targets) hold
+ * their own texture object and its parameters, in a strict 1 to 1 correspondence. Either way, textures should not be copied but instead
+ * passed by reference or pointer.
  */
 class Texture {
 public:
@@ -94,18 +264,31 @@ public:
     void setWrapper(const unsigned int value);      // change the wrapper parameter
 
     // set the border wrapper's color
-    void setBorderColor(const float r, const float g, const float b, const float a) { 
-        float borderColor[] = { r, g, b, a };
-        setParameter(GL_TEXTURE_BORDER_COLOR, borderColor);
-    }
+    void setBorderColor(const float r, const float g, const float b, const float a);
 
     // returns the texture slot of a texture. OpenGL can slot up to 16 textures at once.
     int getSlot() const { return slot; }
     unsigned int getID() const { return textureID; }
     unsigned int getType() const { return textureType; }
+    unsigned int getFormat() const { return textureFormat; }
+
+    // retrieve the source file and the size, format, and rendering parameters of the texture (used to pack textures into arrays)
+    const std::string& getFileName() const { return file_name; }
+    const std::string& getExtension() const { return extension; }
+    int getWidth() const { return (image != nullptr) ? image->getWidth() : width; }
+    int getHeight() const { return (image != nullptr) ? image->getHeight() : height; }
+    int getChannels() const { return (image != nullptr) ? image->getChannels() : nChannels; }
+    unsigned int getFilter() const { return filter; }
+    unsigned int getWrapper() const { return wrapper; }
+    unsigned int getMipmap() const { return mipmap; }
 
     // set the texture's slot
     void setSlot(const int slot) { this->slot = slot; }
+    // wait until the size and format of a texture made from a file are known (see TextureImage)
+    void wait() const { if (image != nullptr) image->wait(); }
+    // let go of the image and sampler of a texture made from a file, once it is only read through a texture array (its size, format, and
+    // parameters are kept, but it can no longer be bound)
+    void releaseImage();
 
     Serializer getJSON() const;
 
@@ -118,11 +301,16 @@ private:
 
     std::string file_name, extension;
 
-    int width, height, nChannels;   // width, height, and number of color channels of the texture file
+    int width, height, nChannels;   // width, height, and number of color channels of an empty texture (see image for file textures)
 
     int slot;                       // indentifier that can be given to shaders to tell them to use the appropriate texture data
 
     unsigned int filter, wrapper, mipmap = 0;    // linear or nearest
+    std::array<float, 4> borderColor = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+    // the shared image and sampler of a texture made from a file (both nullptr for empty textures, which own textureID)
+    std::shared_ptr<const TextureImage> image;
+    std::shared_ptr<const Sampler> sampler;
 
     // used to generically set specific non-visible parameter types
     void setParameter(const unsigned int option, const int value) { glTexParameteri(textureFormat, option, value); }
@@ -131,6 +319,47 @@ private:
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 
+/* TEXTURE ARRAY CLASS
+ * 
+ * A texture array is a single OpenGL texture object (GL_TEXTURE_2D_ARRAY) that holds several 2D textures of the same size and format as
+ * separate layers. Shaders sample it with a sampler2DArray and a layer index, so models whose textures are stored in the same arrays can be
+ * drawn one after another without rebinding any textures; only the layer, which is stored in the material table, changes.
+ * 
+ * A texture array is built from existing file based 2D textures, whose images (see TextureCache) are copied into the layers in order on
+ * the GPU, so the images must have been uploaded. Once a texture is only read through an array, its image can be released. Every texture
+ * must have the same width, height, number of channels, filter, wrapper, and mipmap settings as the first one.
+ * 
+ * Like textures, texture arrays are bound to a slot and should not be copied.
+ */
+class TextureArray {
+public:
+    // create a texture array from a list of 2D textures (each texture becomes the layer of the same index) and the slot it will be bound to
+    TextureArray(const std::vector<std::shared_ptr<const Texture>>& textures, const int slot);
+    ~TextureArray();
+
+    TextureArray(const TextureArray&) = delete;
+    void operator=(const TextureArray&) = delete;
+
+    // bind the array to its slot
+    void bind() const;
+
+    int getSlot() const { return slot; }
+    unsigned int getID() const { return textureID; }
+    int getLayers() const { return nLayers; }
+
+    void print() const;
+
+private:
+    unsigned int textureID;
+
+    int width, height, nChannels, nLayers;
+    int slot;
+
+    unsigned int filter, wrapper, mipmap;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+
 /* TEXTURE GROUP CLASS
  * 
  * The texture group class is used to properly slot and bind textures with little effort. The user simply needs to add textures to the
@@ -155,37 +384,91 @@ public:
     int addTexture(const std::shared_ptr<Texture> texture) { 
         texture->setSlot(nextSlot++); 
         textures.emplace_back(texture); 
+        arrays.emplace_back(nullptr);
+        layers.push_back(0);
         return nextSlot - 1;
     }
     // create a new texture and add it to the texture group
     int addTexture(const std::string& fileName, const std::string& extension, 
                    const unsigned int filter, const unsigned int wrapper, const unsigned int mipmap) { 
         textures.emplace_back(std::make_shared<Texture>(TEXTURE_2D, fileName, extension, filter, wrapper, mipmap, nextSlot++)); 
+        arrays.emplace_back(nullptr);
+        layers.push_back(0);
         return nextSlot - 1;
     }
 
+    // read a texture in the group from a layer of a texture array instead (the array should be bound to the texture's slot)
+    void setArray(const unsigned int index, const std::shared_ptr<const TextureArray> array, const int layer) 
+        { arrays[index] = array; layers[index] = layer; }
+    // release the image of a texture that is read from an array (see Texture::releaseImage())
+    void releaseImage(const unsigned int index) { if (arrays[index] != nullptr) textures[index]->releaseImage(); }
+    // retrieve the array and layer that a texture in the group is read from (nullptr and 0 if the texture is not in an array)
+    const std::shared_ptr<const TextureArray> getArray(const unsigned int index) const { return arrays[index]; }
+    int getLayer(const unsigned int index) const { return layers[index]; }
+
     // retrieve a point to the texture in the group
     const std::shared_ptr<const Texture> getTexture() const { return getTexture(0); }
     const std::shared_ptr<const Texture> getTexture(const unsigned int index) const { return textures[index]; }
     // retrieve the slot of a texture in the group
     int getSlot(const unsigned int index = 0) const { return textures[index]->getSlot(); }
-    unsigned int getType() const { return (getTexture() != nullptr) ? getTexture()->getType() : T_DISABLED; }
+    // once every texture in the group is stored in an array, the group needs a shader that samples arrays
+    unsigned int getType() const;
 
     // retrieve the number of textures in the texture group
     unsigned int size() const { return textures.size(); }
 
     // bind all members of the texture group
-    void bind() const { for (int t = 0; t < textures.size(); t++) textures[t]->bind(); }
+    void bind() const { for (int t = 0; t < textures.size(); t++) (arrays[t] != nullptr) ? arrays[t]->bind() : textures[t]->bind(); }
 
     Serializer getJSON();
 
 private:
     // need to tell the destructor whether to delete the textures or not, so pair each texture with a bool value
-    std::vector<std::shared_ptr<const Texture>> textures = {};
+    std::vector<std::shared_ptr<Texture>> textures = {};
+    // texture arrays (and layers within them) that the textures have been packed into, if any
+    std::vector<std::shared_ptr<const TextureArray>> arrays = {};
+    std::vector<int> layers = {};
 
     // value of the next slot, increments each time a new texture is added
     unsigned int nextSlot = 0;
 };
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+/* TEXTURE BUFFER CLASS
+ * 
+ * A texture buffer is a buffer object that a shader can read like a one dimensional texture (a samplerBuffer) using texelFetch(). Unlike
+ * uniform arrays and uniform blocks, its size is only limited by GL_MAX_TEXTURE_BUFFER_SIZE, so it is used for data that can grow without
+ * bound, e.g., the scene's light list. Each element of the buffer is read as a single texel of the buffer's internal format (GL_RGBA32F,
+ * GL_R32UI, etc.).
+ * 
+ * Like textures, texture buffers are bound to a slot and should not be copied.
+ */
+class TextureBuffer {
+public:
+    // a texture buffer needs the format of its texels and the slot that it will be bound to
+    TextureBuffer(const unsigned int internalFormat, const int slot);
+    ~TextureBuffer();
+
+    TextureBuffer(const TextureBuffer&) = delete;
+    void operator=(const TextureBuffer&) = delete;
+
+    // replace the contents of the buffer, the buffer only reallocates when it needs to grow
+    void setData(const size_t size, const void* data);
+
+    // bind the buffer texture to its slot
+    void bind() const;
+
+    int getSlot() const { return slot; }
+    size_t getCapacity() const { return capacity; }
+
+private:
+    unsigned int bufferID, textureID;   // openGL ids of the buffer object that stores the data and the texture that reads it
+    unsigned int internalFormat;        // format of a single texel
+    int slot;
+
+    size_t capacity = 0;                // size of the buffer's data store in bytes
+};
+
 
 #endif
\ No newline at end of file
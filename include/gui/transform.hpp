@@ -0,0 +1,78 @@
+#ifndef TRANSFORM_HPP
+#define TRANSFORM_HPP
+
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+/* TRANSFORM HIERARCHY CLASS
+ *
+ * The transform hierarchy stores the transformations of a tree of objects (e.g. moons attached to planets attached to a star). Each node has
+ * a local transformation (position, scale, and rotation relative to its parent, applied in the same order as Model::setModel()) and a world
+ * transformation, which is its parent's world transformation times its local transformation. Roots are transformed relative to the world.
+ *
+ * Nodes are stored as parallel arrays (one array per field rather than one struct per node), and a node is always stored after its parent.
+ * That way, world transformations are updated in a single sweep from front to back: by the time a node is reached, its parent is already up
+ * to date, so no node ever has to look further than its parent and the sweep only ever moves forward through memory.
+ *
+ * Changing a node's local transformation only marks it as dirty. update() starts the sweep at the first dirty node, passes the flag down
+ * to children as it goes, and only recomputes the matrices of dirty nodes (i.e. of the subtrees below the nodes that changed).
+ *
+ * Nodes are never moved to another parent, since that would break the parent before child order. A node without children can be removed,
+ * which frees its slot for a later node: a new root can take any free slot, and a new child can take any free slot after its parent.
+ */
+class TransformHierarchy {
+public:
+    TransformHierarchy() {}
+
+    // add a node below parent (-1 for a root), returns the node's index
+    int add(const int parent, const glm::vec3 pos, const glm::vec3 scale, const glm::vec3 aos, const float angle);
+    // remove a node, returns false (and keeps the node) if it still has children
+    bool remove(const int node);
+
+    // change a node's local transformation
+    void setPos(const int node, const glm::vec3 pos) { positions[node] = pos; markDirty(node); }
+    void setScale(const int node, const glm::vec3 scale) { scales[node] = scale; markDirty(node); }
+    void setRotation(const int node, const glm::vec3 aos, const float angle) { axes[node] = aos; angles[node] = angle; markDirty(node); }
+
+    // recompute the world transformations of every dirty node and its descendants
+    void update();
+    // the nodes whose world transformation changed in the last update (in the order they were updated)
+    const std::vector<int>& getUpdated() const { return updated; }
+
+    int getParent(const int node) const { return parents[node]; }
+    bool isFree(const int node) const { return nChildren[node] == -1; }
+    glm::mat4 getWorld(const int node) const { return worlds[node]; }
+    // inverse transpose of the world transformation (for lighting)
+    glm::mat3 getNormal(const int node) const { return normals[node]; }
+    unsigned int size() const { return parents.size(); }
+
+    void print() const;
+
+private:
+    // local transformations
+    std::vector<int> parents;
+    std::vector<glm::vec3> positions, scales, axes;
+    std::vector<float> angles;
+    // world transformations
+    std::vector<glm::mat4> worlds;
+    std::vector<glm::mat3> normals;
+    // bytes rather than a vector<bool>, so that the sweep doesn't have to unpack bits
+    std::vector<unsigned char> dirty;
+    // number of children of each node (-1 for free slots)
+    std::vector<int> nChildren;
+    std::vector<int> freeNodes;
+
+    // nothing in front of the first dirty node can change, so the sweep starts there
+    int firstDirty = INT_MAX;
+    std::vector<int> updated;
+
+    void markDirty(const int node) { dirty[node] = 1; firstDirty = std::min(firstDirty, node); }
+};
+
+#endif
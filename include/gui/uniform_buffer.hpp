@@ -0,0 +1,72 @@
+#ifndef UNIFORM_BUFFER_HPP
+#define UNIFORM_BUFFER_HPP
+
+#include <iostream>
+#include <string>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "elements.hpp"
+
+// Binding points are fixed so that every shader program can be linked to the same buffers without knowing which scene will use it
+enum uniform_block_bindings {
+    UB_CAMERA = 0,      // view and projection matrices of the scene camera (vertex shaders)
+    UB_LIGHTS = 1,      // layout of the light grid and the number of lights (fragment shaders, see light_grid.hpp)
+    UB_SHADOWS = 2,     // world to light clip space matrices used for shadow mapping (vertex shaders)
+    UB_MATERIALS = 3    // table of every material in the scene, indexed per draw (fragment shaders, see MaterialData in material.hpp)
+};
+extern const unsigned int N_UNIFORM_BLOCKS;         // number of binding points listed above
+extern const std::string UNIFORM_BLOCK_NAMES[];     // block names used in the shader components, indexed by binding point
+
+/* CAMERA BLOCK
+ *
+ * CPU side mirror of the "Camera" uniform block. Matrices are already 16 byte aligned so the std140 layout needs no padding.
+ */
+struct CameraBlock {
+    glm::mat4 view;
+    glm::mat4 proj;
+};
+
+/* UNIFORM BUFFER CLASS
+ *
+ * Uniform buffers hold data that is shared between every shader program in the OpenGL context, as opposed to uniforms which have to be
+ * set in each program separately. Data that is constant over a frame (camera matrices, lights, shadow transforms) is written into the
+ * buffer once per frame, and each program reads it through a uniform block that was linked to the buffer's binding point when the
+ * program was loaded (see Shader::bindUniformBlocks()).
+ *
+ * All blocks use the std140 layout, so structs written to the buffer must be padded to match it exactly (see LightGridBlock in light_grid.hpp).
+ *
+ * OpenGL:
+ * Like other objects with a parallel OpenGL object, uniform buffers should not be copied.
+ */
+class UniformBuffer {
+public:
+    // a uniform buffer needs the binding point it will be attached to and the total size of its block in bytes
+    UniformBuffer(const unsigned int binding, const size_t size);
+    ~UniformBuffer();
+
+    UniformBuffer(const UniformBuffer&) = delete;
+    void operator=(const UniformBuffer&) = delete;
+
+    // bind the buffer to the uniform buffer target so that its data can be modified
+    void bind() const { glBindBuffer(GL_UNIFORM_BUFFER, bufferID); }
+    void unbind() const { glBindBuffer(GL_UNIFORM_BUFFER, 0); }
+    // attach the buffer to its binding point, after which all linked programs will read from it
+    void bindBase() const { glBindBufferBase(GL_UNIFORM_BUFFER, binding, bufferID); }
+
+    // copy data into the buffer at the given byte offset
+    void setData(const size_t offset, const size_t size, const void* data) const;
+
+    unsigned int getID() const { return bufferID; }
+    unsigned int getBinding() const { return binding; }
+    size_t getSize() const { return size; }
+
+private:
+    unsigned int bufferID;
+    unsigned int binding;
+    size_t size;
+};
+
+#endif
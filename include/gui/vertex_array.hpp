@@ -15,6 +15,7 @@
 #include "io/serializer.hpp"
 
 #include "elements.hpp"
+#include "frustum.hpp"
 
 struct VertexAttribute;
 
@@ -44,7 +45,8 @@ enum geometry_type {
     G_SAVED = 0,
     G_PANE = 1,
     G_PLANE = 2,
-    G_SPHERE = 3
+    G_SPHERE = 3,
+    G_BOX = 4
 };
 extern size_t getSize(unsigned int dataType);
 
@@ -108,10 +110,18 @@ public:
     VertexArray(const VertexArray&) = delete;
     void operator=(const VertexArray&) = delete;
 
-    bool operator==(VertexArray& other);
+    bool operator==(const VertexArray& other) const;
+    // Meshes that were loaded from a file or generated (e.g. panes and height maps) can be compared by the parameters they were made
+    // from, meshes that were built attribute by attribute can't. The hash is consistent with operator==.
+    bool isComparable() const { return geometry_type != -1; }
+    std::size_t hash() const;
+    // hash of the vertex layout (the stride and the format of each attribute), which meshes with the same attributes share
+    std::size_t getLayout() const;
 
     // functions for creating vertex data for specific kinds of geometric structures (see above)
     void makePane(const float cornerX = -1.0f, const float cornerY = -1.0f, const float dimX = 2.0f, const float dimY = 2.0f);
+    // a box covering [-1, 1] on each axis (positions only), used as a stand in for the bounds of a model
+    void makeBox();
     void makeHeightMap(const unsigned int resolution, const unsigned int function)
         { geometry_type = G_PLANE; function_id = function; makeHeightMap(resolution, PLANE_FUNCTIONS[function]); }
     void makeHeightMap(const unsigned int resolution, const unsigned int function, const unsigned int draw_type)
@@ -150,6 +160,8 @@ public:
     // retrieve the length of the currently active buffers
     unsigned int getVertexCount() const;
     unsigned int getIndexCount() const;
+    // retrieve the mesh space bounds of the vertex positions (found when the attributes are activated)
+    const AABB& getBounds() const { return bounds; }
 
     // save the vertex array to a binary file
     Serializer getJSON() const;
@@ -176,6 +188,10 @@ private:
     // total number of vertices and indices in the currently bound buffers
     unsigned int activeVertexBuffer = -1, activeIndexBuffer = -1;
 
+    // bounds of the position attribute (the first attribute) of the active vertex buffer
+    AABB bounds;
+    void computeBounds();
+
     void genOpenGL();
 
     // functions for adding simple structures to and making geometric calculations
@@ -12,6 +12,7 @@
 #include <GLFW/glfw3.h>
 
 #include "elements.hpp"
+#include "extensions.hpp"
 
 // key binding ids
 enum key {
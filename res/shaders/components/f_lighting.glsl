@@ -4,15 +4,41 @@
 #define DIR_LIGHT 1
 #define POINT_LIGHT 2
 #define SPOT_LIGHT 3
+@
 
-#define N_LIGHTS 4
+@STRUCTS
+struct Light {
+    vec3 pos;
+    int type;
+    vec3 dir;
+    float constant;
+    vec3 ambient;
+    float linear;
+    vec3 diffuse;
+    float quadratic;
+    vec3 specular;
+    float inner;
+    float outer;
+};
 @
 
 @UNIFORMS
-uniform Light lightList[N_LIGHTS];
+layout (std140) uniform Lights {
+    ivec4 clusterDim;
+    vec4 clusterScale;
+    int nLights;
+};
+uniform samplerBuffer lightData;
+uniform usamplerBuffer lightGrid;
+uniform usamplerBuffer lightIndices;
 @
 
 @FUNCTIONS
+Light fetchLight(int l) {
+    vec4 t0 = texelFetch(lightData, 6 * l), t1 = texelFetch(lightData, 6 * l + 1), t2 = texelFetch(lightData, 6 * l + 2),
+         t3 = texelFetch(lightData, 6 * l + 3), t4 = texelFetch(lightData, 6 * l + 4), t5 = texelFetch(lightData, 6 * l + 5);
+    return Light(t0.xyz, floatBitsToInt(t0.w), t1.xyz, t1.w, t2.xyz, t2.w, t3.xyz, t3.w, t4.xyz, t4.w, t5.x);
+}
 &&l_ambient
 vec3 getAmbient(vec3 lightAmbient) {
     vec3 ambientLight = &m_ambient& * lightAmbient;
@@ -92,10 +118,17 @@ getAmbient(attenuation, light.ambient) +
 
 @MAIN
 &&gen_func
+&g_read&
 vec3 nNorm = normalize(norm);
 vec3 result = vec3(0.0f);
-for (int i = 0; i < N_LIGHTS; i++)
-    result += (lightList[i].type != EMPTY_LIGHT) ? getLight(lightList[i], nNorm&s_frag_pos&) : vec3(0.0f);
+&s_calc&
+ivec3 cluster = ivec3(ivec2(gl_FragCoord.xy * clusterScale.xy), int(log(max(-fragPos.z, clusterScale.w) / clusterScale.w) * clusterScale.z));
+cluster = clamp(cluster, ivec3(0), clusterDim.xyz - 1);
+uvec2 grid = texelFetch(lightGrid, cluster.x + clusterDim.x * (cluster.y + clusterDim.y * cluster.z)).xy;
+for (int i = 0; i < clusterDim.w + int(grid.y); i++) {
+    int l = int(texelFetch(lightIndices, (i < clusterDim.w) ? i : int(grid.x) + i - clusterDim.w).r);
+    result += getLight(fetchLight(l), nNorm&s_frag_pos&);
+}
 &m_emission& &&
 &gen_color
 vec4(result, 1.0f)&
@@ -103,16 +136,6 @@ vec4(result, 1.0f)&
 @@
 
 @@POINT
-@STRUCTS
-struct Light {
-    int type;
-    vec3 pos;
-    vec3 ambient, diffuse, specular;
-    float constant, linear, quadratic;
-    &s_map&
-};
-@
-
 @FUNCTIONS
 &&l_ambient_c&&
 &&l_diffuse_c&&
@@ -127,17 +150,6 @@ vec3 getLight(Light light, vec3 norm&s_frag_pos&) {
 @@
 
 @@SPOT
-@STRUCTS
-struct Light {
-    int type;
-    vec3 pos, dir;
-    vec3 ambient, diffuse, specular;
-    float constant, linear, quadratic;
-    float inner, outer;
-    &s_map&
-};
-@
-
 @FUNCTIONS
 &&l_ambient_c&&
 &&l_diffuse_c&&
@@ -153,15 +165,6 @@ vec3 getLight(Light light, vec3 norm&s_frag_pos&) {
 @@
 
 @@DIR
-@STRUCTS
-struct Light {
-    int type;
-    vec3 dir;
-    vec3 ambient, diffuse, specular;
-    &s_map&
-};
-@
-
 @FUNCTIONS
 &&l_ambient&&
 &&l_diffuse&&
@@ -175,17 +178,6 @@ vec3 getLight(Light light, vec3 norm&s_frag_pos&) {
 @@
 
 @@POINT_SPOT
-@STRUCTS
-struct Light {
-    int type;
-    vec3 pos, dir;
-    vec3 ambient, diffuse, specular;
-    float constant, linear, quadratic;
-    float inner, outer;
-    &s_map&
-};
-@
-
 @FUNCTIONS
 &&l_ambient_c&&
 &&l_diffuse_c&&
@@ -201,16 +193,6 @@ vec3 getLight(Light light, vec3 norm&s_frag_pos&) {
 @@
 
 @@DIR_POINT
-@STRUCTS
-struct Light {
-    int type;
-    vec3 pos, dir;
-    vec3 ambient, diffuse, specular;
-    float constant, linear, quadratic;
-    &s_map&
-};
-@
-
 @FUNCTIONS
 &&l_ambient_c&&
 &&l_diffuse_c&&
@@ -225,17 +207,6 @@ vec3 getLight(Light light, vec3 norm&s_frag_pos&) {
 @@
 
 @@DIR_SPOT
-@STRUCTS
-struct Light {
-    int type;
-    vec3 pos, dir;
-    vec3 ambient, diffuse, specular;
-    float constant, linear, quadratic;
-    float inner, outer;
-    &s_map&
-};
-@
-
 @FUNCTIONS
 &&l_ambient_c&&
 &&l_diffuse_c&&
@@ -251,17 +222,6 @@ vec3 getLight(Light light, vec3 norm&s_frag_pos&) {
 @@
 
 @@ALL_ENABLED
-@STRUCTS
-struct Light {
-    int type;
-    vec3 pos, dir;
-    vec3 ambient, diffuse, specular;
-    float constant, linear, quadratic;
-    float inner, outer;
-    &s_map&
-};
-@
-
 @FUNCTIONS
 &&l_ambient_c&&
 &&l_diffuse_c&&
@@ -1,24 +1,36 @@
-@@BASIC
+@@GENERAL
+@GLOBAL
+#define MAX_MATERIALS 256
+@
+
 @STRUCTS
 struct Material {
-    vec3 ambient, diffuse, specular;
-    float shininess;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    ivec4 maps;
 };
 @
 
 @UNIFORMS
-uniform Material material;
+layout (std140) uniform Materials {
+    Material materials[MAX_MATERIALS];
+};
+uniform int materialIndex;
 @
+@@
+
 
+@@BASIC
 @FUNCTIONS
 &m_ambient
-material.ambient&
+materials[materialIndex].ambient.rgb&
 &m_diffuse
-material.diffuse&
+materials[materialIndex].diffuse.rgb&
 &m_specular
-material.specular&
+materials[materialIndex].specular.rgb&
 &m_shininess
-material.shininess&
+materials[materialIndex].specular.w&
 @
 
 @MAIN
@@ -30,26 +42,24 @@ material.shininess&
 
 @@D_MAP
 @STRUCTS
-struct D_Map {
+struct Material_Maps {
     &t_type& diffuse;
-    vec3 specular;
-    float shininess;
 };
 @
 
 @UNIFORMS
-uniform D_Map dMap;
+uniform Material_Maps maps;
 @
 
 @FUNCTIONS
 &m_ambient
-vec3(texture(dMap.diffuse, texCoord))&
+vec3(sampleMap(maps.diffuse, materials[materialIndex].maps.x))&
 &m_diffuse
-vec3(texture(dMap.diffuse, texCoord))&
+vec3(sampleMap(maps.diffuse, materials[materialIndex].maps.x))&
 &m_specular
-dMap.specular&
+materials[materialIndex].specular.rgb&
 &m_shininess
-dMap.shininess&
+materials[materialIndex].specular.w&
 @
 
 @MAIN
@@ -61,25 +71,24 @@ dMap.shininess&
 
 @@DS_MAP
 @STRUCTS
-struct DS_Map {
+struct Material_Maps {
     &t_type& diffuse, specular;
-    float shininess;
 };
 @
 
 @UNIFORMS
-uniform DS_Map dsMap;
+uniform Material_Maps maps;
 @
 
 @FUNCTIONS
 &m_ambient
-vec3(texture(dsMap.diffuse, texCoord))&
+vec3(sampleMap(maps.diffuse, materials[materialIndex].maps.x))&
 &m_diffuse
-vec3(texture(dsMap.diffuse, texCoord))&
+vec3(sampleMap(maps.diffuse, materials[materialIndex].maps.x))&
 &m_specular
-vec3(texture(dsMap.specular, texCoord))&
+vec3(sampleMap(maps.specular, materials[materialIndex].maps.y))&
 &m_shininess
-dsMap.shininess&
+materials[materialIndex].specular.w&
 @
 
 @MAIN
@@ -91,32 +100,96 @@ dsMap.shininess&
 
 @@DSE_MAP
 @STRUCTS
-struct DSE_Map {
+struct Material_Maps {
     &t_type& diffuse, specular, emission;
-    float shininess;
 };
 @
 
 @UNIFORMS
-uniform DSE_Map dseMap;
+uniform Material_Maps maps;
 @
 
 @FUNCTIONS
 vec3 getEmission() {
-    return (texture(dseMap.specular, texCoord).r == 0.0) ? vec3(texture(dseMap.emission, texCoord)) : vec3(0.0f);
+    ivec4 layers = materials[materialIndex].maps;
+    return (sampleMap(maps.specular, layers.y).r == 0.0) ? vec3(sampleMap(maps.emission, layers.z)) : vec3(0.0f);
 }
 &m_ambient
-vec3(texture(dseMap.diffuse, texCoord))&
+vec3(sampleMap(maps.diffuse, materials[materialIndex].maps.x))&
 &m_diffuse
-vec3(texture(dseMap.diffuse, texCoord))&
+vec3(sampleMap(maps.diffuse, materials[materialIndex].maps.x))&
 &m_specular
-vec3(texture(dseMap.specular, texCoord))&
+vec3(sampleMap(maps.specular, materials[materialIndex].maps.y))&
 &m_shininess
-dseMap.shininess&
+materials[materialIndex].specular.w&
 @
 
 @MAIN
 &m_emission
 result += getEmission();&
 @
+@@
+
+
+@@DEFERRED
+@FUNCTIONS
+&m_ambient
+g_ambient&
+&m_diffuse
+g_diffuse&
+&m_specular
+g_specular&
+&m_shininess
+g_shininess&
+@
+
+@MAIN
+&m_emission
+result += g_emission;&
+@
+@@
+
+@@UBER
+@GLOBAL
+#define BASIC_MATERIAL 1
+#define D_MAP_MATERIAL 2
+#define DS_MAP_MATERIAL 3
+#define DSE_MAP_MATERIAL 4
+@
+
+@STRUCTS
+struct Material_Maps {
+    &t_type& diffuse, specular, emission;
+};
+@
+
+@UNIFORMS
+uniform Material_Maps maps;
+@
+
+@FUNCTIONS
+vec3 getEmission() {
+    ivec4 layers = materials[materialIndex].maps;
+    return (sampleMap(maps.specular, layers.y).r == 0.0) ? vec3(sampleMap(maps.emission, layers.z)) : vec3(0.0f);
+}
+&m_ambient
+((materials[materialIndex].maps.w >= D_MAP_MATERIAL) ? 
+    vec3(sampleMap(maps.diffuse, materials[materialIndex].maps.x)) : 
+    materials[materialIndex].ambient.rgb)&
+&m_diffuse
+((materials[materialIndex].maps.w >= D_MAP_MATERIAL) ? 
+    vec3(sampleMap(maps.diffuse, materials[materialIndex].maps.x)) : 
+    materials[materialIndex].diffuse.rgb)&
+&m_specular
+((materials[materialIndex].maps.w >= DS_MAP_MATERIAL) ? 
+    vec3(sampleMap(maps.specular, materials[materialIndex].maps.y)) : 
+    materials[materialIndex].specular.rgb)&
+&m_shininess
+materials[materialIndex].specular.w&
+@
+
+@MAIN
+&m_emission
+if (materials[materialIndex].maps.w == DSE_MAP_MATERIAL) result += getEmission();&
+@
 @@
\ No newline at end of file
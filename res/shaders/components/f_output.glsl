@@ -28,4 +28,42 @@ FragColor = &gen_color&;&&
 &&o_output
 gl_FragDepth = &gen_color&;&&
 @
+@@
+
+
+@@DEPTH_PREPASS
+@MAIN
+&&gen_func
+&&
+&&o_output
+&&
+@
+@@
+
+
+@@GBUFFER
+@OUT
+layout (location = 0) out vec4 gNormal;
+layout (location = 1) out vec4 gAmbient;
+layout (location = 2) out vec4 gDiffuse;
+layout (location = 3) out vec4 gSpecular;
+@
+
+@FUNCTIONS
+vec3 getAmbient() { return &m_ambient&; }
+vec3 getDiffuse() { return &m_diffuse&; }
+vec3 getSpecular() { return &m_specular&; }
+float getShininess() { return &m_shininess&; }
+@
+
+@MAIN
+&&gen_func
+vec3 result = vec3(0.0f);
+&m_emission& &&
+&&o_output
+gNormal = vec4(normalize(norm), getShininess());
+gAmbient = vec4(getAmbient(), result.r);
+gDiffuse = vec4(getDiffuse(), result.g);
+gSpecular = vec4(getSpecular(), result.b);&&
+@
 @@
\ No newline at end of file
@@ -3,4 +3,49 @@
 in vec3 norm;
 in vec3 fragPos;
 @
+
+@MAIN
+&g_read
+&
+@
+@@
+
+
+@@GBUFFER_3D
+@IN
+in vec3 norm;
+in vec3 fragPos;
+@
+@@
+
+
+@@DEFERRED_LIGHTING
+@GLOBAL
+vec3 norm, fragPos;
+vec3 g_ambient, g_diffuse, g_specular, g_emission;
+float g_shininess;
+@
+
+@UNIFORMS
+uniform sampler2D gNormal, gAmbient, gDiffuse, gSpecular, gDepth;
+uniform mat4 invProj;
+@
+
+@MAIN
+&g_read
+ivec2 texel = ivec2(gl_FragCoord.xy);
+float depth = texelFetch(gDepth, texel, 0).r;
+if (depth == 1.0) discard;
+gl_FragDepth = depth;
+vec4 viewPos = invProj * vec4(vec3(texCoord, depth) * 2.0 - 1.0, 1.0);
+fragPos = viewPos.xyz / viewPos.w;
+vec4 gn = texelFetch(gNormal, texel, 0), ga = texelFetch(gAmbient, texel, 0), 
+     gd = texelFetch(gDiffuse, texel, 0), gs = texelFetch(gSpecular, texel, 0);
+norm = gn.xyz;
+g_shininess = gn.w;
+g_ambient = ga.rgb;
+g_diffuse = gd.rgb;
+g_specular = gs.rgb;
+g_emission = vec3(ga.a, gd.a, gs.a);&
+@
 @@
\ No newline at end of file
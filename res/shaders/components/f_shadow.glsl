@@ -1,9 +1,4 @@
 @@DISABLED
-@STRUCTS
-&s_map
-&
-@
-
 @FUNCTIONS
 &&s_shadow
 &&
@@ -14,6 +9,8 @@
 @
 
 @MAIN
+&s_calc
+&
 &s_frag_pos
 &
 @
@@ -21,22 +18,70 @@
 
 
 @@SHADOW_MAPPING
-@STRUCTS
-&s_map
-sampler2D shadowMap;&
+@GLOBAL
+#define N_SHADOWS 4
 @
 
 @IN
-in vec3 fragPosLightSpace[N_LIGHTS];
+in vec3 fragPosLightSpace[N_SHADOWS];
+@
+
+@UNIFORMS
+uniform sampler2D shadowMap[N_SHADOWS];
+@
+
+@FUNCTIONS
+&&s_shadow
+float getShadow(sampler2D map, vec3 fragPosLS) {
+    if (fragPosLS.z > 1.0) return 0.0;
+    float shadow = 0.0;
+    vec2 texelSize = 1.0 / textureSize(map, 0);
+    for(int x = -1; x <= 1; ++x) for(int y = -1; y <= 1; ++y) {
+        float pcfDepth = texture(map, fragPosLS.xy + vec2(x, y) * texelSize).r;
+        shadow += fragPosLS.z > pcfDepth ? 1.0 : 0.0;
+    }
+    shadow /= 9.0;
+
+    return shadow;
+}&&
+&s_frag_pos
+, float shadow&
+&s_func
+* (1.0f - shadow)&
+@
+
+@MAIN
+&s_calc
+float shadow[N_SHADOWS];
+for (int i = 0; i < N_SHADOWS; i++)
+    shadow[i] = (i < nLights) ? getShadow(shadowMap[i], fragPosLightSpace[i]) : 0.0f;&
+&s_frag_pos
+, (l < N_SHADOWS) ? shadow[l] : 0.0f&
+@
+@@
+
+
+@@DEFERRED_SHADOW_MAPPING
+@GLOBAL
+#define N_SHADOWS 4
+@
+
+@UNIFORMS
+layout (std140) uniform Shadows {
+    mat4 lightMat[N_SHADOWS];
+};
+uniform sampler2D shadowMap[N_SHADOWS];
+uniform mat4 invView;
 @
 
 @FUNCTIONS
 &&s_shadow
-float getShadow(Light light, vec3 fragPosLS) {
+float getShadow(sampler2D map, vec3 fragPosLS) {
+    if (fragPosLS.z > 1.0) return 0.0;
     float shadow = 0.0;
-    vec2 texelSize = 1.0 / textureSize(light.shadowMap, 0);
+    vec2 texelSize = 1.0 / textureSize(map, 0);
     for(int x = -1; x <= 1; ++x) for(int y = -1; y <= 1; ++y) {
-        float pcfDepth = texture(light.shadowMap, fragPosLS.xy + vec2(x, y) * texelSize).r;
+        float pcfDepth = texture(map, fragPosLS.xy + vec2(x, y) * texelSize).r;
         shadow += fragPosLS.z > pcfDepth ? 1.0 : 0.0;
     }
     shadow /= 9.0;
@@ -44,13 +89,20 @@ float getShadow(Light light, vec3 fragPosLS) {
     return shadow;
 }&&
 &s_frag_pos
-, vec3 fragPosLS&
+, float shadow&
 &s_func
-* ((fragPosLS.z > 1.0f) ? 1.0f : 1.0f - getShadow(light, fragPosLS))&
+* (1.0f - shadow)&
 @
 
 @MAIN
+&s_calc
+vec4 worldPos = invView * vec4(fragPos, 1.0);
+float shadow[N_SHADOWS];
+for (int i = 0; i < N_SHADOWS; i++) {
+    vec4 fpls = lightMat[i] * worldPos;
+    shadow[i] = (i < nLights) ? getShadow(shadowMap[i], 0.5f * (fpls.xyz / fpls.w) + 0.5f) : 0.0f;
+}&
 &s_frag_pos
-, fragPosLightSpace[i]&
+, (l < N_SHADOWS) ? shadow[l] : 0.0f&
 @
 @@
\ No newline at end of file
@@ -26,6 +26,12 @@ in vec2 texCoord;
 sampler2D&
 @
 
+@FUNCTIONS
+vec4 sampleMap(sampler2D map, int layer) {
+    return texture(map, texCoord);
+}
+@
+
 @MAIN
 &&t_func
 vec3(texture(value, texCoord))&&
@@ -51,4 +57,31 @@ samplerCube&
 &&t_func
 vec3(texture(value, texCoord))&&
 @
+@@
+
+@@ARRAY_2D
+@STRUCTS
+&t_type
+sampler2DArray&
+@
+
+@IN
+in vec2 texCoord;
+@
+
+@UNIFORMS
+&t_type
+sampler2DArray&
+@
+
+@FUNCTIONS
+vec4 sampleMap(sampler2DArray map, int layer) {
+    return texture(map, vec3(texCoord, layer));
+}
+@
+
+@MAIN
+&&t_func
+vec3(texture(value, vec3(texCoord, 0)))&&
+@
 @@
\ No newline at end of file
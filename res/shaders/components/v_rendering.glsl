@@ -40,21 +40,27 @@ layout (location = $) in vec3 aNorm;
 @
 
 @OUT
+invariant gl_Position;
 out vec3 norm;
 out vec3 fragPos;
 @
 
 @UNIFORMS
-uniform mat4 clipMat;
-uniform mat4 viewMat;
+layout (std140) uniform Camera {
+    mat4 camView;
+    mat4 camProj;
+};
+uniform mat4 modelMat;
 uniform mat3 normalMat;
 @
 
 @MAIN
 void main() {
-    gl_Position = clipMat * vec4(aPos, 1.0);
-    fragPos = vec3(viewMat * vec4(aPos, 1.0));
-    norm = normalMat * aNorm;
+    vec4 worldPos = modelMat * vec4(aPos, 1.0);
+    vec4 viewPos = camView * worldPos;
+    gl_Position = camProj * viewPos;
+    fragPos = vec3(viewPos);
+    norm = mat3(camView) * normalMat * aNorm;
     &s_func&
     &t_func&
 }
@@ -62,19 +68,49 @@ void main() {
 @@
 
 
+@@DEPTH_PREPASS
+@IN
+layout (location = $) in vec3 aPos;
+@
+
+@OUT
+invariant gl_Position;
+@
+
+@UNIFORMS
+layout (std140) uniform Camera {
+    mat4 camView;
+    mat4 camProj;
+};
+uniform mat4 modelMat;
+@
+
+@MAIN
+void main() {
+    vec4 worldPos = modelMat * vec4(aPos, 1.0);
+    vec4 viewPos = camView * worldPos;
+    gl_Position = camProj * viewPos;
+}
+@
+@@
+
+
 @@SKYBOX
 @IN
 layout (location = 0) in vec3 aPos;
 @
 
 @UNIFORMS
-uniform mat4 clipMat;
+layout (std140) uniform Camera {
+    mat4 camView;
+    mat4 camProj;
+};
 @
 
 @MAIN
 void main() {
     texCoord = aPos;
-    vec4 pos = clipMat * vec4(aPos, 1.0);
+    vec4 pos = camProj * mat4(mat3(camView)) * vec4(aPos, 1.0);
     gl_Position = pos.xyww;
 }
 @
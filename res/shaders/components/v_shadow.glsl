@@ -7,21 +7,23 @@
 
 @@SHADOW_MAPPING
 @GLOBAL
-#define N_LIGHTS 4
+#define N_SHADOWS 4
 @
 
 @OUT
-out vec3 fragPosLightSpace[N_LIGHTS];
+out vec3 fragPosLightSpace[N_SHADOWS];
 @
 
 @UNIFORMS
-uniform mat4 lightMat[N_LIGHTS];
+layout (std140) uniform Shadows {
+    mat4 lightMat[N_SHADOWS];
+};
 @
 
 @MAIN
 &s_func
-for (int i = 0; i < N_LIGHTS; i++) {
-    vec4 fpls = lightMat[i] * vec4(aPos, 1.0);
+for (int i = 0; i < N_SHADOWS; i++) {
+    vec4 fpls = lightMat[i] * worldPos;
     fragPosLightSpace[i] = 0.5f * (fpls.xyz / fpls.w) + 0.5f;
 }&
 @
@@ -38,6 +38,23 @@ layout (location = $) in vec3 aTexCoord;&
 out vec3 texCoord;
 @
 
+@MAIN
+&t_func
+texCoord = aTexCoord;&
+@
+@@
+
+
+@@ARRAY_2D
+@IN
+&t_in
+layout (location = $) in vec2 aTexCoord;&
+@
+
+@OUT
+out vec2 texCoord;
+@
+
 @MAIN
 &t_func
 texCoord = aTexCoord;&
@@ -0,0 +1,332 @@
+#include "gui/bvh.hpp"
+
+// the tree is checked for degradation once this fraction of its leaves have been reinserted since the last build
+const float REBUILD_CHECK_FRACTION = 0.1f;
+// the tree is rebuilt once its cost has grown by this factor since the last build
+const float REBUILD_COST_RATIO = 1.3f;
+// number of bins used to estimate the surface area heuristic when building a tree
+const int N_BINS = 16;
+
+int BVH::insert(const AABB& bounds, const int userID) {
+    int proxy;
+    if (freeProxies.empty()) {
+        proxy = proxies.size();
+        proxies.emplace_back();
+    } else {
+        proxy = freeProxies.back();
+        freeProxies.pop_back();
+    }
+    proxies[proxy].bounds = AABB(bounds.min - margin, bounds.max + margin);
+    proxies[proxy].userID = userID;
+    proxies[proxy].alive = true;
+    nProxies++;
+
+    insertLeaf(proxy);
+    if (building) changed.push_back(proxy);
+    return proxy;
+}
+void BVH::remove(const int proxy) {
+    removeLeaf(proxies[proxy].leaf);
+    proxies[proxy] = Proxy();
+    freeProxies.push_back(proxy);
+    nProxies--;
+    if (building) changed.push_back(proxy);
+}
+bool BVH::update(const int proxy, const AABB& bounds) {
+    // if the new bounds still fit inside the fat bounds, nothing needs to change
+    const AABB& fat = proxies[proxy].bounds;
+    if (glm::all(glm::greaterThanEqual(bounds.min, fat.min)) && glm::all(glm::lessThanEqual(bounds.max, fat.max))) return false;
+
+    removeLeaf(proxies[proxy].leaf);
+    proxies[proxy].bounds = AABB(bounds.min - margin, bounds.max + margin);
+    insertLeaf(proxy);
+    nReinserts++;
+    if (building) changed.push_back(proxy);
+    return true;
+}
+
+int BVH::allocateNode() {
+    if (freeNodes.empty()) {
+        nodes.emplace_back();
+        return nodes.size() - 1;
+    }
+    int node = freeNodes.back();
+    freeNodes.pop_back();
+    return node;
+}
+void BVH::insertLeaf(const int proxy) {
+    int leaf = allocateNode();
+    nodes[leaf].bounds = proxies[proxy].bounds;
+    nodes[leaf].proxy = proxy;
+    proxies[proxy].leaf = leaf;
+
+    if (root == -1) {
+        root = leaf;
+        return;
+    }
+
+    /* Descend to the best sibling for the new leaf. At each node, the leaf can either become the node's sibling (which costs the area of
+     * a new parent), or descend into one of the children (which costs the growth of this node, paid by every ancestor below, plus the
+     * cost of the child).
+     */
+    const AABB bounds = nodes[leaf].bounds;
+    int node = root;
+    while (!nodes[node].isLeaf()) {
+        AABB combined = nodes[node].bounds;
+        combined.expand(bounds);
+        float area = surfaceArea(nodes[node].bounds), combinedArea = surfaceArea(combined);
+        float siblingCost = 2.0f * combinedArea, inheritedCost = 2.0f * (combinedArea - area);
+
+        float childCost[2];
+        int children[2] = { nodes[node].left, nodes[node].right };
+        for (int c = 0; c < 2; c++) {
+            AABB childCombined = nodes[children[c]].bounds;
+            childCombined.expand(bounds);
+            childCost[c] = surfaceArea(childCombined) + inheritedCost;
+            if (!nodes[children[c]].isLeaf()) childCost[c] -= surfaceArea(nodes[children[c]].bounds);
+        }
+        if (siblingCost < childCost[0] && siblingCost < childCost[1]) break;
+        node = (childCost[0] < childCost[1]) ? children[0] : children[1];
+    }
+
+    // create a new parent for the sibling and the leaf
+    int sibling = node, oldParent = nodes[sibling].parent, newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].left = sibling;
+    nodes[newParent].right = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+    if (oldParent == -1) root = newParent;
+    else if (nodes[oldParent].left == sibling) nodes[oldParent].left = newParent;
+    else nodes[oldParent].right = newParent;
+
+    refit(newParent);
+}
+void BVH::removeLeaf(const int leaf) {
+    if (leaf == root) {
+        root = -1;
+        freeNode(leaf);
+        return;
+    }
+
+    // the leaf's sibling takes the place of their parent
+    int parent = nodes[leaf].parent, grandParent = nodes[parent].parent;
+    int sibling = (nodes[parent].left == leaf) ? nodes[parent].right : nodes[parent].left;
+    nodes[sibling].parent = grandParent;
+    if (grandParent == -1) root = sibling;
+    else {
+        if (nodes[grandParent].left == parent) nodes[grandParent].left = sibling;
+        else nodes[grandParent].right = sibling;
+        refit(grandParent);
+    }
+    freeNode(parent);
+    freeNode(leaf);
+}
+void BVH::refit(int node) {
+    while (node != -1) {
+        nodes[node].bounds = nodes[nodes[node].left].bounds;
+        nodes[node].bounds.expand(nodes[nodes[node].right].bounds);
+        node = nodes[node].parent;
+    }
+}
+
+void BVH::rebuild() {
+    // a synchronous rebuild makes any background build obsolete
+    if (building) {
+        JobSystem::get().wait(buildDone);
+        building = false;
+        changed.clear();
+    }
+    swap(build(getLeaves()));
+}
+void BVH::maintain() {
+    if (building) {
+        if (buildDone.isDone()) {
+            swap(std::move(pendingBuild));
+            building = false;
+        }
+        return;
+    }
+    if (nProxies == 0 || nReinserts < REBUILD_CHECK_FRACTION * nProxies) return;
+
+    nReinserts = 0;
+    if (getCost() <= REBUILD_COST_RATIO * builtCost) return;
+    // the build only reads its own copy of the leaves, changes made from now on are recorded and replayed when it is swapped in
+    building = true;
+    changed.clear();
+    JobSystem::get().submitBackground([this, leaves = getLeaves()]() mutable { pendingBuild = build(std::move(leaves)); }, &buildDone);
+}
+
+std::vector<std::pair<int, AABB>> BVH::getLeaves() const {
+    std::vector<std::pair<int, AABB>> leaves;
+    leaves.reserve(nProxies);
+    for (int p = 0; p < proxies.size(); p++) if (proxies[p].alive) leaves.emplace_back(p, proxies[p].bounds);
+    return leaves;
+}
+BVH::Tree BVH::build(std::vector<std::pair<int, AABB>> leaves) {
+    Tree tree;
+    if (leaves.empty()) return tree;
+    tree.nodes.reserve(2 * leaves.size() - 1);
+    tree.root = build(tree, leaves, 0, leaves.size(), -1);
+    return tree;
+}
+int BVH::build(Tree& tree, std::vector<std::pair<int, AABB>>& leaves, const int begin, const int end, const int parent) {
+    int node = tree.nodes.size();
+    tree.nodes.emplace_back();
+    tree.nodes[node].parent = parent;
+
+    AABB bounds, centroids;
+    for (int i = begin; i < end; i++) {
+        bounds.expand(leaves[i].second);
+        centroids.expand(leaves[i].second.getCenter());
+    }
+    tree.nodes[node].bounds = bounds;
+    if (end - begin == 1) {
+        tree.nodes[node].proxy = leaves[begin].first;
+        return node;
+    }
+
+    // split along the axis where the leaf centers are most spread out
+    glm::vec3 spread = centroids.max - centroids.min;
+    int axis = (spread.x > spread.y && spread.x > spread.z) ? 0 : (spread.y > spread.z) ? 1 : 2;
+    int mid = (begin + end) / 2;
+    if (spread[axis] > 0.0f) {
+        // sort the leaves into bins by their center, then find the split between bins with the lowest surface area heuristic cost
+        auto getBin = [&](const std::pair<int, AABB>& leaf) {
+            int bin = (int) (N_BINS * (leaf.second.getCenter()[axis] - centroids.min[axis]) / spread[axis]);
+            return (bin < N_BINS) ? bin : N_BINS - 1;
+        };
+        AABB binBounds[N_BINS];
+        int binCount[N_BINS] = {};
+        for (int i = begin; i < end; i++) {
+            int bin = getBin(leaves[i]);
+            binBounds[bin].expand(leaves[i].second);
+            binCount[bin]++;
+        }
+        float rightArea[N_BINS];
+        int rightCount[N_BINS];
+        AABB accumulated;
+        int count = 0;
+        for (int b = N_BINS - 1; b > 0; b--) {
+            accumulated.expand(binBounds[b]);
+            count += binCount[b];
+            rightArea[b] = surfaceArea(accumulated);
+            rightCount[b] = count;
+        }
+        accumulated = AABB();
+        count = 0;
+        float bestCost = INFINITY;
+        int bestSplit = -1;
+        for (int b = 1; b < N_BINS; b++) {
+            accumulated.expand(binBounds[b - 1]);
+            count += binCount[b - 1];
+            if (count == 0 || rightCount[b] == 0) continue;
+            float cost = surfaceArea(accumulated) * count + rightArea[b] * rightCount[b];
+            if (cost < bestCost) { bestCost = cost; bestSplit = b; }
+        }
+        if (bestSplit != -1)
+            mid = std::partition(leaves.begin() + begin, leaves.begin() + end,
+                                 [&](const std::pair<int, AABB>& leaf) { return getBin(leaf) < bestSplit; }) - leaves.begin();
+    }
+
+    // children are built after the parent, so the node has to be referred to by index (the node list may grow)
+    int left = build(tree, leaves, begin, mid, node);
+    int right = build(tree, leaves, mid, end, node);
+    tree.nodes[node].left = left;
+    tree.nodes[node].right = right;
+    return node;
+}
+void BVH::swap(Tree&& tree) {
+    nodes = std::move(tree.nodes);
+    root = tree.root;
+    freeNodes.clear();
+    for (Proxy& proxy : proxies) proxy.leaf = -1;
+    for (int n = 0; n < nodes.size(); n++) if (nodes[n].isLeaf()) proxies[nodes[n].proxy].leaf = n;
+
+    // replay changes made while the tree was being built
+    for (int proxy : changed) {
+        int leaf = proxies[proxy].leaf;
+        if (leaf != -1 && (!proxies[proxy].alive || nodes[leaf].bounds.min != proxies[proxy].bounds.min ||
+                           nodes[leaf].bounds.max != proxies[proxy].bounds.max)) {
+            removeLeaf(leaf);
+            proxies[proxy].leaf = -1;
+        }
+        if (proxies[proxy].alive && proxies[proxy].leaf == -1) insertLeaf(proxy);
+    }
+    changed.clear();
+
+    nReinserts = 0;
+    builtCost = getCost();
+}
+
+float BVH::getCost() const {
+    if (root == -1) return 0.0f;
+    float cost = 0.0f;
+    for (const Node& node : nodes) if (node.left != -1) cost += surfaceArea(node.bounds);
+    float rootArea = surfaceArea(nodes[root].bounds);
+    return (rootArea > 0.0f) ? cost / rootArea : 0.0f;
+}
+int BVH::getHeight() const {
+    if (root == -1) return 0;
+    int height = 0;
+    std::vector<std::pair<int, int>> stack = { { root, 1 } };
+    while (!stack.empty()) {
+        auto [node, depth] = stack.back();
+        stack.pop_back();
+        height = std::max(height, depth);
+        if (!nodes[node].isLeaf()) {
+            stack.emplace_back(nodes[node].left, depth + 1);
+            stack.emplace_back(nodes[node].right, depth + 1);
+        }
+    }
+    return height;
+}
+
+void BVH::raycast(const glm::vec3 origin, const glm::vec3 dir, const float maxDistance, std::vector<int>& results) const {
+    glm::vec3 invDir = 1.0f / dir;
+    traverse([&](const AABB& bounds) { return intersectRay(bounds, origin, invDir) <= maxDistance; }, results);
+}
+int BVH::pick(const glm::vec3 origin, const glm::vec3 dir, const float maxDistance) const {
+    if (root == -1) return -1;
+    glm::vec3 invDir = 1.0f / dir;
+    float closest = maxDistance;
+    int result = -1;
+    // nodes further than the closest hit so far can be skipped
+    std::vector<int> stack = { root };
+    while (!stack.empty()) {
+        int node = stack.back();
+        stack.pop_back();
+        float distance = intersectRay(nodes[node].bounds, origin, invDir);
+        if (distance > closest) continue;
+        if (nodes[node].isLeaf()) {
+            closest = distance;
+            result = proxies[nodes[node].proxy].userID;
+        } else { stack.push_back(nodes[node].left); stack.push_back(nodes[node].right); }
+    }
+    return result;
+}
+
+float BVH::surfaceArea(const AABB& box) {
+    if (box.isEmpty()) return 0.0f;
+    glm::vec3 d = box.max - box.min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+bool BVH::overlaps(const AABB& a, const AABB& b) {
+    return glm::all(glm::lessThanEqual(a.min, b.max)) && glm::all(glm::lessThanEqual(b.min, a.max));
+}
+float BVH::distance2(const AABB& box, const glm::vec3 point) {
+    glm::vec3 d = glm::max(glm::max(box.min - point, point - box.max), glm::vec3(0.0f));
+    return glm::dot(d, d);
+}
+float BVH::intersectRay(const AABB& box, const glm::vec3 origin, const glm::vec3 invDir) {
+    // slab test: the ray is inside the box where it is between the planes of all three axes at once
+    glm::vec3 t0 = (box.min - origin) * invDir, t1 = (box.max - origin) * invDir;
+    glm::vec3 tMin = glm::min(t0, t1), tMax = glm::max(t0, t1);
+    float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f)), exit = std::min(std::min(tMax.x, tMax.y), tMax.z);
+    return (enter <= exit) ? enter : INFINITY;
+}
+
+void BVH::print() const {
+    std::cout << "BVH: " << nProxies << " objects, height " << getHeight() << ", cost " << getCost() <<
+                 " (" << builtCost << " when built)" << (building ? ", rebuilding" : "") << std::endl;
+}
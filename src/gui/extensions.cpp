@@ -0,0 +1,62 @@
+#include "gui/extensions.hpp"
+
+PFN_R_GETPROGRAMBINARY r_glGetProgramBinary = nullptr;
+PFN_R_PROGRAMBINARY r_glProgramBinary = nullptr;
+PFN_R_PROGRAMPARAMETERI r_glProgramParameteri = nullptr;
+PFN_R_MAXSHADERCOMPILERTHREADS r_glMaxShaderCompilerThreads = nullptr;
+PFN_R_BUFFERSTORAGE r_glBufferStorage = nullptr;
+
+bool programBinaries = false, parallelShaderCompile = false, bufferStorage = false;
+std::string driverString;
+
+// whether the bound context lists an extension (core profiles only list extensions one at a time)
+bool hasExtension(const char* name) {
+    int nExtensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &nExtensions);
+    for (int e = 0; e < nExtensions; e++) 
+        if (std::strcmp((const char*) glGetStringi(GL_EXTENSIONS, e), name) == 0) return true;
+    return false;
+}
+
+void r_LoadExtensions(GLADloadproc load) {
+    int major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    bool gl41 = major > 4 || (major == 4 && minor >= 1);
+
+    programBinaries = false;
+    if (gl41 || hasExtension("GL_ARB_get_program_binary")) {
+        r_glGetProgramBinary = (PFN_R_GETPROGRAMBINARY) load("glGetProgramBinary");
+        r_glProgramBinary = (PFN_R_PROGRAMBINARY) load("glProgramBinary");
+        r_glProgramParameteri = (PFN_R_PROGRAMPARAMETERI) load("glProgramParameteri");
+        // a driver may support the extension without supporting any binary format, in which case nothing can be saved
+        int nFormats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &nFormats);
+        programBinaries = r_glGetProgramBinary != nullptr && r_glProgramBinary != nullptr && r_glProgramParameteri != nullptr && 
+                          nFormats > 0;
+    }
+
+    parallelShaderCompile = false;
+    r_glMaxShaderCompilerThreads = nullptr;
+    if (hasExtension("GL_KHR_parallel_shader_compile")) 
+        r_glMaxShaderCompilerThreads = (PFN_R_MAXSHADERCOMPILERTHREADS) load("glMaxShaderCompilerThreadsKHR");
+    else if (hasExtension("GL_ARB_parallel_shader_compile")) 
+        r_glMaxShaderCompilerThreads = (PFN_R_MAXSHADERCOMPILERTHREADS) load("glMaxShaderCompilerThreadsARB");
+    if (r_glMaxShaderCompilerThreads != nullptr) {
+        // let the driver use as many threads as it sees fit
+        r_glMaxShaderCompilerThreads(0xFFFFFFFF);
+        parallelShaderCompile = true;
+    }
+
+    bool gl44 = major > 4 || (major == 4 && minor >= 4);
+    r_glBufferStorage = nullptr;
+    if (gl44 || hasExtension("GL_ARB_buffer_storage")) r_glBufferStorage = (PFN_R_BUFFERSTORAGE) load("glBufferStorage");
+    bufferStorage = r_glBufferStorage != nullptr;
+
+    driverString = std::string((const char*) glGetString(GL_VENDOR)) + "\n" + (const char*) glGetString(GL_RENDERER) + "\n" + 
+                   (const char*) glGetString(GL_VERSION);
+}
+bool r_HasProgramBinaries() { return programBinaries; }
+bool r_HasParallelShaderCompile() { return parallelShaderCompile; }
+bool r_HasBufferStorage() { return bufferStorage; }
+const std::string& r_GetDriverString() { return driverString; }
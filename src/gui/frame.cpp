@@ -64,6 +64,27 @@ void Frame::render() {
     if (frameBuffer != nullptr && frameBuffer->isAntiAliasingEnabled()) frameBuffer->applyAntiAliasing();
 }
 
+// width and height of the frame buffers that render groups are warmed up with
+const int WARM_UP_SIZE = 4;
+
+void Frame::warmUp(std::vector<std::pair<const RenderGroup*, double>>& times) {
+    for (int i = 0; i < subframes.size(); i++) subframes[i]->warmUp(times);
+
+    std::unique_ptr<FrameBuffer> target = (frameBuffer != nullptr) ?
+        frameBuffer->makeCopy(WARM_UP_SIZE) :
+        std::make_unique<FrameBuffer>(FB_BASIC, FRAME_BUFFER_RW, WARM_UP_SIZE, WARM_UP_SIZE, 3, DEPTH_TESTING_ENABLED);
+    // as in render()
+    target->clear();
+    target->bind();
+    if (target->isDepthEnabled()) r_EnableDepthBuffer();
+    else r_DisableDepthBuffer();
+    if (target->isAntiAliasingEnabled()) r_EnableMultisample();
+    else r_DisableMultisample();
+    subframes_tg.bind();
+
+    for (int i = 0; i < renderGroups.size(); i++) times.push_back({ renderGroups[i].get(), renderGroups[i]->warmUp() });
+}
+
 void Frame::print(int tab) const {
     /*std::string tabs(tab, '\t');
     for (int i = 0; i < renderGroups.size(); i++) {
@@ -91,20 +112,28 @@ Pane::Pane(std::unique_ptr<FrameBuffer>&& frameBuffer)
         : Frame(std::move(frameBuffer)) {
     std::shared_ptr<VertexArray> paneGeometry = std::make_shared<VertexArray>(); 
     paneGeometry->makePane();
-    paneModel = std::make_shared<Model>(paneGeometry, this->frameBuffer->getBuffer());
+    paneModel = makePaneModel(paneGeometry);
 }
 Pane::Pane(std::unique_ptr<FrameBuffer>&& frameBuffer, float posX, float posY, float dimX, float dimY)
         : Frame(std::move(frameBuffer)) {
     paneDims[0] = posX; paneDims[1] = posY; paneDims[2] = dimX; paneDims[3] = dimY;
     std::shared_ptr<VertexArray> paneGeometry = std::make_shared<VertexArray>(); 
     paneGeometry->makePane(posX, posY, dimX, dimY);
-    paneModel = std::make_shared<Model>(paneGeometry, this->frameBuffer->getBuffer());
+    paneModel = makePaneModel(paneGeometry);
 }
 Pane::Pane(Serializer object) : Frame(object) {
     for (int i = 0; i < 4; i++) paneDims[i] = static_cast<float>(object["pane_dims"][i]);
     std::shared_ptr<VertexArray> paneGeometry = std::make_shared<VertexArray>();
     paneGeometry->makePane(paneDims[0], paneDims[1], paneDims[2], paneDims[3]);
-    paneModel = std::make_shared<Model>(paneGeometry, frameBuffer->getBuffer());
+    paneModel = makePaneModel(paneGeometry);
+}
+
+std::shared_ptr<Model> Pane::makePaneModel(std::shared_ptr<VertexArray> paneGeometry) {
+    if (frameBuffer->nBuffers() == 1) return std::make_shared<Model>(paneGeometry, frameBuffer->getBuffer());
+    // when the frame has several outputs (e.g. a G-buffer), the pane reads all of them from consecutive slots
+    std::shared_ptr<TextureGroup> buffers = std::make_shared<TextureGroup>(GBUFFER_SLOT);
+    for (int b = 0; b < frameBuffer->nBuffers(); b++) buffers->addTexture(frameBuffer->getBuffer(b));
+    return std::make_shared<Model>(paneGeometry, buffers);
 }
 
 Serializer Pane::getJSON() {
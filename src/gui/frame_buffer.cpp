@@ -41,6 +41,7 @@ void FrameBuffer::initialize() {
     switch(type) {
     case FB_ANTI_ALIASING: { makeAntiAliasing(); } break;
     case FB_DEPTH_MAP: { makeDepthMap(); } break;
+    case FB_GBUFFER: { makeGBuffer(); } break;
     default: { makeBasic(); } break;
     }
 }
@@ -120,6 +121,27 @@ void FrameBuffer::makeDepthMap() {
     // the texture should be complete, check for errors
     checkStatus();
 }
+void FrameBuffer::makeGBuffer() {
+    /* A G-buffer renders to several color textures at once (multiple render targets), one for each gbuffer_targets value. Depth is also
+     * stored in a texture rather than a render buffer, since the lighting pass needs it to find the position of each pixel. The normal
+     * target is returned by getBuffer(), and every target can be accessed by getBuffer(target).
+     */
+    bind();
+    // normals need more precision than 8 bits per channel, material colors do not
+    unsigned int attachments[GB_DEPTH];
+    for (int t = 0; t < GB_DEPTH; t++) {
+        unsigned int component = (t == GB_NORMAL) ? FLOAT_BUFFER : ALPHA_BUFFER;
+        t_targets.push_back(std::make_shared<Texture>(TEXTURE_2D, width, height, component, FILTER_NEAREST, WRAPPER_CLAMP_TO_EDGE, 0));
+        glFramebufferTexture2D(call_format, GL_COLOR_ATTACHMENT0 + t, TEXTURE_2D, t_targets[t]->getID(), 0);
+        attachments[t] = GL_COLOR_ATTACHMENT0 + t;
+    }
+    t_targets.push_back(std::make_shared<Texture>(TEXTURE_2D, width, height, DEPTH_BUFFER, FILTER_NEAREST, WRAPPER_CLAMP_TO_EDGE, 0));
+    glFramebufferTexture2D(call_format, GL_DEPTH_ATTACHMENT, TEXTURE_2D, t_targets[GB_DEPTH]->getID(), 0);
+    t_buffer = t_targets[GB_NORMAL];
+    // tell openGL that fragment shader outputs 0, 1, 2, ... go to the color attachments in the same order
+    glDrawBuffers(GB_DEPTH, attachments);
+    checkStatus();
+}
 
 FrameBuffer::~FrameBuffer() {
     //need to delete the openGL frame object and the color buffer
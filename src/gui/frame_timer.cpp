@@ -0,0 +1,54 @@
+#include "gui/frame_timer.hpp"
+
+FrameTimer::FrameTimer() {
+    for (Query& query : queries) glGenQueries(1, &query.queryID);
+    #if DEBUG_OPENGL_OBJECTS
+        std::cout << N_QUERIES << " timer queries were created." << std::endl;
+    #endif
+}
+FrameTimer::~FrameTimer() {
+    for (Query& query : queries) glDeleteQueries(1, &query.queryID);
+    #if DEBUG_OPENGL_OBJECTS
+        std::cout << N_QUERIES << " timer queries were deleted." << std::endl;
+    #endif
+}
+
+void FrameTimer::begin() {
+    update();
+    start = std::chrono::steady_clock::now();
+    // the oldest query is reused, unless the GPU still hasn't finished the frame it timed
+    timing = !queries[next].pending;
+    if (timing) glBeginQuery(GL_TIME_ELAPSED, queries[next].queryID);
+}
+void FrameTimer::end() {
+    if (timing) {
+        glEndQuery(GL_TIME_ELAPSED);
+        queries[next].pending = true;
+        next = (next + 1) % N_QUERIES;
+    }
+    cpuTime += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    nCPUFrames++;
+}
+void FrameTimer::reset() {
+    // pending queries are finished without being counted (a query can't be abandoned, but its result can be ignored)
+    for (Query& query : queries) query.pending = false;
+    cpuTime = gpuTime = 0.0;
+    nCPUFrames = nGPUFrames = 0;
+}
+
+void FrameTimer::update() {
+    for (Query& query : queries) if (query.pending) {
+        unsigned int available = 0;
+        glGetQueryObjectuiv(query.queryID, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+        uint64_t elapsed = 0;
+        glGetQueryObjectui64v(query.queryID, GL_QUERY_RESULT, &elapsed);
+        gpuTime += elapsed / 1.0e6;
+        nGPUFrames++;
+        query.pending = false;
+    }
+}
+
+void FrameTimer::print() const {
+    std::cout << "Frame time (" << nFrames() << " frames): " << getCPUTime() << " ms CPU, " << getGPUTime() << " ms GPU" << std::endl;
+}
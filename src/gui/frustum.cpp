@@ -0,0 +1,37 @@
+#include "gui/frustum.hpp"
+
+AABB AABB::transform(const glm::mat4& mat) const {
+    if (isEmpty()) return *this;
+    // transform the center, then find the extent of the transformed box by projecting each rotated half axis onto the world axes
+    glm::vec3 center = glm::vec3(mat * glm::vec4(getCenter(), 1.0f)), extent = getExtent(), newExtent = glm::vec3(0.0f);
+    for (int i = 0; i < 3; i++) newExtent += glm::abs(glm::vec3(mat[i])) * extent[i];
+    return AABB(center - newExtent, center + newExtent);
+}
+
+void AABB::print() const {
+    std::cout << "AABB: (" << min.x << ", " << min.y << ", " << min.z << ") to (" << max.x << ", " << max.y << ", " << max.z << ")" << 
+                 std::endl;
+}
+
+Frustum::Frustum(const glm::mat4& clipMat) {
+    // a clip space point is inside the frustum if -w <= x, y, z <= w, so each plane is the sum or difference of the w row and another row
+    // (glm matrices are column major, so rows have to be assembled from the columns)
+    glm::vec4 rows[4];
+    for (int r = 0; r < 4; r++) rows[r] = glm::vec4(clipMat[0][r], clipMat[1][r], clipMat[2][r], clipMat[3][r]);
+    for (int r = 0; r < 3; r++) {
+        planes[2 * r] = rows[3] + rows[r];
+        planes[2 * r + 1] = rows[3] - rows[r];
+    }
+}
+
+bool Frustum::intersects(const AABB& box) const {
+    if (box.isEmpty()) return true;
+    glm::vec3 center = box.getCenter(), extent = box.getExtent();
+    for (int p = 0; p < 6; p++) {
+        glm::vec3 normal = glm::vec3(planes[p]);
+        // distance from the plane to the corner of the box that is furthest along the plane's normal
+        float distance = glm::dot(normal, center) + planes[p].w + glm::dot(glm::abs(normal), extent);
+        if (distance < 0.0f) return false;
+    }
+    return true;
+}
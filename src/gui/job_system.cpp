@@ -0,0 +1,170 @@
+#include "gui/job_system.hpp"
+
+// the deque owned by the calling thread (-1 if the thread doesn't belong to the job system)
+static thread_local const JobSystem* t_system = nullptr;
+static thread_local int t_deque = -1;
+// whether the calling thread is running a background job, so that the jobs it submits are background jobs too
+static thread_local bool t_background = false;
+
+static int getDeque(const JobSystem* system) { return (t_system == system) ? t_deque : -1; }
+
+JobSystem::JobSystem(const unsigned int nWorkers) : mainThread(std::this_thread::get_id()) {
+    // background jobs need a worker to run them
+    const unsigned int n = std::max(1u, nWorkers);
+    for (int d = 0; d <= n; d++) deques.push_back(std::make_unique<Deque>());
+    t_system = this;
+    t_deque = 0;
+    for (int w = 0; w < n; w++) threads.emplace_back(&JobSystem::workerLoop, this, w + 1);
+}
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& thread : threads) thread.join();
+    if (t_system == this) t_system = nullptr;
+}
+
+JobSystem& JobSystem::get() {
+    static JobSystem jobSystem;
+    return jobSystem;
+}
+
+void JobSystem::submit(std::function<void()> job, JobCounter* counter) {
+    if (counter != nullptr) counter->count.fetch_add(1, std::memory_order_relaxed);
+    push({ std::move(job), counter, t_background });
+}
+void JobSystem::submitAfter(JobCounter& dependency, std::function<void()> job, JobCounter* counter) {
+    if (counter != nullptr) counter->count.fetch_add(1, std::memory_order_relaxed);
+    {
+        // the lock is also taken by the last job of the dependency, so the job is either recorded before that job looks for dependents, or
+        // the dependency is already done here
+        std::lock_guard<std::mutex> guard(dependency.dependentsLock);
+        if (!dependency.isDone()) {
+            dependency.dependents.push_back({ std::move(job), counter, t_background });
+            return;
+        }
+    }
+    push({ std::move(job), counter, t_background });
+}
+void JobSystem::submitMain(std::function<void()> job, JobCounter* counter) {
+    if (counter != nullptr) counter->count.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> guard(mainJobs.lock);
+    mainJobs.jobs.push_back({ std::move(job), counter });
+}
+void JobSystem::submitBackground(std::function<void()> job, JobCounter* counter) {
+    if (counter != nullptr) counter->count.fetch_add(1, std::memory_order_relaxed);
+    push({ std::move(job), counter, true });
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    int index = getDeque(this);
+    Job job;
+    while (!counter.isDone()) {
+        // the main thread might be waiting on a job that only it can run
+        if (isMainThread()) runMainJobs();
+        if (pop(index, job)) run(job);
+        else std::this_thread::yield();
+    }
+    // the job that finished the counter may still hold its lock
+    std::lock_guard<std::mutex> guard(counter.dependentsLock);
+}
+void JobSystem::runMainJobs() {
+    if (!isMainThread()) {
+        std::cout << "ERROR::JOB_SYSTEM::NOT_MAIN_THREAD: Main thread jobs can only be run by the main thread." << std::endl;
+        return;
+    }
+    // jobs queued by the jobs run here wait until the next call, so that a job that requeues itself can't stall the main thread
+    std::deque<Job> jobs;
+    {
+        std::lock_guard<std::mutex> guard(mainJobs.lock);
+        jobs.swap(mainJobs.jobs);
+    }
+    for (Job& job : jobs) run(job);
+}
+
+void JobSystem::workerLoop(const unsigned int index) {
+    t_system = this;
+    t_deque = index;
+    Job job;
+    while (!stopping) {
+        if (pop(index, job)) {
+            run(job);
+            continue;
+        }
+        // a job is queued somewhere but another thread got to it first, keep looking instead of sleeping
+        if (pending.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wake.wait(guard, [this]() { return stopping || pending.load(std::memory_order_acquire) > 0; });
+    }
+}
+
+void JobSystem::push(Job&& job) {
+    int index = getDeque(this);
+    // the main thread's deque only holds jobs that it may run itself
+    if (index == -1 || (index == 0 && job.background)) index = 1 + nextDeque.fetch_add(1, std::memory_order_relaxed) % (deques.size() - 1);
+    {
+        std::lock_guard<std::mutex> guard(deques[index]->lock);
+        deques[index]->jobs.push_back(std::move(job));
+    }
+    pending.fetch_add(1, std::memory_order_release);
+    // taking the lock makes sure that a worker that just found nothing to do is either already waiting or will see the new job
+    { std::lock_guard<std::mutex> guard(sleepLock); }
+    wake.notify_one();
+}
+bool JobSystem::pop(const int index, Job& job) {
+    if (pending.load(std::memory_order_acquire) == 0) return false;
+    // newest job from the thread's own deque first
+    if (index != -1) {
+        std::lock_guard<std::mutex> guard(deques[index]->lock);
+        if (!deques[index]->jobs.empty()) {
+            job = std::move(deques[index]->jobs.back());
+            deques[index]->jobs.pop_back();
+            pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    // then the oldest job of any other deque, starting with the next one so that victims are spread out (the main thread takes the oldest
+    // job that isn't a background job)
+    for (int i = 1; i <= deques.size(); i++) {
+        int victim = (index + i + deques.size()) % deques.size();
+        if (victim == index) continue;
+        std::lock_guard<std::mutex> guard(deques[victim]->lock);
+        std::deque<Job>& jobs = deques[victim]->jobs;
+        auto j = (index == 0) ? std::find_if(jobs.begin(), jobs.end(), [](const Job& job) { return !job.background; }) : jobs.begin();
+        if (j != jobs.end()) {
+            job = std::move(*j);
+            jobs.erase(j);
+            pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+void JobSystem::run(Job& job) {
+    // a job may run inside another job's wait(), so the flag of the outer job is restored afterwards
+    bool background = t_background;
+    t_background = job.background;
+    job.func();
+    t_background = background;
+    finish(job.counter);
+    job = Job();
+}
+void JobSystem::finish(JobCounter* counter) {
+    if (counter == nullptr) return;
+    // the counter is decremented under its lock, and wait() takes the lock before returning, so the counter isn't destroyed while in use here
+    std::vector<JobCounter::Dependent> dependents;
+    {
+        std::lock_guard<std::mutex> guard(counter->dependentsLock);
+        if (counter->count.fetch_sub(1, std::memory_order_acq_rel) == 1) dependents.swap(counter->dependents);
+    }
+    for (JobCounter::Dependent& dependent : dependents) push({ std::move(dependent.func), dependent.counter, dependent.background });
+}
+
+void JobSystem::print() const {
+    std::cout << "Job System: " << threads.size() << " workers, " << pending.load() << " jobs queued" << std::endl;
+}
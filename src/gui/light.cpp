@@ -1,9 +1,12 @@
 #include "gui/light.hpp"
 
-// set the maximum number of lights that can be rendered with a single shader
-const int MAX_LIGHTS = 4;
-// the uniform name for the light variable within shaders
-const std::string LIGHT_NAME = "lightList";
+// set the maximum number of lights that can cast shadows in a scene
+const int MAX_SHADOW_MAPS = 4;
+// the light buffer layout depends on this size (see LightData)
+static_assert(sizeof(LightData) == 96, "LightData does not match the 6 texel layout read by fetchLight()");
+
+// for attenuated lights, cut off when the light diminishes to 5% of its original brightness
+const float CUTOFF = 0.05f;
 
 Light::Light(Serializer& object) {
     type = object["type"];
@@ -25,22 +28,43 @@ bool Light::operator==(Light& other) {
            inner == other.inner && outer == other.outer;
 }
 
+float Light::getRange() const {
+    // directional lights and lights without attenuation reach everywhere
+    if (type == L_DIR || (linear <= 0 && quadratic <= 0)) return INFINITY;
+    // otherwise solve qx^2 + lx + c = 1 / CUTOFF (or the linear equation if there is no quadratic term)
+    if (quadratic > 0) return 0.5 * (-linear + std::sqrt(linear * linear - 4 * quadratic * (constant - 1.0f / CUTOFF))) / quadratic;
+    return (1.0f / CUTOFF - constant) / linear;
+}
+
+LightData Light::getData(const glm::mat4& view) const {
+    LightData data;
+    data.type = type;
+    // lighting is calculated in view space, so spatial vectors need to be converted
+    data.pos = glm::vec3(view * glm::vec4(pos, 1.0f));
+    data.dir = glm::mat3(view) * dir;
+    data.ambient = ambient;
+    data.diffuse = diffuse;
+    data.specular = specular;
+    data.constant = constant;
+    data.linear = linear;
+    data.quadratic = quadratic;
+    data.inner = inner;
+    data.outer = outer;
+    return data;
+}
+
 const float NEAR = 0.1f, DIR_FAR = 10.0f, DEFAULT_FAR = 20.0f;
 void Light::setLightTransform(const glm::vec3 target) {
     glm::mat4 lightProjection, lightView;
 
     // first, define the light's fustrum
-    const float CUTOFF = 0.05f; // for attenuated lights, cut off when the light diminishes to 5% of its original brightness
     float near = NEAR, far; 
     switch(type) {
     // since directional lights use an orthographic projection, the fustrum needs to be smaller to avoid introducing weird effects
     case L_DIR: { far = DIR_FAR; } break;
     default: {
-        far = (quadratic > 0) ? 
-                    // if the light is attenuated, we want to solve the equation qx^2 + lx + c = 1 / CUTOFF
-                    0.5 * (-linear + std::sqrt(linear * linear - 4 * quadratic * (constant - 1.0f / CUTOFF))) / quadratic :
-                    // otherwise use some default large value
-                    DEFAULT_FAR;
+        // if the light is attenuated, the fustrum ends at the light's range, otherwise use some default large value
+        far = (quadratic > 0) ? getRange() : DEFAULT_FAR;
     } break;
     }
 
@@ -0,0 +1,126 @@
+#include "gui/light_grid.hpp"
+
+const int CLUSTERS_X = 16, CLUSTERS_Y = 9, CLUSTERS_Z = 24;
+
+LightGrid::LightGrid(const int width, const int height)
+        : width(width), height(height),
+          lightData(GL_RGBA32F, LIGHT_DATA_SLOT), lightGrid(GL_RG32UI, LIGHT_GRID_SLOT), lightIndices(GL_R32UI, LIGHT_INDEX_SLOT) {
+    // the grid layout does not change, so the block only needs to be fully set once
+    block.dim = glm::ivec4(CLUSTERS_X, CLUSTERS_Y, CLUSTERS_Z, 0);
+    block.scale = glm::vec4((float) CLUSTERS_X / width, (float) CLUSTERS_Y / height, CLUSTERS_Z / std::log(FAR / NEAR), NEAR);
+    block.nLights = 0;
+
+    grid.resize(2 * CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z);
+}
+
+void LightGrid::update(const std::vector<std::shared_ptr<Light>>& lights, const Camera& camera) {
+    const glm::mat4 view = camera.getView(), proj = camera.getProj();
+
+    data.resize(lights.size());
+    bounds.resize(lights.size());
+    indices.clear();
+    // the second value of each cluster's pair is used as a counter until offsets are assigned
+    for (int c = 0; c < grid.size(); c++) grid[c] = 0;
+
+    // first pass: convert lights to view space, list global lights, and count how many lights will be listed in each cluster
+    for (int l = 0; l < lights.size(); l++) {
+        // empty slots (removed lights) aren't listed in any cluster, so their data is never read
+        if (lights[l] == nullptr) {
+            bounds[l].valid = false;
+            continue;
+        }
+        data[l] = lights[l]->getData(view);
+        float range = lights[l]->getRange();
+        if (std::isinf(range)) {
+            indices.push_back(l);
+            bounds[l].valid = false;
+            continue;
+        }
+        bounds[l] = getClusterBounds(data[l].pos, range, proj);
+        if (!bounds[l].valid) continue;
+        for (int z = bounds[l].min.z; z <= bounds[l].max.z; z++)
+            for (int y = bounds[l].min.y; y <= bounds[l].max.y; y++)
+                for (int x = bounds[l].min.x; x <= bounds[l].max.x; x++)
+                    grid[2 * (x + CLUSTERS_X * (y + CLUSTERS_Y * z)) + 1]++;
+    }
+    const int nGlobal = indices.size();
+
+    // assign each cluster an offset into the index list (cluster lists start after the global lights)
+    unsigned int offset = nGlobal;
+    for (int c = 0; c < grid.size(); c += 2) {
+        grid[c] = offset;
+        offset += grid[c + 1];
+        grid[c + 1] = 0;
+    }
+    indices.resize(offset);
+
+    // second pass: fill each cluster's list
+    for (int l = 0; l < lights.size(); l++) {
+        if (!bounds[l].valid) continue;
+        for (int z = bounds[l].min.z; z <= bounds[l].max.z; z++)
+            for (int y = bounds[l].min.y; y <= bounds[l].max.y; y++)
+                for (int x = bounds[l].min.x; x <= bounds[l].max.x; x++) {
+                    int c = 2 * (x + CLUSTERS_X * (y + CLUSTERS_Y * z));
+                    indices[grid[c] + grid[c + 1]++] = l;
+                }
+    }
+
+    // upload everything to the gpu
+    lightData.setData(data.size() * sizeof(LightData), data.data());
+    lightGrid.setData(grid.size() * sizeof(unsigned int), grid.data());
+    lightIndices.setData(indices.size() * sizeof(unsigned int), indices.data());
+
+    block.dim.w = nGlobal;
+    block.nLights = lights.size();
+}
+
+LightGrid::ClusterBounds LightGrid::getClusterBounds(const glm::vec3 center, const float radius, const glm::mat4& proj) const {
+    ClusterBounds bounds;
+
+    // the view direction is -z, so find the sphere's depth range and clip it to the camera fustrum
+    float zNear = -center.z - radius, zFar = -center.z + radius;
+    if (zFar < NEAR || zNear > FAR) return bounds;
+    if (zNear < NEAR) zNear = NEAR;
+    if (zFar > FAR) zFar = FAR;
+
+    /* Bound the sphere by a box in view space and project the box's extremes onto the screen. For a fixed x, x / depth is monotonic in
+     * depth, so the extreme screen coordinates are found at the corners of the box.
+     */
+    float xMin = INFINITY, xMax = -INFINITY, yMin = INFINITY, yMax = -INFINITY;
+    for (float depth : { zNear, zFar }) for (float sign : { -1.0f, 1.0f }) {
+        float x = proj[0][0] * (center.x + sign * radius) / depth, y = proj[1][1] * (center.y + sign * radius) / depth;
+        xMin = std::min(xMin, x); xMax = std::max(xMax, x);
+        yMin = std::min(yMin, y); yMax = std::max(yMax, y);
+    }
+    // lights that are entirely off screen don't need to be listed
+    if (xMax < -1.0f || xMin > 1.0f || yMax < -1.0f || yMin > 1.0f) return bounds;
+
+    // convert from normalized device coordinates [-1, 1] to clusters
+    auto toCluster = [](const float ndc, const int n) {
+        int c = (int) ((0.5f * ndc + 0.5f) * n);
+        return (c < 0) ? 0 : (c >= n) ? n - 1 : c;
+    };
+    bounds.valid = true;
+    bounds.min = glm::ivec3(toCluster(xMin, CLUSTERS_X), toCluster(yMin, CLUSTERS_Y), getSlice(zNear));
+    bounds.max = glm::ivec3(toCluster(xMax, CLUSTERS_X), toCluster(yMax, CLUSTERS_Y), getSlice(zFar));
+    return bounds;
+}
+int LightGrid::getSlice(const float depth) const {
+    // slices are spaced exponentially, so the slice is proportional to log(depth / near) (this must match the shader)
+    int slice = (int) (std::log(depth / NEAR) * block.scale.z);
+    return (slice < 0) ? 0 : (slice >= CLUSTERS_Z) ? CLUSTERS_Z - 1 : slice;
+}
+
+void LightGrid::print() const {
+    int nClusters = CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z, nEmpty = 0;
+    unsigned int maxCount = 0;
+    for (int c = 0; c < grid.size(); c += 2) {
+        if (grid[c + 1] == 0) nEmpty++;
+        if (grid[c + 1] > maxCount) maxCount = grid[c + 1];
+    }
+    std::cout << "Light Grid (" << CLUSTERS_X << "x" << CLUSTERS_Y << "x" << CLUSTERS_Z << "):" << std::endl;
+    std::cout << "\tLights: " << block.nLights << " (" << block.dim.w << " global)" << std::endl;
+    std::cout << "\tListed: " << indices.size() - block.dim.w << " (" << (float) (indices.size() - block.dim.w) / nClusters <<
+                 " per cluster, " << maxCount << " max)" << std::endl;
+    std::cout << "\tEmpty clusters: " << nEmpty << " of " << nClusters << std::endl;
+}
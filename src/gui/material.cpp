@@ -1,7 +1,11 @@
 #include "gui/material.hpp"
 
-const unsigned int N_TEXTURES[] = { 0, 0, 1, 2, 3 };
-const std::string MAT_NAME[] = { "", "material", "dMap", "dsMap", "dseMap" };
+#include "gui/pool.hpp"
+#include "gui/texture.hpp"
+
+const unsigned int N_TEXTURES[] = { 0, 0, 1, 2, 3, 3 };
+const std::string MAP_NAME[] = { "maps.diffuse", "maps.specular", "maps.emission" };
+const unsigned int MAX_MATERIALS = 256;
 
 Material::Material(glm::vec3 ambient, glm::vec3 diffuse, glm::vec3 specular, float shininess)
         : type(M_BASIC), basicMat({ambient, diffuse, specular, shininess}) {}
@@ -39,7 +43,7 @@ Material::Material(Serializer& object) {
     }
 }
 
-bool Material::operator==(Material& other) {
+bool Material::operator==(const Material& other) const {
     if (type == other.type) {
         switch(type) {
         case M_BASIC: {
@@ -60,6 +64,58 @@ bool Material::operator==(Material& other) {
         }
     } return false;
 }
+std::size_t Material::hash() const {
+    std::size_t seed = 0;
+    hashCombine(seed, type);
+    switch(type) {
+    case M_BASIC: {
+        for (int c = 0; c < 3; c++) {
+            hashCombine(seed, basicMat.ambient[c]);
+            hashCombine(seed, basicMat.diffuse[c]);
+            hashCombine(seed, basicMat.specular[c]);
+        }
+        hashCombine(seed, basicMat.shininess);
+    } break;
+    case M_D_MAP: {
+        hashCombine(seed, dMap.diffuse);
+        for (int c = 0; c < 3; c++) hashCombine(seed, dMap.specular[c]);
+        hashCombine(seed, dMap.shininess);
+    } break;
+    case M_DS_MAP: { hashCombine(seed, dsMap.diffuse); hashCombine(seed, dsMap.specular); hashCombine(seed, dsMap.shininess); } break;
+    case M_DSE_MAP: {
+        hashCombine(seed, dseMap.diffuse);
+        hashCombine(seed, dseMap.specular);
+        hashCombine(seed, dseMap.emission);
+        hashCombine(seed, dseMap.shininess);
+    } break;
+    }
+    return seed;
+}
+
+MaterialData Material::getData() const {
+    MaterialData data = { glm::vec4(0.0f), glm::vec4(0.0f), glm::vec4(0.0f), glm::ivec4(0) };
+    data.maps.w = type;
+    switch(type) {
+    case M_BASIC: {
+        data.ambient = glm::vec4(basicMat.ambient, 0.0f);
+        data.diffuse = glm::vec4(basicMat.diffuse, 0.0f);
+        data.specular = glm::vec4(basicMat.specular, basicMat.shininess);
+    } break;
+    case M_D_MAP: { data.specular = glm::vec4(dMap.specular, dMap.shininess); } break;
+    case M_DS_MAP: { data.specular.w = dsMap.shininess; } break;
+    case M_DSE_MAP: { data.specular.w = dseMap.shininess; } break;
+    }
+    return data;
+}
+
+int Material::getSlot(const unsigned int map) const {
+    switch(type) {
+    case M_D_MAP: return (map == DIFFUSE) ? dMap.diffuse : -1;
+    case M_DS_MAP: return (map == DIFFUSE) ? dsMap.diffuse : (map == SPECULAR) ? dsMap.specular : -1;
+    case M_DSE_MAP: return (map == DIFFUSE) ? dseMap.diffuse : (map == SPECULAR) ? dseMap.specular : dseMap.emission;
+    default: return -1;
+    }
+}
 
 Serializer Material::getJSON() {
     Serializer object;
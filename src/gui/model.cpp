@@ -11,6 +11,7 @@ Model::Model(Serializer& object) {
     aos = object["aos"];
     angle = object["angle"];
     color = object["color"];
+    setModel();
 }
 void Model::setModel() {
     // applies transformations to model matrix
@@ -18,6 +19,27 @@ void Model::setModel() {
     model = glm::translate(model, pos);     // translates in 3D space to be centered on pos vector
     model = glm::scale(model, scale);       // scales in x dir by scale.x, y dir by scale.y, z dir by scale.z
     model = glm::rotate(model, angle, aos); // rotates by angle around the vector aos (axis of symmetry)
+    normal = glm::mat3(glm::transpose(glm::inverse(model)));
+    if (vertexArray != nullptr) bounds = vertexArray->getBounds().transform(model);
+    if (store != nullptr) store->setTransform(handle, model, normal, bounds);
+}
+void Model::addToStore(std::shared_ptr<ModelStore> store) {
+    if (this->store == store) return;
+    if (this->store != nullptr) {
+        std::cout << "ERROR::MODEL::ALREADY_STORED: The model already belongs to another model store." << std::endl;
+        return;
+    }
+    handle = store->add(*this);
+    this->store = store;
+}
+void Model::removeFromStore() {
+    if (store == nullptr) return;
+    model = store->getTransform(handle);
+    normal = store->getNormal(handle);
+    bounds = store->getBounds(handle);
+    store->remove(handle);
+    store = nullptr;
+    handle = 0;
 }
 
 
@@ -0,0 +1,52 @@
+#include "gui/model_store.hpp"
+
+#include "gui/model.hpp"
+
+unsigned int ModelStore::add(const Model& model) {
+    // find (or add) the model's mesh and texture group in the tables
+    auto mesh = mesh_lookup.try_emplace(model.getVertexArray().get(), meshes.size());
+    if (mesh.second) meshes.push_back(model.getVertexArray());
+    auto textureGroup = textureGroup_lookup.try_emplace(model.getTextureGroup().get(), textureGroups.size());
+    if (textureGroup.second) textureGroups.push_back(model.getTextureGroup());
+
+    if (!freeHandles.empty()) {
+        unsigned int handle = freeHandles.back();
+        freeHandles.pop_back();
+        transforms[handle] = model.getModel();
+        normals[handle] = model.getNormal();
+        bounds[handle] = model.getBounds();
+        meshIDs[handle] = mesh.first->second;
+        textureGroupIDs[handle] = textureGroup.first->second;
+        materialIndices[handle] = model.getMaterialIndex();
+        colors[handle] = model.getColor();
+        flags[handle] = 0;
+        return handle;
+    }
+    transforms.push_back(model.getModel());
+    normals.push_back(model.getNormal());
+    bounds.push_back(model.getBounds());
+    meshIDs.push_back(mesh.first->second);
+    textureGroupIDs.push_back(textureGroup.first->second);
+    materialIndices.push_back(model.getMaterialIndex());
+    colors.push_back(model.getColor());
+    flags.push_back(0);
+    return size() - 1;
+}
+void ModelStore::remove(const unsigned int handle) {
+    // free slots have empty bounds and no flags, so loops over every handle skip them
+    bounds[handle] = AABB();
+    flags[handle] = 0;
+    freeHandles.push_back(handle);
+}
+
+void ModelStore::setTransform(const unsigned int handle, const glm::mat4& transform, const glm::mat3& normal, const AABB& bounds) {
+    transforms[handle] = transform;
+    normals[handle] = normal;
+    this->bounds[handle] = bounds;
+    flags[handle] |= MF_MOVED;
+}
+
+void ModelStore::print() const {
+    std::cout << "Model Store: " << size() - freeHandles.size() << " models, " << meshes.size() << " meshes, " << 
+                 textureGroups.size() - 1 << " texture groups" << std::endl;
+}
@@ -0,0 +1,51 @@
+#include "gui/occlusion.hpp"
+
+OcclusionQueries::~OcclusionQueries() {
+    for (Query& query : queries) glDeleteQueries(1, &query.queryID);
+    #if DEBUG_OPENGL_OBJECTS
+        std::cout << queries.size() << " occlusion queries were deleted." << std::endl;
+    #endif
+}
+
+void OcclusionQueries::resize(const unsigned int n) {
+    while (queries.size() < n) {
+        Query query;
+        glGenQueries(1, &query.queryID);
+        queries.push_back(query);
+    }
+}
+
+void OcclusionQueries::remove(const unsigned int m, const unsigned int last) {
+    if (last >= queries.size()) return;
+    std::swap(queries[m], queries[last]);
+    // the removed model's result (even one still in flight) means nothing to the next model added, which starts with a fresh query
+    queries[last].pending = false;
+    queries[last].occluded = false;
+    queries[last].conditional = false;
+}
+
+void OcclusionQueries::update() {
+    for (Query& query : queries) if (query.pending) {
+        unsigned int available = 0, samplesPassed = 0;
+        glGetQueryObjectuiv(query.queryID, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+        glGetQueryObjectuiv(query.queryID, GL_QUERY_RESULT, &samplesPassed);
+        query.occluded = (samplesPassed == 0);
+        query.pending = false;
+    }
+}
+
+void OcclusionQueries::begin(const unsigned int m) {
+    Query& query = queries[m];
+    query.conditional = query.pending;
+    if (query.conditional) glBeginConditionalRender(query.queryID, GL_QUERY_NO_WAIT);
+    else glBeginQuery(GL_ANY_SAMPLES_PASSED, query.queryID);
+}
+void OcclusionQueries::end(const unsigned int m) {
+    Query& query = queries[m];
+    if (query.conditional) glEndConditionalRender();
+    else {
+        glEndQuery(GL_ANY_SAMPLES_PASSED);
+        query.pending = true;
+    }
+}
@@ -1,5 +1,8 @@
 #include "gui/render_group.hpp"
 
+// names of the G-buffer samplers in the deferred lighting shader, indexed by gbuffer_targets
+const std::string GBUFFER_NAMES[] = { "gNormal", "gAmbient", "gDiffuse", "gSpecular", "gDepth" };
+
 RenderGroup::RenderGroup(Serializer& object) {
     shader = std::make_shared<Shader>(static_cast<Serializer&>(object["shader"]));
     for (int i = 0; i < object["models"].size(); i++)
@@ -11,13 +14,49 @@ RenderGroup::RenderGroup(Serializer& object) {
 void RenderGroup::addModel(std::shared_ptr<Model> model) {
     // add a pointer to index map and then add the model to the model array
     models.push_back(model);
+    if (!loaded) return;
+    // once the group is loaded, the model's per model data is set up as it would have been by load()
+    model->addToStore(store);
+    handles.push_back(model->getHandle());
+    if (sortModels) {
+        stateKeys.push_back(getStateKey(handles.back()));
+        sortKeys.resize(models.size());
+    }
+    if (prepareModelSequence.size() > 0) transforms.resize(models.size());
+}
+void RenderGroup::removeModel(const int m) {
+    int last = models.size() - 1;
+    models[m] = models[last];
+    handles[m] = handles[last];
+    models.pop_back();
+    handles.pop_back();
+    if (sortModels) {
+        stateKeys[m] = stateKeys[last];
+        stateKeys.pop_back();
+        sortKeys.pop_back();
+    }
+    if (prepareModelSequence.size() > 0) transforms.pop_back();
+    if (occlusion != nullptr) occlusion->remove(m, last);
 }
 void RenderGroup::addLight(std::shared_ptr<Light> light) {
     // as above
     lights.push_back(light);
 }
+void RenderGroup::setLight(const unsigned int l, std::shared_ptr<Light> light) {
+    if (l >= lights.size()) lights.resize(l + 1);
+    lights[l] = light;
+}
+
+void RenderGroup::setModelStore(std::shared_ptr<ModelStore> store) {
+    this->store = store;
+    for (std::shared_ptr<Model>& model : models) model->addToStore(store);
+}
 
 void RenderGroup::load() {
+    if (store == nullptr) setModelStore(std::make_shared<ModelStore>());
+    handles.resize(models.size());
+    for (int m = 0; m < models.size(); m++) handles[m] = models[m]->getHandle();
+
     renderSequence.push_back(BIND_SHADER);
     switch(getShader()->getRenderingStyle()) {
     case R_BASIC_2D: {
@@ -29,32 +68,185 @@ void RenderGroup::load() {
             renderSequence.push_back(TOGGLE_CULLING);
             postRenderSequence.push_back(TOGGLE_CULLING);
         }
-        renderSequence.push_back(CALC_TRANS_VP);
+        prepareSequence.push_back(CALC_TRANS_VP);
+        // shadow maps only need the models that the light can see
+        if (!sceneCulling) 
+            (getShader()->getPostprocessing() == P_SHADOW_MAP) ? prepareSequence.push_back(CULL_LIGHT) : prepareSequence.push_back(CULL_CAMERA);
+        if (getShader()->getPostprocessing() == P_SHADOW_MAP) prepareModelSequence.push_back(CALC_TRANS_SM);
+        sortModels = true;
+        // the order of a shadow map's draws doesn't affect how many fragments pass the depth test as much, so only state is sorted
+        frontToBack = getShader()->getPostprocessing() != P_SHADOW_MAP;
         (getShader()->getTextureStyle() == T_DISABLED) ? modelSequence.push_back(SET_VALUE) : modelSequence.push_back(SET_VALUE_T);
         (getShader()->getPostprocessing() == P_SHADOW_MAP) ? modelSequence.push_back(SET_TRANS_SM) : modelSequence.push_back(SET_TRANS);
         modelSequence.push_back(RENDER_MODEL);
     } break;
     case R_LIGHTING_3D: {
-        renderSequence.push_back(CALC_TRANS_VP);
-        lightSequence.push_back(SET_LIGHT);
+        // the depth pre-pass draws positions only, with color writes off
+        if (getShader()->isDepthPrepass()) {
+            renderSequence.push_back(DISABLE_COLOR_WRITES);
+            if (!sceneCulling) prepareSequence.push_back(CULL_CAMERA);
+            sortModels = frontToBack = true;
+            modelSequence.push_back(SET_TRANS_D);
+            modelSequence.push_back(RENDER_DEPTH);
+            postRenderSequence.push_back(ENABLE_COLOR_WRITES);
+            break;
+        }
+        // camera, light and light space data are read from the shared uniform buffers, only per model data is set here
+        initSequence.push_back(BIND_SHADER);
+        initSequence.push_back(SET_LIGHT_GRID);
+        if (getShader()->getShadowStyle() == S_SHADOW_MAPPING) initSequence.push_back(SET_SHADOW_MAPS);
+        if (!sceneCulling) prepareSequence.push_back(CULL_CAMERA);
+        sortModels = frontToBack = true;
+        // after a depth pre-pass, only the front-most fragment of each pixel passes the depth test
+        if (depthPrepass) {
+            renderSequence.push_back(SET_DEPTH_TEST_EQ);
+            renderSequence.push_back(DISABLE_DEPTH_WRITES);
+            postRenderSequence.push_back(SET_DEPTH_TEST_L);
+            postRenderSequence.push_back(ENABLE_DEPTH_WRITES);
+        }
         modelSequence.push_back(SET_MATERIAL);
+        modelSequence.push_back(SET_MATERIAL_MAPS);
         modelSequence.push_back(SET_TRANS_L);
-        if (getShader()->getShadowStyle() == S_SHADOW_MAPPING) {
-            lightSequence.push_back(CALC_TRANS_S);
-            modelSequence.push_back(SET_TRANS_S);
-        }
+        modelSequence.push_back(RENDER_MODEL);
+    } break;
+    case R_GBUFFER_3D: {
+        // like a lit group, but only material data is needed since the models are lit later by the deferred lighting pass
+        initSequence.push_back(BIND_SHADER);
+        if (!sceneCulling) prepareSequence.push_back(CULL_CAMERA);
+        sortModels = frontToBack = true;
+        modelSequence.push_back(SET_MATERIAL);
+        modelSequence.push_back(SET_MATERIAL_MAPS);
+        modelSequence.push_back(SET_TRANS_L);
+        modelSequence.push_back(RENDER_MODEL);
+    } break;
+    case R_DEFERRED_LIGHTING: {
+        // the only model is a pane that covers the screen and carries the G-buffer targets
+        initSequence.push_back(BIND_SHADER);
+        initSequence.push_back(SET_LIGHT_GRID);
+        if (getShader()->getShadowStyle() == S_SHADOW_MAPPING) initSequence.push_back(SET_SHADOW_MAPS);
+        prepareSequence.push_back(CALC_TRANS_VP);
+        renderSequence.push_back(SET_INV_TRANS);
+        modelSequence.push_back(SET_GBUFFER_MAPS);
         modelSequence.push_back(RENDER_MODEL);
     } break;
     case R_SKYBOX: {
         renderSequence.push_back(SET_DEPTH_TEST_LE);
-        renderSequence.push_back(CALC_TRANS_VP);
-        modelSequence.push_back(SET_TRANS_SKYBOX);
         modelSequence.push_back(RENDER_MODEL);
         postRenderSequence.push_back(SET_DEPTH_TEST_L);
     } break;
     }
+    if (occlusion != nullptr) {
+        // models hidden last frame are skipped, the rest are drawn inside their queries, then the hidden ones are tested again
+        renderSequence.push_back(CULL_OCCLUDED);
+        modelSequence.insert(modelSequence.begin(), BEGIN_OCCLUSION_QUERY);
+        modelSequence.push_back(END_OCCLUSION_QUERY);
+        postRenderSequence.push_back(TEST_OCCLUDED);
+    }
+
+    // models that share a texture group and a vertex array get the same state key, so that sorting draws them one after another
+    if (sortModels) {
+        stateKeys.resize(models.size());
+        for (int m = 0; m < models.size(); m++) stateKeys[m] = getStateKey(handles[m]);
+        sortKeys.resize(models.size());
+    }
+    if (prepareModelSequence.size() > 0) transforms.resize(models.size());
+
+    // the init sequence sets uniforms, so it waits until the shader is built (see render())
+    init();
+    loaded = true;
+}
+void RenderGroup::init() {
+    if (!shader->isReady()) return;
+    // uniforms that do not change between frames only need to be set once
+    for (void (*i_func)(RenderGroup&) : initSequence) {
+        #if DEBUG_RENDER_FUNCTIONS 
+            printFunc((void*) i_func); 
+        #endif
+        i_func(*this);
+    }
+    initialized = true;
+}
+double RenderGroup::warmUp() {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    // render() skips the group until its shaders are built, so they are waited for here instead
+    if (proxyShader != nullptr) proxyShader->wait();
+    if (shader->wait() && !initialized) init();
+    if (initialized) {
+        // models that share a vertex layout draw with the same state, so one of each is enough
+        std::vector<std::size_t> layouts;
+        std::vector<int> drawn;
+        for (int m = 0; m < models.size(); m++) {
+            std::size_t layout = getMesh(m).getLayout();
+            if (std::find(layouts.begin(), layouts.end(), layout) != layouts.end()) continue;
+            layouts.push_back(layout);
+            drawn.push_back(m);
+        }
+        // occlusion queries depend on earlier frames, so they are left out
+        for (void (*r_func)(RenderGroup&) : renderSequence) if (r_func != CULL_OCCLUDED) r_func(*this);
+        for (int l = 0; l < lights.size(); l++) for (void (*l_func)(RenderGroup&, int) : lightSequence) l_func(*this, l);
+        for (int m : drawn) for (void (*m_func)(RenderGroup&, int) : modelSequence) 
+            if (m_func != BEGIN_OCCLUSION_QUERY && m_func != END_OCCLUSION_QUERY) m_func(*this, m);
+        for (void (*pr_func)(RenderGroup&) : postRenderSequence) if (pr_func != TEST_OCCLUDED) pr_func(*this);
+        // the draws are only done (and the program only finished) once the driver has worked through them
+        glFinish();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+void RenderGroup::prepare() {
+    // every model is visible until a cull function removes it (unless the scene has already filled the visible list)
+    if (!sceneCulling) {
+        visible.resize(models.size());
+        for (int m = 0; m < models.size(); m++) visible[m] = m;
+    }
+
+    for (void (*p_func)(RenderGroup&) : prepareSequence) {
+        #if DEBUG_RENDER_FUNCTIONS 
+            printFunc((void*) p_func); 
+        #endif
+        p_func(*this);
+    }
 }
+void RenderGroup::prepareModels(const unsigned int begin, const unsigned int end) {
+    glm::vec3 camPos = (camera != nullptr) ? camera->getPos() : glm::vec3(0.0f);
+    for (int i = begin; i < end && i < visible.size(); i++) {
+        int m = visible[i];
+        for (void (*pm_func)(RenderGroup&, int) : prepareModelSequence) pm_func(*this, m);
+        if (!sortModels) continue;
+        // distances are positive, so their bit patterns sort in the same order as the floats themselves
+        uint32_t depthKey = 0;
+        if (frontToBack) {
+            const AABB& bounds = getBounds(m);
+            glm::vec3 center = bounds.isEmpty() ? glm::vec3(getModelMat(m)[3]) : bounds.getCenter();
+            depthKey = std::bit_cast<uint32_t>(glm::length(center - camPos));
+        }
+        sortKeys[m] = ((uint64_t) stateKeys[m] << 32) | depthKey;
+    }
+}
+void RenderGroup::sortVisible() {
+    if (!sortModels) return;
+    std::sort(visible.begin(), visible.end(), [&](const int a, const int b) 
+        { return (sortKeys[a] != sortKeys[b]) ? sortKeys[a] < sortKeys[b] : a < b; });
+}
+
+void RenderGroup::setMaterialMaps(const Material& material) {
+    // models are sorted by texture group, so the slots rarely change between draws
+    for (int t = 0; t < N_TEXTURES[material.type]; t++) {
+        int slot = material.getSlot(t);
+        if (slot == mapSlots[t]) continue;
+        shader->setUniform(MAP_NAME[t], slot);
+        mapSlots[t] = slot;
+    }
+}
+
 void RenderGroup::render() {
+    // a group whose shaders are still being compiled draws nothing (the frame it renders to is drawn without it)
+    if (!initialized) {
+        if (proxyShader != nullptr && !proxyShader->isReady()) return;
+        init();
+        if (!initialized) return;
+    }
+    // other groups may use the same program, so the material samplers are set again each time the group is drawn
+    std::fill(std::begin(mapSlots), std::end(mapSlots), -1);
     // call the render function
     for (void (*r_func)(RenderGroup&) : renderSequence) {
         #if DEBUG_RENDER_FUNCTIONS 
@@ -62,13 +254,13 @@ void RenderGroup::render() {
         #endif
         r_func(*this);
     }
-    for (int l = 0; l < MAX_LIGHTS; l++) for (void (*l_func)(RenderGroup&, int) : lightSequence) {
+    for (int l = 0; l < lights.size(); l++) for (void (*l_func)(RenderGroup&, int) : lightSequence) {
         #if DEBUG_RENDER_FUNCTIONS 
             printFunc((void*) l_func); 
         #endif
         l_func(*this, l);
     }
-    for (int m = 0; m < models.size(); m++) for (void (*m_func)(RenderGroup&, int) : modelSequence) {
+    for (int m : visible) for (void (*m_func)(RenderGroup&, int) : modelSequence) {
         #if DEBUG_RENDER_FUNCTIONS 
             printFunc((void*) m_func); 
         #endif
@@ -82,6 +274,66 @@ void RenderGroup::render() {
     }
 }
 
+void RenderGroup::cull(const Frustum& frustum) {
+    // compact the visible list in place, keeping models in their original order
+    int nKept = 0;
+    for (int m : visible) if (frustum.intersects(getBounds(m))) visible[nKept++] = m;
+    visible.resize(nKept);
+}
+
+void RenderGroup::enableOcclusionCulling(std::shared_ptr<Shader> proxyShader, std::shared_ptr<VertexArray> proxyBox) {
+    occlusion = std::make_unique<OcclusionQueries>();
+    this->proxyShader = proxyShader;
+    this->proxyBox = proxyBox;
+}
+void RenderGroup::cullOccluded() {
+    occlusion->resize(models.size());
+    occlusion->update();
+
+    occluded.clear();
+    occludedTriangles = 0;
+    glm::vec3 camPos = camera->getPos();
+    int nKept = 0;
+    for (int m : visible) {
+        const AABB& bounds = getBounds(m);
+        // if the camera is inside a model's bounds, its proxy box would be clipped by the near plane, so it is always drawn
+        bool inside = bounds.isEmpty() || (glm::all(glm::greaterThanEqual(camPos, bounds.min - NEAR)) && 
+                                           glm::all(glm::lessThanEqual(camPos, bounds.max + NEAR)));
+        if (!inside && occlusion->isOccluded(m)) {
+            const VertexArray& vertexArray = getMesh(m);
+            occludedTriangles += ((vertexArray.getIndexCount() > 0) ? vertexArray.getIndexCount() : vertexArray.getVertexCount()) / 3;
+            occluded.push_back(m);
+        } else visible[nKept++] = m;
+    }
+    visible.resize(nKept);
+}
+void RenderGroup::testOccluded() {
+    if (occluded.size() == 0) return;
+
+    // the proxy boxes only need to be depth tested, nothing is written, and their back faces are needed if the front faces are clipped
+    bool faceCulling = r_IsFaceCullingEnabled();
+    if (faceCulling) r_DisableFaceCulling();
+    r_DisableColorWrites();
+    r_DisableDepthWrites();
+
+    proxyShader->use();
+    glm::mat4 clipMat = camera->getProj() * camera->getView();
+    for (int m : occluded) {
+        // a proxy whose last query is still in flight doesn't need another one
+        if (occlusion->isPending(m)) continue;
+        const AABB& bounds = getBounds(m);
+        glm::mat4 boxMat = glm::scale(glm::translate(glm::mat4(1.0f), bounds.getCenter()), bounds.getExtent());
+        proxyShader->setUniform("clipMat", clipMat * boxMat);
+        occlusion->begin(m);
+        r_DrawIndices(*proxyBox, *proxyShader);
+        occlusion->end(m);
+    }
+
+    r_EnableDepthWrites();
+    r_EnableColorWrites();
+    if (faceCulling) r_EnableFaceCulling();
+}
+
 Serializer RenderGroup::getJSON() {
     Serializer object;
     object["shader"] = std::move(shader->getJSON());
@@ -99,9 +351,28 @@ void RenderGroup::print(int tab) const {
     for (int i = 0; i < models.size(); i++) std::cout << tabs << "Model[" << i << "]: " << models[i] << std::endl;
 }
 void RenderGroup::printRenderSequence() const {
+    if (initSequence.size() > 0) {
+        std::cout << "(on load)" << std::endl;
+        for (void (*i_func)(RenderGroup&) : initSequence) printFunc((void*) i_func);
+        std::cout << "(on render)" << std::endl;
+    }
+    if (prepareSequence.size() > 0 || prepareModelSequence.size() > 0) {
+        std::cout << "(on prepare)" << std::endl;
+        for (void (*p_func)(RenderGroup&) : prepareSequence) printFunc((void*) p_func);
+        if (prepareModelSequence.size() > 0) {
+            std::cout << "for (int m : visible) {" << std::endl;
+            for (void (*pm_func)(RenderGroup&, int) : prepareModelSequence) {
+                std::cout << "\t";
+                printFunc((void*) pm_func);
+            }
+            std::cout << "}" << std::endl;
+        }
+        if (sortModels) std::cout << "rg.sortVisible();" << std::endl;
+        std::cout << "(on render)" << std::endl;
+    }
     for (void (*r_func)(RenderGroup&) : renderSequence) printFunc((void*) r_func);
     if (lightSequence.size() > 0) {
-        std::cout << "for (int l = 0; l < MAX_LIGHTS; l++) {" << std::endl;
+        std::cout << "for (int l = 0; l < rg.nLights(); l++) {" << std::endl;
         for (void (*l_func)(RenderGroup&, int) : lightSequence) {
             std::cout << "\t";
             printFunc((void*) l_func);
@@ -109,7 +380,7 @@ void RenderGroup::printRenderSequence() const {
         std::cout << "}" << std::endl;
     }
     if (modelSequence.size() > 0) {
-        std::cout << "for (int m = 0; m < models.size(); m++) {" << std::endl;
+        std::cout << "for (int m : visible) {" << std::endl;
         for (void (*m_func)(RenderGroup&, int) : modelSequence) {
             std::cout << "\t";
             printFunc((void*) m_func);
@@ -123,41 +394,59 @@ void RenderGroup::printFunc(void* func) const {
     if (func == (void*) BIND_SHADER) std::cout << "rg.getShader()->use();" << std::endl;
     else if (func == (void*) SET_DEPTH_TEST_LE) std::cout << "r_SetDepthTest(D_LEQUAL);" << std::endl;
     else if (func == (void*) SET_DEPTH_TEST_L) std::cout << "r_SetDepthTest(D_LESS);" << std::endl;
+    else if (func == (void*) SET_DEPTH_TEST_EQ) std::cout << "r_SetDepthTest(D_EQUAL);" << std::endl;
+    else if (func == (void*) DISABLE_COLOR_WRITES) std::cout << "r_DisableColorWrites();" << std::endl;
+    else if (func == (void*) ENABLE_COLOR_WRITES) std::cout << "r_EnableColorWrites();" << std::endl;
+    else if (func == (void*) DISABLE_DEPTH_WRITES) std::cout << "r_DisableDepthWrites();" << std::endl;
+    else if (func == (void*) ENABLE_DEPTH_WRITES) std::cout << "r_EnableDepthWrites();" << std::endl;
     else if (func == (void*) TOGGLE_CULLING) std::cout << "r_ToggleFaceCulling();" << std::endl;
     else if (func == (void*) CALC_TRANS_V) std::cout << "rg.setCamView(rg.getCamera()->getView());" << std::endl;
     else if (func == (void*) CALC_TRANS_VP) 
-        std::cout << "rg.setCamView(rg.getCamera()->getView());\nrg.setCamProj(rg.getCamera()->getProj());" << std::endl; 
-    else if (func == (void*) CALC_TRANS_S) 
-        std::cout << "rg.setLightView((l < rg.nLights()) ? rg.getLight(l)->getLightTransform() : glm::mat4(1.0f), l);" << std::endl;
-    else if (func == (void*) SET_LIGHT) 
-        std::cout << "rg.getShader()->setUniform(\"lightList[\" + std::to_string(l) + \"]\"," << 
-                     "(l < rg.nLights()) ? *(rg.getLight(l)) : NULL_LIGHT, rg.getCamView());" << std::endl; 
+        std::cout << "rg.setCamView(rg.getCamera()->getView());\nrg.setCamProj(rg.getCamera()->getProj());\n" <<
+                     "rg.setCamClip(rg.getCamProj() * rg.getCamView());" << std::endl; 
+    else if (func == (void*) CALC_TRANS_SM)
+        std::cout << "rg.setTransform(m, rg.getLight()->getLightTransform() * rg.getModelMat(m));" << std::endl;
+    else if (func == (void*) CULL_CAMERA) 
+        std::cout << "rg.cull(Frustum(rg.getCamera()->getProj() * rg.getCamera()->getView()));" << std::endl;
+    else if (func == (void*) CULL_LIGHT) std::cout << "rg.cull(Frustum(rg.getLight()->getLightTransform()));" << std::endl;
+    else if (func == (void*) CULL_OCCLUDED) std::cout << "rg.cullOccluded();" << std::endl;
+    else if (func == (void*) TEST_OCCLUDED) std::cout << "rg.testOccluded();" << std::endl;
+    else if (func == (void*) BEGIN_OCCLUSION_QUERY) std::cout << "rg.beginOcclusionQuery(m);" << std::endl;
+    else if (func == (void*) END_OCCLUSION_QUERY) std::cout << "rg.endOcclusionQuery(m);" << std::endl;
+    else if (func == (void*) SET_LIGHT_GRID)
+        std::cout << "rg.getShader()->setUniform(\"lightData\", LIGHT_DATA_SLOT);\n" <<
+                     "rg.getShader()->setUniform(\"lightGrid\", LIGHT_GRID_SLOT);\n" <<
+                     "rg.getShader()->setUniform(\"lightIndices\", LIGHT_INDEX_SLOT);" << std::endl;
+    else if (func == (void*) SET_SHADOW_MAPS)
+        std::cout << "for (int l = 0; l < rg.nLights() && l < MAX_SHADOW_MAPS; l++) if (rg.getLight(l) != nullptr)\n" <<
+                     "\trg.getShader()->setUniform(\"shadowMap[\" + std::to_string(l) + \"]\", rg.getLight(l)->getShadowMapSlot());" << std::endl;
+    else if (func == (void*) SET_MATERIAL_MAPS)
+        std::cout << "rg.setMaterialMaps(*rg.getMaterial(m));" << std::endl;
+    else if (func == (void*) SET_GBUFFER_MAPS)
+        std::cout << "for (int t = 0; t < N_GBUFFER_TARGETS; t++)\n" <<
+                     "\trg.getShader()->setUniform(GBUFFER_NAMES[t], rg.getTextureGroup(m)->getSlot(t));" << std::endl;
+    else if (func == (void*) SET_INV_TRANS)
+        std::cout << "rg.getShader()->setUniform(\"invProj\", glm::inverse(rg.getCamProj()));\n" <<
+                     "rg.getShader()->setUniform(\"invView\", glm::inverse(rg.getCamView()));" << std::endl;
     else if (func == (void*) SET_MATERIAL) 
-        std::cout << "const Material* material = rg.getModel(m)->getMaterial();\n" <<
-                     "\tif (material != nullptr) rg.getShader()->setUniform(material);" << std::endl;
+        std::cout << "rg.getShader()->setUniform(\"materialIndex\", rg.getMaterialIndex(m));" << std::endl;
     else if (func == (void*) SET_TRANS) 
-        std::cout << "rg.getShader()->setUniform(\"clipMat\", rg.getCamProj() * rg.getCamView());" << std::endl;
+        std::cout << "rg.getShader()->setUniform(\"clipMat\", rg.getCamClip());" << std::endl;
     else if (func == (void*) SET_TRANS_L)
-        std::cout << "glm::mat4 mv = rg.getCamView() * rg.getModel(m)->getModel();\n" <<
-                     "\trg.getShader()->setUniform(\"clipMat\", rg.getCamProj() * mv);\n" <<
-                     "\trg.getShader()->setUniform(\"viewMat\", mv);\n" <<
-                     "\trg.getShader()->setUniform(\"normalMat\", glm::mat3(transpose(inverse(mv))));" << std::endl;
-    else if (func == (void*) SET_TRANS_S)
-        std::cout << "for (int l = 0; l < MAX_LIGHTS; l++)\n" <<
-                     "\t\trg.getShader()->setUniform(\"lightMat[\" + std::to_string(l) + \"]\"," << 
-                     "rg.getLightView(l) * rg.getModel(m)->getModel());" << std::endl;
+        std::cout << "rg.getShader()->setUniform(\"modelMat\", rg.getModelMat(m));\n" <<
+                     "\trg.getShader()->setUniform(\"normalMat\", rg.getNormalMat(m));" << std::endl;
     else if (func == (void*) SET_TRANS_SM)
-        std::cout << "rg.getShader()->setUniform(\"clipMat\"," << 
-                     "rg.getLight()->getLightTransform() * rg.getModel(m)->getModel());" << std::endl;
-    else if (func == (void*) SET_TRANS_SKYBOX)
-        std::cout << "rg.getShader()->setUniform(\"clipMat\", rg.getCamProj() * glm::mat4(glm::mat3(rg.getCamView())));" << std::endl;
-    else if (func == (void*) SET_VALUE) std::cout << "rg.getShader()->setUniform(\"value\", rg.getModel(m)->getColor());" << std::endl;
+        std::cout << "rg.getShader()->setUniform(\"clipMat\", rg.getTransform(m));" << std::endl;
+    else if (func == (void*) SET_TRANS_D) std::cout << "rg.getShader()->setUniform(\"modelMat\", rg.getModelMat(m));" << std::endl;
+    else if (func == (void*) SET_VALUE) std::cout << "rg.getShader()->setUniform(\"value\", rg.getColor(m));" << std::endl;
     else if (func == (void*) SET_VALUE_T) 
-        std::cout << "rg.getShader()->setUniform(\"value\", rg.getModel(m)->getTextureGroup()->getSlot());" << std::endl;
+        std::cout << "rg.getShader()->setUniform(\"value\", rg.getTextureGroup(m)->getSlot());" << std::endl;
     else if (func == (void*) RENDER_MODEL)
-        std::cout << "if (rg.getModel(m)->getVertexArray()->getIndexCount() > 0)\n" << 
-                     "\t\tr_DrawIndices(*(rg.getModel(m)->getVertexArray()), *(rg.getShader()), rg.getModel(m)->getTextureGroup());\n" <<                     
-                     "\telse r_DrawVertices(*(rg.getModel(m)->getVertexArray()), *(rg.getShader()), rg.getModel(m)->getTextureGroup());" << std::endl;
+        std::cout << "if (rg.getMesh(m).getIndexCount() > 0) r_DrawIndices(rg.getMesh(m), *(rg.getShader()), rg.getTextureGroup(m));\n" <<
+                     "\telse r_DrawVertices(rg.getMesh(m), *(rg.getShader()), rg.getTextureGroup(m));" << std::endl;
+    else if (func == (void*) RENDER_DEPTH)
+        std::cout << "if (rg.getMesh(m).getIndexCount() > 0) r_DrawIndices(rg.getMesh(m), *(rg.getShader()));\n" <<
+                     "\telse r_DrawVertices(rg.getMesh(m), *(rg.getShader()));" << std::endl;
 }
 
 
@@ -165,40 +454,76 @@ void BIND_SHADER(RenderGroup& rg) { rg.getShader()->use(); }
 
 void SET_DEPTH_TEST_LE(RenderGroup& rg) { r_SetDepthTest(D_LEQUAL); }
 void SET_DEPTH_TEST_L(RenderGroup& rg) { r_SetDepthTest(D_LESS); }
+void SET_DEPTH_TEST_EQ(RenderGroup& rg) { r_SetDepthTest(D_EQUAL); }
+void DISABLE_COLOR_WRITES(RenderGroup& rg) { r_DisableColorWrites(); }
+void ENABLE_COLOR_WRITES(RenderGroup& rg) { r_EnableColorWrites(); }
+void DISABLE_DEPTH_WRITES(RenderGroup& rg) { r_DisableDepthWrites(); }
+void ENABLE_DEPTH_WRITES(RenderGroup& rg) { r_EnableDepthWrites(); }
 void TOGGLE_CULLING(RenderGroup& rg) { r_ToggleFaceCulling(); }
 
 void CALC_TRANS_V(RenderGroup& rg) { rg.setCamView(rg.getCamera()->getView()); }
-void CALC_TRANS_VP(RenderGroup& rg) { rg.setCamView(rg.getCamera()->getView()); rg.setCamProj(rg.getCamera()->getProj()); }
-void CALC_TRANS_S(RenderGroup& rg, int l)
-    { rg.setLightView((l < rg.nLights()) ? rg.getLight(l)->getLightTransform() : glm::mat4(1.0f), l); }
+void CALC_TRANS_VP(RenderGroup& rg) {
+    rg.setCamView(rg.getCamera()->getView());
+    rg.setCamProj(rg.getCamera()->getProj());
+    rg.setCamClip(rg.getCamProj() * rg.getCamView());
+}
+void CALC_TRANS_SM(RenderGroup& rg, int m) { rg.setTransform(m, rg.getLight()->getLightTransform() * rg.getModelMat(m)); }
+
+void CULL_CAMERA(RenderGroup& rg) { rg.cull(Frustum(rg.getCamera()->getProj() * rg.getCamera()->getView())); }
+void CULL_LIGHT(RenderGroup& rg) { rg.cull(Frustum(rg.getLight()->getLightTransform())); }
 
-void SET_LIGHT(RenderGroup& rg, int l) 
-    { rg.getShader()->setUniform("lightList[" + std::to_string(l) + "]", (l < rg.nLights()) ? *(rg.getLight(l)) : NULL_LIGHT, rg.getCamView()); }
-void SET_MATERIAL(RenderGroup&rg, int m) { 
-    const std::shared_ptr<Material> material = rg.getModel(m)->getMaterial();
-    if (material != nullptr) rg.getShader()->setUniform(material); 
+void CULL_OCCLUDED(RenderGroup& rg) { rg.cullOccluded(); }
+void TEST_OCCLUDED(RenderGroup& rg) { rg.testOccluded(); }
+void BEGIN_OCCLUSION_QUERY(RenderGroup& rg, int m) { rg.beginOcclusionQuery(m); }
+void END_OCCLUSION_QUERY(RenderGroup& rg, int m) { rg.endOcclusionQuery(m); }
+
+void SET_LIGHT_GRID(RenderGroup& rg) {
+    // the light grid's texture buffers are always bound to the same slots (see LightGrid)
+    rg.getShader()->setUniform("lightData", LIGHT_DATA_SLOT);
+    rg.getShader()->setUniform("lightGrid", LIGHT_GRID_SLOT);
+    rg.getShader()->setUniform("lightIndices", LIGHT_INDEX_SLOT);
+}
+void SET_SHADOW_MAPS(RenderGroup& rg) {
+    // shadow maps cannot be stored in buffers, so each shadow casting light's map is set as a sampler uniform
+    for (int l = 0; l < rg.nLights() && l < MAX_SHADOW_MAPS; l++) if (rg.getLight(l) != nullptr)
+        rg.getShader()->setUniform("shadowMap[" + std::to_string(l) + "]", rg.getLight(l)->getShadowMapSlot());
+}
+void SET_MATERIAL_MAPS(RenderGroup& rg, int m) {
+    // samplers can't be read from the material table, so they are set from the slots the material gives each of its maps
+    if (rg.getMaterial(m) != nullptr) rg.setMaterialMaps(*rg.getMaterial(m));
+}
+void SET_GBUFFER_MAPS(RenderGroup& rg, int m) {
+    // the pane's texture group holds the G-buffer targets in gbuffer_targets order
+    for (int t = 0; t < N_GBUFFER_TARGETS; t++) rg.getShader()->setUniform(GBUFFER_NAMES[t], rg.getTextureGroup(m)->getSlot(t));
 }
-void SET_TRANS(RenderGroup& rg, int m) { rg.getShader()->setUniform("clipMat", rg.getCamProj() * rg.getCamView()); }
+void SET_INV_TRANS(RenderGroup& rg) {
+    // the deferred lighting pass goes back from depth to view space, and from view space to world space for shadows
+    rg.getShader()->setUniform("invProj", glm::inverse(rg.getCamProj()));
+    rg.getShader()->setUniform("invView", glm::inverse(rg.getCamView()));
+}
+void SET_MATERIAL(RenderGroup& rg, int m) {
+    // material values are stored in the scene's material table, so only the index changes between draws
+    rg.getShader()->setUniform("materialIndex", rg.getMaterialIndex(m));
+}
+void SET_TRANS(RenderGroup& rg, int m) { rg.getShader()->setUniform("clipMat", rg.getCamClip()); }
 void SET_TRANS_L(RenderGroup& rg, int m) {
-    glm::mat4 mv = rg.getCamView() * rg.getModel(m)->getModel();
-    rg.getShader()->setUniform("clipMat", rg.getCamProj() * mv);                 // clipMat goes from mesh to clip space
-    rg.getShader()->setUniform("viewMat", mv);                                   // viewMat goes from mesh to view space (for lighting)
-    rg.getShader()->setUniform("normalMat", glm::mat3(transpose(inverse(mv))));  // normalMat is used to transform normals (for lighting)
-}
-void SET_TRANS_S(RenderGroup& rg, int m) {
-    // for each light, get the transformation from model to that light's clip space and send it to the shader
-    for (int l = 0; l < MAX_LIGHTS; l++)
-        rg.getShader()->setUniform("lightMat[" + std::to_string(l) + "]", rg.getLightView(l) * rg.getModel(m)->getModel());
-}
-void SET_TRANS_SM(RenderGroup& rg, int m) 
-    { rg.getShader()->setUniform("clipMat", rg.getLight()->getLightTransform() * rg.getModel(m)->getModel()); }
-void SET_TRANS_SKYBOX(RenderGroup& rg, int m) 
-    { rg.getShader()->setUniform("clipMat", rg.getCamProj() * glm::mat4(glm::mat3(rg.getCamView()))); }
-void SET_VALUE(RenderGroup& rg, int m) { rg.getShader()->setUniform("value", rg.getModel(m)->getColor()); }
-void SET_VALUE_T(RenderGroup& rg, int m) { rg.getShader()->setUniform("value", rg.getModel(m)->getTextureGroup()->getSlot()); }
+    // view and projection come from the "Camera" uniform block, so only the mesh to world transformations are needed
+    rg.getShader()->setUniform("modelMat", rg.getModelMat(m));       // modelMat goes from mesh to world space
+    rg.getShader()->setUniform("normalMat", rg.getNormalMat(m));     // normalMat is used to transform normals (for lighting)
+}
+// the light space transform of each model is computed while the frame is prepared (see CALC_TRANS_SM)
+void SET_TRANS_SM(RenderGroup& rg, int m) { rg.getShader()->setUniform("clipMat", rg.getTransform(m)); }
+// the pre-pass reads view and projection from the "Camera" block too, so that its positions match the lighting pass exactly
+void SET_TRANS_D(RenderGroup& rg, int m) { rg.getShader()->setUniform("modelMat", rg.getModelMat(m)); }
+void SET_VALUE(RenderGroup& rg, int m) { rg.getShader()->setUniform("value", rg.getColor(m)); }
+void SET_VALUE_T(RenderGroup& rg, int m) { rg.getShader()->setUniform("value", rg.getTextureGroup(m)->getSlot()); }
 
 void RENDER_MODEL(RenderGroup& rg, int m) {
-    if (rg.getModel(m)->getVertexArray()->getIndexCount() > 0) 
-        r_DrawIndices(*(rg.getModel(m)->getVertexArray()), *(rg.getShader()), rg.getModel(m)->getTextureGroup());
-    else r_DrawVertices(*(rg.getModel(m)->getVertexArray()), *(rg.getShader()), rg.getModel(m)->getTextureGroup());
+    if (rg.getMesh(m).getIndexCount() > 0) r_DrawIndices(rg.getMesh(m), *(rg.getShader()), rg.getTextureGroup(m));
+    else r_DrawVertices(rg.getMesh(m), *(rg.getShader()), rg.getTextureGroup(m));
+}
+void RENDER_DEPTH(RenderGroup& rg, int m) {
+    // no textures are sampled when only depth is written
+    if (rg.getMesh(m).getIndexCount() > 0) r_DrawIndices(rg.getMesh(m), *(rg.getShader()));
+    else r_DrawVertices(rg.getMesh(m), *(rg.getShader()));
 }
\ No newline at end of file
@@ -11,13 +11,13 @@ void r_DrawVertices(const VertexArray &vao, const Shader &shader, const std::sha
     // instruct openGL to draw vertices as triangles
     glDrawArrays(GL_TRIANGLES, 0, vao.getVertexCount());
 }
-void r_DrawVertices(const VertexArray &vao, const Shader &shader, const std::shared_ptr<const TextureGroup> textureGroup) {
+void r_DrawVertices(const VertexArray &vao, const Shader &shader, const std::shared_ptr<const TextureGroup>& textureGroup) {
     if (textureGroup != nullptr) textureGroup->bind();
     shader.use();
     vao.bind();
     glDrawArrays(GL_TRIANGLES, 0, vao.getVertexCount());
 }
-void r_DrawVertices(const VertexArray &vao, const Shader &shader, std::vector<std::shared_ptr<const TextureGroup>> textureGroups) {
+void r_DrawVertices(const VertexArray &vao, const Shader &shader, const std::vector<std::shared_ptr<const TextureGroup>>& textureGroups) {
     for (int i = 0; i < textureGroups.size(); i++) if (textureGroups[i] != nullptr) textureGroups[i]->bind();
     shader.use();
     vao.bind();
@@ -32,13 +32,13 @@ void r_DrawIndices(const VertexArray &vao, const Shader &shader, const std::shar
     // instruct openGL to read off index array to access vertices (still as triangles) rather than accessing vertices directly
     glDrawElements(GL_TRIANGLES, vao.getIndexCount(), GL_UNSIGNED_INT, 0);
 }
-void r_DrawIndices(const VertexArray &vao, const Shader &shader, const std::shared_ptr<const TextureGroup> textureGroup) {
+void r_DrawIndices(const VertexArray &vao, const Shader &shader, const std::shared_ptr<const TextureGroup>& textureGroup) {
     if (textureGroup != nullptr) textureGroup->bind();
     shader.use();
     vao.bind();
     glDrawElements(GL_TRIANGLES, vao.getIndexCount(), GL_UNSIGNED_INT, 0);
 }
-void r_DrawIndices(const VertexArray &vao, const Shader &shader, std::vector<std::shared_ptr<const TextureGroup>> textureGroups) {
+void r_DrawIndices(const VertexArray &vao, const Shader &shader, const std::vector<std::shared_ptr<const TextureGroup>>& textureGroups) {
     for (int i = 0; i < textureGroups.size(); i++) if (textureGroups[i] != nullptr) textureGroups[i]->bind();
     shader.use();
     vao.bind();
@@ -50,6 +50,11 @@ void r_EnableDepthBuffer() { glEnable(GL_DEPTH_TEST); }
 void r_DisableDepthBuffer() { glDisable(GL_DEPTH_TEST); }
 void r_SetDepthTest(unsigned int depthTest) { glDepthFunc(depthTest); }
 
+void r_EnableColorWrites() { glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE); }
+void r_DisableColorWrites() { glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE); }
+void r_EnableDepthWrites() { glDepthMask(GL_TRUE); }
+void r_DisableDepthWrites() { glDepthMask(GL_FALSE); }
+
 void r_EnableMultisample() { glEnable(GL_MULTISAMPLE); }
 void r_DisableMultisample() { glDisable(GL_MULTISAMPLE); }
 
@@ -68,6 +73,7 @@ void r_DisableFaceCulling() {
     faceCulling = false;
 }
 void r_ToggleFaceCulling() { (faceCulling) ? r_DisableFaceCulling() : r_EnableFaceCulling(); }
+bool r_IsFaceCullingEnabled() { return faceCulling; }
 void r_CullFront() { glCullFace(GL_FRONT); }
 void r_CullBack() { glCullFace(GL_BACK); }
 
@@ -9,22 +9,18 @@ Scene::Scene(std::shared_ptr<Camera> camera, const std::string& file_name) : cam
 
 const std::shared_ptr<RenderGroup> Scene::addRenderGroup(unsigned int index, std::shared_ptr<Shader> shader) {
     std::shared_ptr<RenderGroup> renderGroup = std::make_shared<RenderGroup>(shader);
-    if (index == -1) {
-        renderGroup_lookup.emplace(renderGroup, renderGroups.size());
-        renderGroups.push_back(renderGroup);
-    }
-    else {
-        renderGroups.insert(renderGroups.begin() + index, renderGroup);
-        for (int rg = index; rg < renderGroups.size(); rg++) renderGroup_lookup[renderGroups[rg]] = rg;
-    }
+    if (index == -1) renderGroups.push_back(renderGroup);
+    else renderGroups.insert(renderGroups.begin() + index, renderGroup);
     return renderGroup;
 }
 
 const std::shared_ptr<Shader> Scene::addShader(std::shared_ptr<Shader> shader) {
-    for (int i = 0; i < shaders.size(); i++) if (shaders[i].get() == shader.get() || shaders[i] == shader) return shaders[i]; 
+    if (!shaders.find(shader.get()).isNull()) return shader;
+    // a shader with the same parameters is reused instead of compiling another program
+    auto key = shader_keys.find(shader->getKey());
+    if (key != shader_keys.end()) return shaders[key->second.index];
     shader->load();
-    shader_lookup.emplace(shader, shaders.size());
-    shaders.push_back(shader); 
+    shader_keys.emplace(shader->getKey(), shaders.add(shader));
     return shader; 
 }
 const std::shared_ptr<Shader> Scene::addShader(const unsigned int RENDERING_STYLE, const unsigned int OUTPUT_BUFFER,
@@ -36,17 +32,57 @@ const std::shared_ptr<Shader> Scene::addShader(const unsigned int RENDERING_STYL
     return addShader(shader);
 }
 
+// 3D models are placed by the transform hierarchy and culled by the scene
+static bool is3D(const Model& model) { return model.getType() == R_BASIC_3D || model.getType() == R_LIGHTING_3D; }
+
 const std::shared_ptr<Model> Scene::addModel(std::shared_ptr<Model> model, bool add_all) {
-    for (int i = 0; i < models.size(); i++) if (models[i].get() == model.get() || models[i] == model) return models[i];
+    if (!models.find(model.get()).isNull()) return model;
+    // the model switches to the scene's copy of its mesh and material if the scene already had equal ones
     if (add_all) {
-        if (model->vertexArray != nullptr) addVertexArray(model->vertexArray);
-        if (model->material != nullptr) addMaterial(model->material);
+        if (model->vertexArray != nullptr) model->vertexArray = addVertexArray(model->vertexArray);
+        if (model->material != nullptr) model->material = addMaterial(model->material);
         if (model->textureGroup != nullptr) addTextureGroup(model->textureGroup);
     }
-    model_lookup.emplace(model, models.size());
-    models.push_back(model); 
+    // once the scene is loaded, the model is added between frames (see applyChanges())
+    if (loaded) {
+        changes.push_back({ C_ADD_MODEL, model, nullptr });
+        return model;
+    }
+    models.add(model);
+    modelParents.resize(models.size(), -1);
     return model; 
 }
+void Scene::addModels(std::span<const std::shared_ptr<Model>> models) {
+    this->models.reserve(models.size());
+    modelParents.reserve(modelParents.size() + models.size());
+    for (const std::shared_ptr<Model>& model : models) addModel(model, true);
+}
+void Scene::attachModel(std::shared_ptr<Model> model, std::shared_ptr<Model> parent) {
+    if (loaded) {
+        std::cout << "ERROR::SCENE::INVALID_ATTACHMENT: Models can only be attached before the scene is loaded." << std::endl;
+        return;
+    }
+    if (!is3D(*model) || !is3D(*parent)) {
+        std::cout << "ERROR::SCENE::INVALID_ATTACHMENT: Only 3D models can be attached to each other." << std::endl;
+        return;
+    }
+    addModel(model);
+    addModel(parent);
+    int m = models.find(model.get()).index, p = models.find(parent.get()).index;
+    // a model can't be attached below itself
+    for (int a = p; a != -1; a = modelParents[a]) if (a == m) {
+        std::cout << "ERROR::SCENE::INVALID_ATTACHMENT: Attaching the model would create a cycle." << std::endl;
+        return;
+    }
+    modelParents[m] = p;
+}
+Scene::~Scene() {
+    // models can outlive the scene, so they must stop referring to its transform hierarchy (the model store is kept alive by the models)
+    for (const std::shared_ptr<Model>& model : models) if (model != nullptr) {
+        model->hierarchy = nullptr;
+        model->node = -1;
+    }
+}
 const std::shared_ptr<Model> Scene::addPane(std::shared_ptr<VertexArray> vertexArray, std::shared_ptr<Texture> texture) {
     std::shared_ptr<Model> model = std::make_shared<Model>(vertexArray, texture);
     return addModel(model, true);
@@ -107,10 +143,15 @@ const std::shared_ptr<Model> Scene::addTexturedModel(const unsigned int vaID, co
 }
 
 const std::shared_ptr<VertexArray> Scene::addVertexArray(std::shared_ptr<VertexArray> vertexArray) {
-    for (int i = 0; i < vertexArrays.size(); i++) if (vertexArrays[i].get() == vertexArray.get() || vertexArrays[i] == vertexArray)
-        return vertexArrays[i];
-    vertexArray_lookup.emplace(vertexArray, vertexArrays.size());
-    vertexArrays.push_back(vertexArray); 
+    if (!vertexArrays.find(vertexArray.get()).isNull()) return vertexArray;
+    // meshes made from the same parameters (e.g. the same file) are only kept once
+    if (vertexArray->isComparable()) {
+        std::size_t hash = vertexArray->hash();
+        auto range = vertexArray_keys.equal_range(hash);
+        for (auto key = range.first; key != range.second; key++)
+            if (getVertexArray(key->second) == *vertexArray) return vertexArrays[key->second.index];
+        vertexArray_keys.emplace(hash, vertexArrays.add(vertexArray));
+    } else vertexArrays.add(vertexArray);
     return vertexArray;
 }
 const std::shared_ptr<VertexArray> Scene::addPane(const float cornerX, const float cornerY, const float dimX, const float dimY) {
@@ -136,11 +177,14 @@ const std::shared_ptr<VertexArray> Scene::addVertexArray(const std::string& file
 }
 
 const std::shared_ptr<Light> Scene::addLight(std::shared_ptr<Light> light) { 
-    for (int i = 0; i < lights.size(); i++) if (lights[i].get() == light.get() || lights[i] == light) return lights[i];
-    light_lookup.emplace(light, lights.size());
-    lights.push_back(light); 
+    if (loaded) changes.push_back({ C_ADD_LIGHT, nullptr, light });
+    else lights.add(light);
     return light; 
 }
+void Scene::addLights(std::span<const std::shared_ptr<Light>> lights) {
+    this->lights.reserve(lights.size());
+    for (const std::shared_ptr<Light>& light : lights) addLight(light);
+}
 const std::shared_ptr<Light> Scene::addDirLight(const glm::vec3 dir, 
                                                 const glm::vec3 ambient, const glm::vec3 diffuse, const glm::vec3 specular) { 
     std::shared_ptr<Light> light = std::make_shared<Light>(dir, ambient, diffuse, specular);
@@ -163,9 +207,11 @@ const std::shared_ptr<Light> Scene::addSpotLight(const glm::vec3 pos, const glm:
 }
 
 const std::shared_ptr<Material> Scene::addMaterial(std::shared_ptr<Material> material) {
-    for (int i = 0; i < materials.size(); i++) if (materials[i].get() == material.get() || materials[i] == material) return materials[i];
-    material_lookup.emplace(material, materials.size());
-    materials.push_back(material); 
+    if (!materials.find(material.get()).isNull()) return material;
+    std::size_t hash = material->hash();
+    auto range = material_keys.equal_range(hash);
+    for (auto key = range.first; key != range.second; key++) if (getMaterial(key->second) == *material) return materials[key->second.index];
+    material_keys.emplace(hash, materials.add(material));
     return material;
 }
 const std::shared_ptr<Material> Scene::addBasicMat(const glm::vec3 ambient, const glm::vec3 diffuse, const glm::vec3 specular, const float shininess) { 
@@ -209,11 +255,28 @@ const std::shared_ptr<Material> Scene::addDSEMap(const unsigned int texGroupID,
     return addMaterial(material);
 }
 
+// erase an element's content key (the key must be erased before the element is removed from its pool)
+template <typename Key, typename T>
+void eraseKey(std::unordered_multimap<Key, Handle<T>>& keys, const Key key, const Handle<T> handle) {
+    auto range = keys.equal_range(key);
+    for (auto entry = range.first; entry != range.second; entry++) if (entry->second == handle) { keys.erase(entry); return; }
+}
+void Scene::removeShader(const Handle<Shader> handle) {
+    if (shaders.isValid(handle)) shader_keys.erase(getShader(handle).getKey());
+    shaders.remove(handle);
+}
+void Scene::removeVertexArray(const Handle<VertexArray> handle) {
+    if (vertexArrays.isValid(handle) && getVertexArray(handle).isComparable())
+        eraseKey(vertexArray_keys, getVertexArray(handle).hash(), handle);
+    vertexArrays.remove(handle);
+}
+void Scene::removeMaterial(const Handle<Material> handle) {
+    if (materials.isValid(handle)) eraseKey(material_keys, getMaterial(handle).hash(), handle);
+    materials.remove(handle);
+}
+
 const std::shared_ptr<TextureGroup> Scene::addTextureGroup(std::shared_ptr<TextureGroup> textureGroup) { 
-    for (int i = 0; i < textureGroups.size(); i++) if (textureGroups[i].get() == textureGroup.get() || textureGroups[i] == textureGroup)
-        return textureGroups[i];
-    textureGroup_lookup.emplace(textureGroup, textureGroups.size());
-    textureGroups.push_back(textureGroup); 
+    textureGroups.add(textureGroup);
     return textureGroup; 
 }
 // create texture group in the scene
@@ -227,12 +290,19 @@ const std::shared_ptr<TextureGroup> Scene::addTextureGroup(const std::shared_ptr
     return addTextureGroup(textureGroup);
 }
 
-void Scene::load() {
-    bool createShadowMaps = false;
+// whether shaders compiled with a lighting style can shade a type of light
+static bool shadesLightType(const unsigned int style, const unsigned int type) {
+    switch(type) {
+    case L_DIR: return style == L_DIR || style == L_DIR_POINT || style == L_DIR_SPOT || style == L_ALL_ENABLED;
+    case L_POINT: return style == L_POINT || style == L_DIR_POINT || style == L_POINT_SPOT || style == L_ALL_ENABLED;
+    case L_SPOT: return style == L_SPOT || style == L_DIR_SPOT || style == L_POINT_SPOT || style == L_ALL_ENABLED;
+    }
+    return false;
+}
 
-    unsigned int l_style;
+void Scene::load() {
     bool dir = false, point = false, spot = false;
-    for (int l = 0; l < lights.size(); l++)
+    for (int l = 0; l < lights.size(); l++) if (lights[l] != nullptr)
         switch(getLight(l).type) {
         case L_DIR: { dir = true; } break;
         case L_POINT: { point = true; } break;
@@ -240,15 +310,32 @@ void Scene::load() {
         }
     if (dir) {
         if (point) {
-            if (spot) l_style = L_ALL_ENABLED;
-            else l_style = L_DIR_POINT;
-        } else if (spot) l_style = L_DIR_SPOT;
-        else l_style = L_DIR;
+            if (spot) lightingStyle = L_ALL_ENABLED;
+            else lightingStyle = L_DIR_POINT;
+        } else if (spot) lightingStyle = L_DIR_SPOT;
+        else lightingStyle = L_DIR;
     } else if (point) {
-        if (spot) l_style = L_POINT_SPOT;
-        else l_style = L_POINT;
-    } else if (spot) l_style = L_SPOT;
-    else l_style = L_DISABLED;
+        if (spot) lightingStyle = L_POINT_SPOT;
+        else lightingStyle = L_POINT;
+    } else if (spot) lightingStyle = L_SPOT;
+    else lightingStyle = L_DISABLED;
+    // uber shaders branch on each light's type, so lights of any type can be added after the scene is loaded
+    if (uberShaders) lightingStyle = L_ALL_ENABLED;
+
+    // create the shared uniform buffers and the light grid (which covers the frame that lit models are rendered to)
+    cameraBuffer = std::make_unique<UniformBuffer>(UB_CAMERA, sizeof(CameraBlock));
+    lightBuffer = std::make_unique<UniformBuffer>(UB_LIGHTS, sizeof(LightGridBlock));
+    shadowBuffer = std::make_unique<UniformBuffer>(UB_SHADOWS, MAX_SHADOW_MAPS * sizeof(glm::mat4));
+    lightGrid = std::make_unique<LightGrid>(viewportWidth / pixelWidth, viewportHeight / pixelWidth);
+    // textures must be packed before shaders are chosen, since packed models need shaders that sample texture arrays
+    if (textureArraysEnabled) packTextures();
+    loadMaterials();
+
+    /* The scene's models are added to the store before any group is built, so that everything the scene keeps per model (group entries,
+     * tree proxies, hierarchy nodes) is indexed by handle. Models that only groups know of are added after the scene's models.
+     */
+    modelStore = std::make_shared<ModelStore>();
+    for (const std::shared_ptr<Model>& model : models) if (model != nullptr) model->addToStore(modelStore);
 
     std::unique_ptr<FrameBuffer> _frameBuffer = nullptr;
     if (aa_enabled)
@@ -261,53 +348,51 @@ void Scene::load() {
                                                      3, true);
     std::unique_ptr<Frame> _frame = (_frameBuffer == nullptr) ? std::make_unique<Frame>() : 
                                                                 std::make_unique<Pane>(std::move(_frameBuffer));
+    sceneFrame = _frame.get();
 
-    for (int m = 0; m < models.size(); m++) {
-        std::shared_ptr<Model> model = models[m];
-
-        unsigned int r_style = model->getType();
-        std::shared_ptr<Shader> shader = addShader(r_style, B_COLOR, model->getMaterialType(), 
-                                                   (r_style == R_LIGHTING_3D) ? l_style : L_DISABLED, 
-                                                   (r_style == R_LIGHTING_3D) ? shadowStyle : S_DISABLED, 
-                                                   model->getTextureType(), P_DISABLED);
-
-        std::shared_ptr<RenderGroup> renderGroup = nullptr;
-        for (int rg = 0; rg < renderGroups.size(); rg++) if (renderGroups[rg]->getShader() == shader) 
-            { renderGroup = renderGroups[rg]; break; }
-        if (renderGroup == nullptr) {
-            renderGroup = addRenderGroup(shader);
-            if (shader->getRenderingStyle() != R_BASIC_2D) {
-                addCameraToGroup(renderGroup, camera);
-                if (shader->getRenderingStyle() == R_LIGHTING_3D) {
-                    for (int l = 0; l < lights.size(); l++) addLightToGroup(renderGroup, lights[l]);
-                    if (shader->getShadowStyle() == S_SHADOW_MAPPING) createShadowMaps = true;
-                }
-            }
-            _frame->addRenderGroup(renderGroup);
-        }
-        addModelToGroup(renderGroup, model);
+    if (occlusionCulling) {
+        occlusionShader = addShader(R_BASIC_3D, B_COLOR, M_DISABLED, L_DISABLED, S_DISABLED, T_DISABLED, P_DISABLED);
+        occlusionBox = std::make_shared<VertexArray>();
+        occlusionBox->makeBox();
     }
 
-    if (lights.size() > 0 && createShadowMaps) {
-        std::shared_ptr<Shader> sm_shader = addShader(R_BASIC_3D, B_DEPTH, M_DISABLED, L_DISABLED, S_DISABLED, T_DISABLED, P_SHADOW_MAP);
+    model_groups.assign(modelStore->size(), {});
+    bool lit = std::any_of(models.begin(), models.end(), [](auto& model) { return model != nullptr && model->getType() == R_LIGHTING_3D; });
 
-        for (int l = 0; l < lights.size(); l++) {
-            std::shared_ptr<Light> light = lights[l];
-            int dim = (viewportHeight + viewportWidth) / pixelWidth;
-            std::unique_ptr<FrameBuffer> sm_frameBuffer = std::make_unique<FrameBuffer>(FB_DEPTH_MAP, FRAME_BUFFER_RW, dim, dim, 1, true);
-            std::unique_ptr<Frame> sm_frame = std::make_unique<Frame>(std::move(sm_frameBuffer));
+    /* With deferred shading, lit models are drawn into the G-buffer instead of the scene frame. The G-buffer is a pane of the scene frame,
+     * drawn by the lighting group (which is the first group in the frame, so that forward groups drawn afterwards are depth tested against
+     * the G-buffer's depth). A depth pre-pass is not needed, since the lighting pass already shades each pixel once.
+     */
+    if (deferredShading && lit) {
+        std::unique_ptr<FrameBuffer> gb_frameBuffer = std::make_unique<FrameBuffer>(FB_GBUFFER, FRAME_BUFFER_RW, 
+                                                                                    viewportWidth / pixelWidth, viewportHeight / pixelWidth, 
+                                                                                    4, true);
+        std::unique_ptr<Pane> gb_pane = std::make_unique<Pane>(std::move(gb_frameBuffer));
+        gbufferFrame = gb_pane.get();
 
-            std::shared_ptr<RenderGroup> sm_renderGroup = addRenderGroup(l, sm_shader);
-            addLightToGroup(sm_renderGroup, light);
-            addCameraToGroup(sm_renderGroup, camera);
-            for (int m = 0; m < models.size(); m++) if (getModel(m).getType() == R_BASIC_3D || getModel(m).getType() == R_LIGHTING_3D)
-                addModelToGroup(sm_renderGroup, m);
-            sm_frame->addRenderGroup(sm_renderGroup);
+        std::shared_ptr<Shader> dl_shader = addShader(R_DEFERRED_LIGHTING, B_COLOR, M_DISABLED, lightingStyle, shadowStyle, T_BASIC_2D, 
+                                                      P_DISABLED);
+        std::shared_ptr<RenderGroup> dl_renderGroup = addRenderGroup(dl_shader);
+        addCameraToGroup(dl_renderGroup, camera);
+        for (int l = 0; l < lights.size(); l++) dl_renderGroup->setLight(l, lights[l]);
+        litGroups.push_back(dl_renderGroup.get());
+        if (shadowStyle == S_SHADOW_MAPPING) shadowsEnabled = true;
+        _frame->addPane(dl_renderGroup, std::move(gb_pane));
+    }
 
-            light->setShadowMapSlot(_frame->addFrame(std::move(sm_frame)));
-        }
+    // the pre-pass group is the first group in the frame, so that depth is complete before any lit model is shaded
+    if (depthPrepass && lit && gbufferFrame == nullptr) {
+        std::shared_ptr<Shader> dp_shader = addShader(R_LIGHTING_3D, B_DEPTH, M_DISABLED, L_DISABLED, S_DISABLED, T_DISABLED, P_DISABLED);
+        depthPrepassGroup = addRenderGroup(dp_shader);
+        depthPrepassGroup->enableSceneCulling();
+        culledGroups.push_back(depthPrepassGroup.get());
+        addCameraToGroup(depthPrepassGroup, camera);
+        _frame->addRenderGroup(depthPrepassGroup);
     }
 
+    for (const std::shared_ptr<Model>& model : models) if (model != nullptr) addModelToGroups(model);
+    updateShadowPasses();
+
     if (!_frame->isDefault()) {
         std::unique_ptr<Frame> p_frame = std::make_unique<Frame>();
         DEPTH_TESTING_ENABLED = false;
@@ -325,13 +410,463 @@ void Scene::load() {
         frame = std::move(_frame);
     }
 
+    for (int rg = 0; rg < renderGroups.size(); rg++) renderGroups[rg]->setModelStore(modelStore);
+
+    // 3D models are added to the transform hierarchy breadth first from the roots, so that every parent is added before its children
+    transforms = std::make_unique<TransformHierarchy>();
+    std::vector<std::vector<int>> children(models.size());
+    std::vector<int> order;
+    for (int m = 0; m < models.size(); m++) if (models[m] != nullptr && is3D(getModel(m))) {
+        if (modelParents[m] == -1) order.push_back(m);
+        else children[modelParents[m]].push_back(m);
+    }
+    for (int i = 0; i < order.size(); i++) for (int c : children[order[i]]) order.push_back(c);
+    node_handles.clear();
+    for (int m : order) {
+        Model& model = getModel(m);
+        int parentNode = (modelParents[m] == -1) ? -1 : getModel(modelParents[m]).node;
+        model.node = transforms->add(parentNode, model.pos, model.scale, model.aos, model.angle);
+        model.hierarchy = transforms.get();
+        node_handles.push_back(model.getHandle());
+    }
+    updateTransforms();
+
+    // build the model tree in one go, after which it is kept up to date as models move
+    modelTree = std::make_unique<BVH>();
+    modelProxies.assign(model_groups.size(), -1);
+    for (const std::shared_ptr<Model>& model : models) if (model != nullptr) addModelToTree(*model);
+    modelTree->rebuild();
+
     // for each shader group, call the shader's load function
     for (int rg = 0; rg < renderGroups.size(); rg++) { getRenderGroup(rg).load(); }
+    if (frameTiming) timer = std::make_unique<FrameTimer>();
+    loaded = true;
+
+    // the warm up draws read the same per frame data as a real frame, so the first frame is prepared for them (with every texture on the
+    // GPU, so that the warm up doesn't draw with placeholder images)
+    if (warmUpEnabled) {
+        TextureCache::get().finishUploads();
+        prepare();
+        updateUniformBuffers();
+        warmUpTimes.clear();
+        frame->warmUp(warmUpTimes);
+    }
+}
+
+void Scene::addModelToGroups(const std::shared_ptr<Model>& model) {
+    unsigned int handle = model->getHandle();
+    if (model_groups.size() <= handle) model_groups.resize(handle + 1);
+
+    unsigned int r_style = model->getType();
+    bool deferred = r_style == R_LIGHTING_3D && gbufferFrame != nullptr;
+    std::shared_ptr<Shader> shader = addShader(deferred ? R_GBUFFER_3D : r_style, B_COLOR, getMaterialStyle(*model), 
+                                               (r_style == R_LIGHTING_3D && !deferred) ? lightingStyle : L_DISABLED, 
+                                               (r_style == R_LIGHTING_3D && !deferred) ? shadowStyle : S_DISABLED, 
+                                               getTextureStyle(*model), P_DISABLED);
+
+    // models that share a shader share a render group
+    std::shared_ptr<RenderGroup>& renderGroup = shader_groups[shader.get()];
+    if (renderGroup == nullptr) {
+        renderGroup = addRenderGroup(shader);
+        // 3D models are culled by the scene using the model tree
+        if (is3D(*model)) {
+            renderGroup->enableSceneCulling();
+            culledGroups.push_back(renderGroup.get());
+        }
+        if (shader->getRenderingStyle() != R_BASIC_2D) {
+            addCameraToGroup(renderGroup, camera);
+            if (occlusionCulling && shader->getRenderingStyle() != R_SKYBOX) 
+                renderGroup->enableOcclusionCulling(occlusionShader, occlusionBox);
+            if (shader->getRenderingStyle() == R_LIGHTING_3D) {
+                if (depthPrepassGroup != nullptr) renderGroup->enableDepthPrepass();
+                for (int l = 0; l < lights.size(); l++) renderGroup->setLight(l, lights[l]);
+                litGroups.push_back(renderGroup.get());
+                if (shader->getShadowStyle() == S_SHADOW_MAPPING) shadowsEnabled = true;
+            }
+        }
+        if (deferred) gbufferFrame->addRenderGroup(renderGroup);
+        else sceneFrame->addRenderGroup(renderGroup);
+        // a group created after the scene is loaded is loaded right away (nothing else in the scene has to change)
+        if (loaded) {
+            renderGroup->setModelStore(modelStore);
+            renderGroup->load();
+        }
+    }
+    renderGroup->addModel(model);
+    model_groups[handle].push_back({ renderGroup.get(), (int) renderGroup->nModels() - 1, is3D(*model) ? -1 : -2 });
+    if (r_style == R_LIGHTING_3D && depthPrepassGroup != nullptr) {
+        depthPrepassGroup->addModel(model);
+        model_groups[handle].push_back({ depthPrepassGroup.get(), (int) depthPrepassGroup->nModels() - 1, -1 });
+    }
+    if (is3D(*model)) for (int l = 0; l < shadowGroups.size(); l++) if (shadowGroups[l] != nullptr) {
+        shadowGroups[l]->addModel(model);
+        model_groups[handle].push_back({ shadowGroups[l], (int) shadowGroups[l]->nModels() - 1, l });
+    }
+}
+// whether a model is drawn by an uber shader (which samples material maps, so cube mapped models keep their own shader)
+static bool usesUberShader(const Model& model, const bool uberShaders) {
+    return uberShaders && model.getType() == R_LIGHTING_3D && model.getMaterialType() != M_DISABLED && model.getTextureType() != T_CUBE;
+}
+unsigned int Scene::getMaterialStyle(const Model& model) const {
+    return usesUberShader(model, uberShaders) ? M_UBER : model.getMaterialType();
+}
+unsigned int Scene::getTextureStyle(const Model& model) const {
+    // models without textures join the models whose textures are packed into arrays, if there are any, since they never sample a map
+    if (usesUberShader(model, uberShaders) && model.getTextureType() == T_DISABLED) 
+        return (textureArrays.empty()) ? T_BASIC_2D : T_ARRAY_2D;
+    return model.getTextureType();
+}
+void Scene::addModelToTree(const Model& model) {
+    unsigned int handle = model.getHandle();
+    if (modelProxies.size() <= handle) modelProxies.resize(handle + 1, -1);
+    if (!modelStore->getBounds(handle).isEmpty()) modelProxies[handle] = modelTree->insert(modelStore->getBounds(handle), handle);
+    else if (is3D(model)) unboundedModels.push_back(handle);
+    modelStore->clearMoved(handle);
+}
+
+void Scene::updateShadowPasses() {
+    if (!shadowsEnabled) return;
+    bool changed = false;
+    // only the first MAX_SHADOW_MAPS lights cast shadows
+    for (int l = 0; l < lights.size() && l < MAX_SHADOW_MAPS; l++) if (lights[l] != nullptr) {
+        if (l < shadowGroups.size() && shadowGroups[l] != nullptr && shadowGroups[l]->getLight() == lights[l].get()) continue;
+        addShadowPass(l);
+        changed = true;
+    }
+    // lit groups that are already loaded need to be told where the new shadow maps are
+    if (changed && loaded) for (RenderGroup* renderGroup : litGroups) renderGroup->init();
+}
+void Scene::addShadowPass(const unsigned int l) {
+    if (shadowGroups.size() <= l) {
+        shadowGroups.resize(l + 1, nullptr);
+        shadowMapSlots.resize(l + 1, 0);
+    }
+    // a removed light leaves its shadow pass behind, which is taken over by the next light put in the same slot
+    if (shadowGroups[l] == nullptr) {
+        std::shared_ptr<Shader> sm_shader = addShader(R_BASIC_3D, B_DEPTH, M_DISABLED, L_DISABLED, S_DISABLED, T_DISABLED, P_SHADOW_MAP);
+        int dim = (viewportHeight + viewportWidth) / pixelWidth;
+        std::unique_ptr<FrameBuffer> sm_frameBuffer = std::make_unique<FrameBuffer>(FB_DEPTH_MAP, FRAME_BUFFER_RW, dim, dim, 1, true);
+        std::unique_ptr<Frame> sm_frame = std::make_unique<Frame>(std::move(sm_frameBuffer));
+
+        std::shared_ptr<RenderGroup> sm_renderGroup = addRenderGroup(std::min(l, (unsigned int) renderGroups.size()), sm_shader);
+        sm_renderGroup->enableSceneCulling();
+        culledGroups.push_back(sm_renderGroup.get());
+        sm_renderGroup->setLight(0, lights[l]);
+        addCameraToGroup(sm_renderGroup, camera);
+        for (const std::shared_ptr<Model>& model : models) if (model != nullptr && is3D(*model)) {
+            sm_renderGroup->addModel(model);
+            model_groups[model->getHandle()].push_back({ sm_renderGroup.get(), (int) sm_renderGroup->nModels() - 1, (int) l });
+        }
+        if (loaded) {
+            sm_renderGroup->setModelStore(modelStore);
+            sm_renderGroup->load();
+        }
+        sm_frame->addRenderGroup(sm_renderGroup);
+
+        shadowGroups[l] = sm_renderGroup.get();
+        shadowMapSlots[l] = sceneFrame->addFrame(std::move(sm_frame));
+    }
+    shadowGroups[l]->setLight(0, lights[l]);
+    lights[l]->setShadowMapSlot(shadowMapSlots[l]);
+}
+
+void Scene::removeModel(std::shared_ptr<Model> model) {
+    if (loaded) { changes.push_back({ C_REMOVE_MODEL, model, nullptr }); return; }
+    Handle<Model> handle = models.find(model.get());
+    if (handle.isNull()) {
+        std::cout << "ERROR::SCENE::MODEL_NOT_FOUND: The model being removed is not in the scene." << std::endl;
+        return;
+    }
+    // models attached to the removed model become roots
+    for (int& parent : modelParents) if (parent == (int) handle.index) parent = -1;
+    modelParents[handle.index] = -1;
+    models.remove(handle);
+}
+void Scene::removeLight(std::shared_ptr<Light> light) {
+    if (loaded) { changes.push_back({ C_REMOVE_LIGHT, nullptr, light }); return; }
+    Handle<Light> handle = lights.find(light.get());
+    if (handle.isNull()) {
+        std::cout << "ERROR::SCENE::LIGHT_NOT_FOUND: The light being removed is not in the scene." << std::endl;
+        return;
+    }
+    lights.remove(handle);
+}
+
+void Scene::applyChanges() {
+    if (changes.empty()) return;
+    for (const Change& change : changes)
+        switch(change.type) {
+        case C_ADD_MODEL: { loadModel(change.model); } break;
+        case C_REMOVE_MODEL: { unloadModel(change.model); } break;
+        case C_ADD_LIGHT: { loadLight(change.light); } break;
+        case C_REMOVE_LIGHT: { unloadLight(change.light); } break;
+        }
+    changes.clear();
+    // new lights (or the first lit model that casts shadows) may need shadow passes
+    updateShadowPasses();
+}
+void Scene::loadModel(const std::shared_ptr<Model>& model) {
+    if (!models.find(model.get()).isNull()) return;
+    models.add(model);
+    modelParents.resize(models.size(), -1);
+
+    // the model's material may need a new entry in the material table
+    model->materialIndex = getMaterialEntry(*model);
+    model->addToStore(modelStore);
+    addModelToGroups(model);
+
+    // models can only be attached to each other before the scene is loaded, so a model added later is always a root
+    if (is3D(*model)) {
+        model->node = transforms->add(-1, model->pos, model->scale, model->aos, model->angle);
+        model->hierarchy = transforms.get();
+        if (node_handles.size() <= model->node) node_handles.resize(model->node + 1, -1);
+        node_handles[model->node] = model->getHandle();
+    }
+    addModelToTree(*model);
+}
+void Scene::unloadModel(const std::shared_ptr<Model>& model) {
+    Handle<Model> handle = models.find(model.get());
+    if (handle.isNull()) {
+        std::cout << "ERROR::SCENE::MODEL_NOT_FOUND: The model being removed is not in the scene." << std::endl;
+        return;
+    }
+    unsigned int modelHandle = model->getHandle();
+
+    // each group moves its last model into the removed model's place, so the moved model's entry for that group is updated
+    for (const GroupEntry& entry : model_groups[modelHandle]) {
+        RenderGroup* renderGroup = entry.renderGroup;
+        renderGroup->removeModel(entry.index);
+        if (entry.index == renderGroup->nModels()) continue;
+        unsigned int moved = renderGroup->getHandle(entry.index);
+        if (moved < model_groups.size()) 
+            for (GroupEntry& movedEntry : model_groups[moved]) if (movedEntry.renderGroup == renderGroup) movedEntry.index = entry.index;
+    }
+    model_groups[modelHandle].clear();
+
+    if (modelProxies[modelHandle] != -1) modelTree->remove(modelProxies[modelHandle]);
+    modelProxies[modelHandle] = -1;
+    auto unbounded = std::find(unboundedModels.begin(), unboundedModels.end(), (int) modelHandle);
+    if (unbounded != unboundedModels.end()) {
+        *unbounded = unboundedModels.back();
+        unboundedModels.pop_back();
+    }
+
+    // a node with children stays in the hierarchy (so its children keep following it), it just no longer moves a model
+    if (model->hierarchy != nullptr) {
+        transforms->remove(model->node);
+        node_handles[model->node] = -1;
+        model->hierarchy = nullptr;
+        model->node = -1;
+    }
+    model->removeFromStore();
+    modelParents[handle.index] = -1;
+    models.remove(handle);
+}
+void Scene::loadLight(const std::shared_ptr<Light>& light) {
+    if (!lights.find(light.get()).isNull()) return;
+    if (!shadesLightType(lightingStyle, light->type))
+        std::cout << "ERROR::SCENE::UNSUPPORTED_LIGHT: The scene's shaders were compiled without this type of light, it will not be shaded." 
+                  << std::endl;
+    unsigned int l = lights.add(light).index;
+    for (RenderGroup* renderGroup : litGroups) renderGroup->setLight(l, light);
+}
+void Scene::unloadLight(const std::shared_ptr<Light>& light) {
+    Handle<Light> handle = lights.find(light.get());
+    if (handle.isNull()) {
+        std::cout << "ERROR::SCENE::LIGHT_NOT_FOUND: The light being removed is not in the scene." << std::endl;
+        return;
+    }
+    // the slot is left empty, and the light's shadow pass (if it has one) draws nothing until another light takes the slot
+    for (RenderGroup* renderGroup : litGroups) renderGroup->setLight(handle.index, nullptr);
+    if (handle.index < shadowGroups.size() && shadowGroups[handle.index] != nullptr) shadowGroups[handle.index]->setLight(0, nullptr);
+    lights.remove(handle);
 }
 
 void Scene::draw() {
-    for (int l = 0; l < lights.size(); l++) getLight(l).setLightTransform(glm::vec3(0.0f));
+    if (timer != nullptr) timer->begin();
+    applyChanges();
+    // copy the next few decoded textures to the GPU
+    TextureCache::get().upload();
+    prepare();
+    updateUniformBuffers();
     frame->render();
+    if (timer != nullptr) timer->end();
+}
+
+// number of visible models each worker prepares at a time, so that large render groups are spread over every worker
+const unsigned int PREPARE_BATCH_SIZE = 4096;
+
+// number of models whose world transformation is copied from the hierarchy per job
+const unsigned int TRANSFORM_BATCH_SIZE = 1024;
+
+void Scene::updateTransforms() {
+    transforms->update();
+    const std::vector<int>& updated = transforms->getUpdated();
+    JobSystem::get().parallelFor(updated.size(), TRANSFORM_BATCH_SIZE, [&](int i) {
+        int node = updated[i];
+        // nodes whose model was removed stay in the hierarchy while they have children
+        if (node_handles[node] == -1) return;
+        modelStore->setTransform(node_handles[node], transforms->getWorld(node), transforms->getNormal(node));
+    });
+}
+
+void Scene::prepare() {
+    JobSystem& jobs = JobSystem::get();
+
+    updateTransforms();
+
+    // only shadow casting lights need a light space transformation
+    int nShadows = (lights.size() < MAX_SHADOW_MAPS) ? lights.size() : MAX_SHADOW_MAPS;
+    jobs.parallelFor(nShadows, 1, [&](int l) { if (lights[l] != nullptr) getLight(l).setLightTransform(glm::vec3(0.0f)); });
+    cullModels();
+
+    jobs.parallelFor(renderGroups.size(), 1, [&](int rg) { renderGroups[rg]->prepare(); });
+    // per model work is split into batches across all groups, since one group may hold most of the scene's models
+    std::vector<std::pair<RenderGroup*, unsigned int>> batches;
+    for (std::shared_ptr<RenderGroup>& renderGroup : renderGroups)
+        for (unsigned int i = 0; i < renderGroup->nVisible(); i += PREPARE_BATCH_SIZE) batches.push_back({ renderGroup.get(), i });
+    jobs.parallelFor(batches.size(), 1, 
+                     [&](int b) { batches[b].first->prepareModels(batches[b].second, batches[b].second + PREPARE_BATCH_SIZE); });
+    jobs.parallelFor(renderGroups.size(), 1, [&](int rg) { renderGroups[rg]->sortVisible(); });
+}
+
+void Scene::packTextures() {
+    // a texture group can only be packed if every model that uses it is lit, since other shaders don't read layers from the material table
+    std::map<std::shared_ptr<TextureGroup>, bool> packable;
+    for (int m = 0; m < models.size(); m++) if (models[m] != nullptr) {
+        std::shared_ptr<TextureGroup> textureGroup = models[m]->getTextureGroup();
+        if (textureGroup == nullptr) continue;
+        bool lit = models[m]->getType() == R_LIGHTING_3D && models[m]->getMaterialType() >= M_D_MAP;
+        packable[textureGroup] = (packable.count(textureGroup) == 0) ? lit : packable[textureGroup] && lit;
+    }
+
+    // layers are copied from the textures' images on the GPU, so every image is decoded and uploaded first (which also makes their sizes
+    // known)
+    TextureCache::get().finishUploads();
+
+    // textures are sorted into buckets by slot, size, format, and rendering parameters; each bucket becomes a single array
+    std::map<std::vector<unsigned int>, std::vector<std::shared_ptr<const Texture>>> buckets;
+    std::map<std::shared_ptr<const Texture>, std::vector<unsigned int>> texture_bucket;
+    for (auto& [textureGroup, pack] : packable) {
+        for (int t = 0; t < textureGroup->size() && pack; t++) {
+            std::shared_ptr<const Texture> texture = textureGroup->getTexture(t);
+            // only file based 2D textures can be copied into an array
+            if (texture->getFormat() != TEXTURE_2D || texture->getFileName().empty()) pack = false;
+        }
+        if (!pack) continue;
+        for (int t = 0; t < textureGroup->size(); t++) {
+            std::shared_ptr<const Texture> texture = textureGroup->getTexture(t);
+            if (texture_bucket.count(texture) > 0) continue;
+            std::vector<unsigned int> key = { (unsigned int) texture->getSlot(), 
+                                              (unsigned int) texture->getWidth(), (unsigned int) texture->getHeight(), 
+                                              (unsigned int) texture->getChannels(), 
+                                              texture->getFilter(), texture->getWrapper(), texture->getMipmap() };
+            texture_bucket[texture] = key;
+            buckets[key].push_back(texture);
+        }
+    }
+
+    // create the arrays, remembering which array and layer each texture was copied to
+    std::map<std::vector<unsigned int>, std::shared_ptr<TextureArray>> bucket_array;
+    for (auto& [key, textures] : buckets) {
+        bucket_array[key] = std::make_shared<TextureArray>(textures, textures[0]->getSlot());
+        textureArrays.push_back(bucket_array[key]);
+    }
+    for (auto& [textureGroup, pack] : packable) if (pack) for (int t = 0; t < textureGroup->size(); t++) {
+        std::shared_ptr<const Texture> texture = textureGroup->getTexture(t);
+        std::vector<std::shared_ptr<const Texture>>& bucket = buckets[texture_bucket[texture]];
+        int layer = std::find(bucket.begin(), bucket.end(), texture) - bucket.begin();
+        textureGroup->setArray(t, bucket_array[texture_bucket[texture]], layer);
+    }
+
+    /* Packed groups only read from their arrays, so their textures' images are released (an image is deleted once no texture uses it).
+     * Textures that are also in a group that isn't packed (including groups only render groups know of) keep theirs.
+     */
+    std::set<const Texture*> unpacked;
+    auto keep = [&](const std::shared_ptr<TextureGroup>& textureGroup) {
+        if (textureGroup == nullptr || (packable.count(textureGroup) > 0 && packable[textureGroup])) return;
+        for (int t = 0; t < textureGroup->size(); t++) unpacked.insert(textureGroup->getTexture(t).get());
+    };
+    for (int tg = 0; tg < textureGroups.size(); tg++) keep(textureGroups[tg]);
+    for (int rg = 0; rg < renderGroups.size(); rg++) for (int m = 0; m < renderGroups[rg]->nModels(); m++)
+        keep(renderGroups[rg]->getModel(m)->getTextureGroup());
+    for (auto& [textureGroup, pack] : packable) if (pack) for (int t = 0; t < textureGroup->size(); t++)
+        if (!unpacked.contains(textureGroup->getTexture(t).get())) textureGroup->releaseImage(t);
+}
+
+void Scene::loadMaterials() {
+    materialBuffer = std::make_unique<UniformBuffer>(UB_MATERIALS, MAX_MATERIALS * sizeof(MaterialData));
+    for (const std::shared_ptr<Model>& model : models) if (model != nullptr) model->materialIndex = getMaterialEntry(*model);
+    if (materialData.size() > 0) materialBuffer->setData(0, materialData.size() * sizeof(MaterialData), materialData.data());
+}
+int Scene::getMaterialEntry(const Model& model) {
+    if (model.material == nullptr) return 0;
+    /* The layers of a material's maps depend on the texture group it is paired with, so each material and texture group pair used by a
+     * model gets its own table entry (materials without maps only have a single entry).
+     */
+    std::shared_ptr<TextureGroup> textureGroup = (model.material->type >= M_D_MAP) ? model.getTextureGroup() : nullptr;
+    auto entry = std::make_pair(model.material, textureGroup);
+    auto found = material_entries.find(entry);
+    if (found != material_entries.end()) return found->second;
+    if (materialData.size() == MAX_MATERIALS) {
+        std::cout << "ERROR::SCENE::TOO_MANY_MATERIALS: Scene has more than " << MAX_MATERIALS << 
+                     " material and texture combinations, extra models will use the first material." << std::endl;
+        return material_entries[entry] = 0;
+    }
+    MaterialData data = model.material->getData();
+    if (textureGroup != nullptr) for (int t = 0; t < textureGroup->size() && t < 3; t++) data.maps[t] = textureGroup->getLayer(t);
+    material_entries[entry] = materialData.size();
+    materialData.push_back(data);
+    // once the scene is loaded, new entries are written to the table one at a time as the models that need them are added
+    if (loaded) materialBuffer->setData((materialData.size() - 1) * sizeof(MaterialData), sizeof(MaterialData), &materialData.back());
+    return materialData.size() - 1;
+}
+
+void Scene::cullModels() {
+    // refit the bounds of models that moved since the last frame, then let the tree finish (or start) a background rebuild
+    for (int h = 0; h < modelProxies.size(); h++) if (modelStore->isMoved(h)) {
+        if (modelProxies[h] != -1) modelTree->update(modelProxies[h], modelStore->getBounds(h));
+        modelStore->clearMoved(h);
+    }
+    modelTree->maintain();
+
+    /* Each pass queries the tree once, then the models it finds are handed to the render groups of that pass. Passes run in parallel: the
+     * tree is only read, and every culled group belongs to exactly one pass, so no two passes write to the same visible list.
+     */
+    for (RenderGroup* renderGroup : culledGroups) renderGroup->clearVisible();
+    JobSystem::get().parallelFor(shadowGroups.size() + 1, 1, [&](int p) {
+        int pass = p - 1;
+        // a shadow pass whose light was removed draws nothing until the slot is taken by another light
+        if (pass != -1 && (shadowGroups[pass] == nullptr || lights[pass] == nullptr)) return;
+        std::vector<int> hits = unboundedModels;
+        if (pass == -1) modelTree->query(Frustum(camera->getProj() * camera->getView()), hits);
+        else modelTree->query(Frustum(getLight(pass).getLightTransform()), hits);
+        for (int h : hits) for (const GroupEntry& entry : model_groups[h]) 
+            if (entry.pass == pass) entry.renderGroup->addVisible(entry.index);
+    });
+}
+
+void Scene::updateUniformBuffers() {
+    // the camera is shared by every 3D shader
+    CameraBlock cameraBlock = { camera->getView(), camera->getProj() };
+    cameraBuffer->bindBase();
+    cameraBuffer->setData(0, sizeof(CameraBlock), &cameraBlock);
+
+    materialBuffer->bindBase();
+
+    // assign lights to clusters, then make the grid available to lit shaders
+    lightGrid->update(lights.getResources(), *camera);
+    lightGrid->bind();
+    lightBuffer->bindBase();
+    lightBuffer->setData(0, sizeof(LightGridBlock), &lightGrid->getBlock());
+
+    // only the first MAX_SHADOW_MAPS lights cast shadows
+    int nShadows = (lights.size() < MAX_SHADOW_MAPS) ? lights.size() : MAX_SHADOW_MAPS;
+    std::vector<glm::mat4> lightMats(nShadows);
+    for (int l = 0; l < nShadows; l++) lightMats[l] = (lights[l] != nullptr) ? getLight(l).getLightTransform() : glm::mat4(1.0f);
+
+    shadowBuffer->bindBase();
+    if (nShadows > 0) shadowBuffer->setData(0, nShadows * sizeof(glm::mat4), lightMats.data());
 }
 
 void Scene::save(const std::string& file_name) {
@@ -358,11 +893,15 @@ void Scene::save(const std::string& file_name) {
         }*/
     }
 
-    for (int s = 0; s < shaders.size(); s++) object["shaders"][s] = std::move(getShader(s).getJSON());
-    for (int m = 0; m < models.size(); m++) object["models"][m] = std::move(getModel(m).getJSON());
-    for (int va = 0; va < vertexArrays.size(); va++) object["vertex_arrays"][va] = std::move(getVertexArray(va).getJSON());
-    for (int l = 0; l < lights.size(); l++) object["lights"][l] = std::move(getLight(l).getJSON());
-    for (int m = 0; m < materials.size(); m++) object["materials"][m] = std::move(getMaterial(m).getJSON());
+    // empty slots (removed elements) are skipped, so elements are saved densely
+    int nShaders = 0, nModels = 0, nVertexArrays = 0, nLights = 0, nMaterials = 0;
+    for (int s = 0; s < shaders.size(); s++) if (shaders[s] != nullptr) object["shaders"][nShaders++] = std::move(getShader(s).getJSON());
+    for (int m = 0; m < models.size(); m++) if (models[m] != nullptr) object["models"][nModels++] = std::move(getModel(m).getJSON());
+    for (int va = 0; va < vertexArrays.size(); va++) if (vertexArrays[va] != nullptr)
+        object["vertex_arrays"][nVertexArrays++] = std::move(getVertexArray(va).getJSON());
+    for (int l = 0; l < lights.size(); l++) if (lights[l] != nullptr) object["lights"][nLights++] = std::move(getLight(l).getJSON());
+    for (int m = 0; m < materials.size(); m++) if (materials[m] != nullptr)
+        object["materials"][nMaterials++] = std::move(getMaterial(m).getJSON());
 
     //object["frame"] = std::move(frame->getJSON(), *this);
     object.save(SCENE_PATH + file_name);
@@ -370,23 +909,61 @@ void Scene::save(const std::string& file_name) {
 void Scene::print() const {
     std::cout << "Frame: " << &frame << std::endl;
     frame->print(1);
-    for (int i = 0; i < shaders.size(); i++) std::cout << "Shader[" << i << "]: " << &getShader(i) << std::endl;
-    for (int i = 0; i < models.size(); i++) {
+    for (int i = 0; i < shaders.size(); i++) if (shaders[i] != nullptr) std::cout << "Shader[" << i << "]: " << &getShader(i) << std::endl;
+    for (int i = 0; i < models.size(); i++) if (models[i] != nullptr) {
         std::cout << "Model[" << i << "]: " << &getModel(i) << std::endl;
         //models[i].model->print();
     }
-    for (int i = 0; i < lights.size(); i++) {
+    for (int i = 0; i < lights.size(); i++) if (lights[i] != nullptr) {
         std::cout << "Light[" << i << "]: " << &getLight(i) << std::endl;
         //lights[i].light->print();
     }
-    for (int i = 0; i < vertexArrays.size(); i++) {
+    for (int i = 0; i < vertexArrays.size(); i++) if (vertexArrays[i] != nullptr) {
         std::cout << "VertexArray[" << i << "]: " << &getVertexArray(i) << std::endl;
         //meshes[i].mesh->print();
     }
-    for (int i = 0; i < textureGroups.size(); i++) {
+    for (int i = 0; i < textureGroups.size(); i++) if (textureGroups[i] != nullptr) {
         std::cout << "TextureGroup[" << i << "]: " << &getTextureGroup(i) << std::endl;
         for(int j = 0; j < getTextureGroup(i).size(); j++) 
             std::cout << "\tTexture[" << j << "]: " << getTextureGroup(i).getTexture(j) << std::endl;
     }
-    for (int i = 0; i < materials.size(); i++) std::cout << "Material[" << i << "]: " << &getMaterial(i) << std::endl;
-}
\ No newline at end of file
+    for (int i = 0; i < materials.size(); i++) if (materials[i] != nullptr)
+        std::cout << "Material[" << i << "]: " << &getMaterial(i) << std::endl;
+}
+void Scene::printCullingStats() const {
+    int nDrawn = 0, nCulled = 0, nOccluded = 0, nOccludedTriangles = 0;
+    for (int rg = 0; rg < renderGroups.size(); rg++) {
+        const RenderGroup& renderGroup = *renderGroups[rg];
+        std::cout << "RenderGroup[" << rg << "]" << ((renderGroup.getShader()->getPostprocessing() == P_SHADOW_MAP) ? " (shadow)" : "") << 
+                     ": " << renderGroup.nVisible() << " drawn, " << renderGroup.nCulled() << " culled, " << 
+                     renderGroup.nOccluded() << " occluded (" << renderGroup.nOccludedTriangles() << " triangles)" << std::endl;
+        nDrawn += renderGroup.nVisible();
+        nCulled += renderGroup.nCulled();
+        nOccluded += renderGroup.nOccluded();
+        nOccludedTriangles += renderGroup.nOccludedTriangles();
+    }
+    std::cout << "Total: " << nDrawn << " drawn, " << nCulled << " culled, " << 
+                 nOccluded << " occluded (" << nOccludedTriangles << " triangles)" << std::endl;
+}
+void Scene::printRenderStats() const {
+    // every group that draws anything binds its program once (lit models share one group per program)
+    int nGroups = 0, nLitGroups = 0, nDraws = 0;
+    for (const std::shared_ptr<RenderGroup>& renderGroup : renderGroups) if (renderGroup->nVisible() > 0) {
+        nGroups++;
+        nDraws += renderGroup->nVisible();
+    }
+    for (const RenderGroup* renderGroup : litGroups) if (renderGroup->nVisible() > 0) nLitGroups++;
+    std::cout << "Render groups: " << nGroups << " drawn (" << nLitGroups << " lit" << ((uberShaders) ? ", uber shaders" : "") << "), " << 
+                 nDraws << " draw calls" << std::endl;
+    if (timer != nullptr) timer->print();
+}
+void Scene::printWarmUpTimes() const {
+    double total = 0.0;
+    for (auto& [renderGroup, time] : warmUpTimes) {
+        const Shader* shader = renderGroup->getShader();
+        std::cout << "Warm up: " << shader->genVertexShaderName() << ", " << shader->genFragmentShaderName() << ": " << time << " ms" << 
+                     std::endl;
+        total += time;
+    }
+    std::cout << "Warm up total: " << total << " ms (" << warmUpTimes.size() << " render groups)" << std::endl;
+}
@@ -1,18 +1,19 @@
 #include "gui/shader.hpp"
 
-// these paths are the locations of the shader save files and shader component files
-const char SHADER_SAVE_PATH[] = "../res/shaders/saves/", SHADER_COMPONENTS_PATH[] = "../res/shaders/components/";
-// these are keys that are used to parse component files so that specific code snippets can be found
-// structural keys are used for structural elements of the shader while all others are based on parameter specifications
+// these are keys that are used to parse component files so that specific code snippets can be found, based on parameter specifications
+// (the structural keys, which are used for structural elements of the shader, are kept by the shader template)
 std::string GENERAL_KEY = "@@GENERAL",
-            STRUCTURAL_KEYS[] = { "@GLOBAL\n", "@STRUCTS\n", "@IN\n", "@OUT\n", "@UNIFORMS\n", "@FUNCTIONS\n", "@MAIN\n" },
-            RENDERING_KEYS[] = { "@@BASIC_2D", "@@BASIC_3D", "@@LIGHTING_3D", "@@SKYBOX"},
+            RENDERING_KEYS[] = { "@@BASIC_2D", "@@BASIC_3D", "@@LIGHTING_3D", "@@SKYBOX", "@@GBUFFER_3D", "@@DEFERRED_LIGHTING" },
             OUTPUT_KEYS[] = { "@@COLOR_BUFFER", "@@DEPTH_BUFFER", "@@STENCIL_BUFFER"},
             LIGHTING_KEYS[] = { "", "@@DIR", "@@POINT", "@@SPOT", "@@DIR_POINT", "@@DIR_SPOT", "@@POINT_SPOT", "@@ALL_ENABLED" },
             SHADOW_KEYS[] = { "@@DISABLED", "@@SHADOW_MAPPING" },
-            MATERIAL_KEYS[] = { "", "@@BASIC", "@@D_MAP", "@@DS_MAP", "@@DSE_MAP" },
-            TEXTURE_KEYS[] = { "@@DISABLED", "@@BASIC_2D", "@@CUBE" },
+            MATERIAL_KEYS[] = { "", "@@BASIC", "@@D_MAP", "@@DS_MAP", "@@DSE_MAP", "@@UBER" },
+            TEXTURE_KEYS[] = { "@@DISABLED", "@@BASIC_2D", "@@CUBE", "@@ARRAY_2D" },
             POSTPROCESSING_KEYS[] = { "@@DISABLED", "@@BLUR", "@@DEPTH_MAP", "@@LINEARIZED_DEPTH_MAP", "@@SHADOW_MAP"};
+// lit geometry rendered to the depth buffer only uses its own rendering and output snippets (see isDepthPrepass())
+std::string DEPTH_PREPASS_KEY = "@@DEPTH_PREPASS";
+// the passes of deferred shading write to and read materials and light space positions from a G-buffer
+std::string GBUFFER_KEY = "@@GBUFFER", DEFERRED_MATERIAL_KEY = "@@DEFERRED", DEFERRED_SHADOW_KEY = "@@DEFERRED_SHADOW_MAPPING";
 // these are the names of shader component files (each corresponds to a shader parameter)
 std::string RENDERING_FILE = "rendering.glsl", OUTPUT_FILE = "output.glsl", LIGHTING_FILE = "lighting.glsl", 
             MATERIAL_FILE = "material.glsl", SHADOW_FILE = "shadow.glsl", TEXTURE_FILE = "texture.glsl", 
@@ -24,12 +25,8 @@ Shader::Shader(const unsigned int RENDERING_STYLE, const unsigned int OUTPUT_BUF
                const unsigned int TEXTURE_STYLE, const unsigned int POSTPROCESSING)
         : rendering_style(RENDERING_STYLE), output_buffer(OUTPUT_BUFFER), material_style(MATERIAL_STYLE), lighting_style(LIGHTING_STYLE),
           shadow_style(SHADOW_STYLE), texture_style(TEXTURE_STYLE), postprocessing(POSTPROCESSING) {
-    
-    // create shader obeject in the openGL context and retrieve integer id with which to reference it
-    programID = glCreateProgram();
-    #if DEBUG_OPENGL_OBJECTS 
-        std::cout << "Shader " << programID << " was created." << std::endl;
-    #endif
+
+    // the program object is created in the OpenGL context when the shader is loaded (see load())
 }
 Shader::Shader(Serializer& object) {
     // read shader parameters from the format object (which allows for communication with json files)
@@ -40,50 +37,173 @@ Shader::Shader(Serializer& object) {
     shadow_style = object["shadow_style"];
     texture_style = object["texture_style"];
     postprocessing = object["postprocessing"]; 
+}
+// header of a saved program binary, which is only loaded if it matches the shader, the running driver, and the current component files
+struct ProgramBinaryHeader {
+    uint64_t key;           // shader parameters (see getKey())
+    uint64_t driver;        // hash of the driver string (see r_GetDriverString())
+    uint64_t components;    // hash of the component files that the program's source was generated from
+    uint32_t format;        // the driver's format for the binary
+    uint32_t length;        // length of the binary that follows the header
+};
+// hash of every component file, so that binaries linked from older components are compiled again (see ShaderTemplate::getHash()). Baked
+// shaders take it from the manifest written by the shader baker instead, so that the component files are never needed.
+uint64_t getComponentHash() {
+    #if REQUIRE_BAKED_SHADERS
+        static const uint64_t hash = [] {
+            std::string path = std::string(SHADER_SAVE_PATH) + SHADER_MANIFEST_FILE;
+            if (!f_exists(path)) {
+                std::cout << "ERROR::SHADER::MISSING_MANIFEST: Shaders have not been baked (see tools/shader_baker.cpp)." << std::endl;
+                return (uint64_t) 0;
+            }
+            Serializer manifest(path);
+            return (uint64_t) std::stoull(static_cast<std::string&>(manifest["components"]), nullptr, 16);
+        }();
+        return hash;
+    #else
+        return ShaderTemplate::get().getHash();
+    #endif
+}
+// saved sources start with a comment naming the components they were generated from (comments may come before #version), so that a
+// source saved from older component files is generated again rather than compiled
+static std::string getSourceStamp() {
+    char stamp[48];
+    std::snprintf(stamp, sizeof(stamp), "// components %016llx\n", (unsigned long long) getComponentHash());
+    return stamp;
+}
 
+void Shader::load() {
     // create shader obeject in the openGL context and retrieve integer id with which to reference it
     programID = glCreateProgram();
     #if DEBUG_OPENGL_OBJECTS 
         std::cout << "Shader " << programID << " was created." << std::endl;
     #endif
-}
-void Shader::load() {
+
+    // a program binary saved by an earlier run skips generating, compiling, and linking the source entirely
+    if (loadBinary()) {
+        bindUniformBlocks();
+        linked = true;
+        return;
+    }
+
     // generate unique shader file names based on the shader parameters
     std::string v_shader_name = genVertexShaderName(), f_shader_name = genFragmentShaderName();
-    // if there are already shader files that have this name in the save directory, load those files, otherwise create new shaders
-    v_source = (f_exists(SHADER_SAVE_PATH + v_shader_name)) ? loadFile(v_shader_name, SHADER_SAVE_PATH) : generateVertexShader();
-    f_source = (f_exists(SHADER_SAVE_PATH + f_shader_name)) ? loadFile(f_shader_name, SHADER_SAVE_PATH) : generateFragmentShader();
+    #if REQUIRE_BAKED_SHADERS
+        // shaders are only ever loaded from the save directory, the component assembler is never run
+        if (!loadSavedSource(v_shader_name, v_source) || !loadSavedSource(f_shader_name, f_source)) {
+            std::cout << "ERROR::SHADER::NOT_BAKED: " << v_shader_name << ", " << f_shader_name << " (see tools/shader_baker.cpp)." 
+                << std::endl;
+            return;
+        }
+    #else
+        // if there are already shader files that have this name in the save directory (saved from the current components), load those
+        // files, otherwise create new shaders
+        if (!loadSavedSource(v_shader_name, v_source)) generateVertexShader();
+        if (!loadSavedSource(f_shader_name, f_source)) generateFragmentShader();
+    #endif
 
-    // compile the shaders and then link them together
-    unsigned int vertexShader = compileShader(v_source, GL_VERTEX_SHADER), fragmentShader = compileShader(f_source, GL_FRAGMENT_SHADER);
-    createProgram(vertexShader, fragmentShader); 
+    /* Compile the shaders and then link them together. Nothing is asked of the program until isReady() is called, since asking for the
+     * status of a compile or link makes the driver finish it first. This way, every program the scene needs is issued before any of them
+     * is waited on, and the driver can build them at the same time (on its own threads, with GL_KHR_parallel_shader_compile).
+     */
+    vertexShader = compileShader(v_source, GL_VERTEX_SHADER);
+    fragmentShader = compileShader(f_source, GL_FRAGMENT_SHADER);
+    linkProgram();
+    pending = true;
+}
+bool Shader::isReady() {
+    if (!pending) return linked;
+    // without the extension there is no way to ask without waiting, but the program has still had until now to be built
+    if (r_HasParallelShaderCompile()) {
+        int complete = GL_FALSE;
+        glGetProgramiv(programID, GL_COMPLETION_STATUS_KHR, &complete);
+        if (complete == GL_FALSE) return false;
+    }
+    return finishProgram();
+}
+bool Shader::wait() {
+    if (!pending) return linked;
+    return finishProgram();
+}
+bool Shader::finishProgram() {
+    pending = false;
+    linked = checkProgram();
+    if (linked) {
+        bindUniformBlocks();
+        saveBinary();
+    }
+    return linked;
 }
 Shader::~Shader() {
-    // When shader object is deleted, also make sure openGL context program object is deleted. 
+    // When shader object is deleted, also make sure openGL context program object is deleted (if it was ever loaded).
+    if (programID == 0) return;
     glDeleteProgram(programID);
     #if DEBUG_OPENGL_OBJECTS 
         std::cout << "Shader " << programID << " was deleted." << std::endl;
     #endif
 }
 
+bool Shader::bake() {
+    if (!generate()) return false;
+
+    // unlike getJSON(), saves are always replaced
+    saveSource(genVertexShaderName(), v_source);
+    saveSource(genFragmentShaderName(), f_source);
+    return true;
+}
+bool Shader::generate() {
+    generated = true;
+    generateVertexShader();
+    generateFragmentShader();
+    return generated;
+}
+bool Shader::validate() {
+    // build the program from source and wait for it, then throw it away (the shader can still be loaded afterwards)
+    programID = glCreateProgram();
+    vertexShader = compileShader(v_source, GL_VERTEX_SHADER);
+    fragmentShader = compileShader(f_source, GL_FRAGMENT_SHADER);
+    linkProgram();
+    bool valid = checkProgram();
+    // checkProgram() already deletes programs that failed to link
+    if (valid) glDeleteProgram(programID);
+    programID = 0;
+    return valid;
+}
+
 
-bool Shader::operator==(const Shader& compare) {
+bool Shader::operator==(const Shader& compare) const {
     // Shaders are unique based on their parameter settings. Check for equality between those.
     return rendering_style == compare.rendering_style && output_buffer == compare.output_buffer &&
            material_style == compare.material_style && lighting_style == compare.lighting_style &&
            shadow_style == compare.shadow_style && texture_style == compare.texture_style && postprocessing == compare.postprocessing;
 }
+uint64_t Shader::getKey() const {
+    // every parameter fits in a byte (see elements.hpp)
+    uint64_t key = 0;
+    for (unsigned int parameter : { rendering_style, output_buffer, material_style, lighting_style, shadow_style, texture_style, 
+                                    postprocessing })
+        key = (key << 8) | (parameter & 0xFF);
+    return key;
+}
 
 
-bool Shader::createProgram(const unsigned int& vertexShader, const unsigned int& fragmentShader) {
-    // Checks if shaders were successfully linked
-    bool success = true;
+void Shader::linkProgram() {
     // link individual shaders into a single program
     glAttachShader(programID, vertexShader);    //attach vertex shader to program
     glAttachShader(programID, fragmentShader);  //attach fragment shader to program
+    // the driver may only keep what it needs to return the binary if it is told before linking
+    if (r_HasProgramBinaries()) r_glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(programID);                   //link program
+}
+bool Shader::checkProgram() {
+    // Checks if shaders were successfully compiled and linked
+    bool success = true;
+    // check for compilation errors, but don't stop the program. This will cause the error to cascade to the linking step.
+    std::string v_shader_name = genVertexShaderName(), f_shader_name = genFragmentShaderName();
+    bool compiled = checkCompilationErrors(vertexShader, v_shader_name);
+    if (!checkCompilationErrors(fragmentShader, f_shader_name) || !compiled) print();
     // if there are errors, print for debugging
-    if (!checkLinkingErrors()) {
+    if (!checkLinkingErrors(v_shader_name, f_shader_name)) {
         glDeleteProgram(programID);
         success = false;
         printSource(v_source);
@@ -95,18 +215,21 @@ bool Shader::createProgram(const unsigned int& vertexShader, const unsigned int&
 
     return success;
 }
-const unsigned int Shader::compileShader(const std::string& source, const unsigned int type) { return compileShader(source, type, ""); }
-const unsigned int Shader::compileShader(const std::string& source, const unsigned int type, const std::string fileName) {
+void Shader::bindUniformBlocks() const {
+    // link every shared uniform block the program declares to the binding point of its uniform buffer (blocks that are not used by
+    // this program are simply not found)
+    for (unsigned int i = 0; i < N_UNIFORM_BLOCKS; i++) {
+        unsigned int blockIndex = glGetUniformBlockIndex(programID, UNIFORM_BLOCK_NAMES[i].c_str());
+        if (blockIndex != GL_INVALID_INDEX) glUniformBlockBinding(programID, blockIndex, i);
+    }
+}
+const unsigned int Shader::compileShader(const std::string& source, const unsigned int type) {
     // create a shader object in the openGL context and compile the shader, then return the shader id
     const unsigned int shaderID = glCreateShader(type);
     const char* const _source = source.c_str();
     glShaderSource(shaderID, 1, &_source, NULL);
     glCompileShader(shaderID);
-    // check for compilation errors, but don't stop the program. This will cause the error to cascade to the linking step.
-    if (!checkCompilationErrors(shaderID, fileName)) {
-        print();
-        printSource(source);
-    }
+    // errors are checked once the program is linked (see checkProgram())
 
     return shaderID;
 }
@@ -138,50 +261,6 @@ bool Shader::checkCompilationErrors(const unsigned int shader, const std::string
     return success;
 }
 
-void Shader::setUniform(std::shared_ptr<Material> material) const {
-    // Read from a material struct and copy data to the identical struct in the shader program. Uniforms are dependent on material type.
-    switch(material->type) {
-    case M_BASIC: {
-        setUniform(MAT_NAME[M_BASIC] + ".ambient", material->basicMat.ambient);
-        setUniform(MAT_NAME[M_BASIC] + ".diffuse", material->basicMat.diffuse);
-        setUniform(MAT_NAME[M_BASIC] + ".specular", material->basicMat.specular);
-        setUniform(MAT_NAME[M_BASIC] + ".shininess", material->basicMat.shininess);
-    } break;
-    case M_D_MAP: {
-        setUniform(MAT_NAME[M_D_MAP] + ".diffuse", material->dMap.diffuse);
-        setUniform(MAT_NAME[M_D_MAP] + ".specular", material->dMap.specular);
-        setUniform(MAT_NAME[M_D_MAP] + ".shininess", material->dMap.shininess);
-    } break;
-    case M_DS_MAP: {
-        setUniform(MAT_NAME[M_DS_MAP] + ".diffuse", material->dsMap.diffuse);
-        setUniform(MAT_NAME[M_DS_MAP] + ".specular", material->dsMap.specular);
-        setUniform(MAT_NAME[M_DS_MAP] + ".shininess", material->dsMap.shininess);
-    } break;
-    case M_DSE_MAP: {
-        setUniform(MAT_NAME[M_DSE_MAP] + ".diffuse", material->dseMap.diffuse);
-        setUniform(MAT_NAME[M_DSE_MAP] + ".specular", material->dseMap.specular);
-        setUniform(MAT_NAME[M_DSE_MAP] + ".emission", material->dseMap.emission);
-        setUniform(MAT_NAME[M_DSE_MAP] + ".shininess", material->dseMap.shininess);
-    } break;
-    }
-}
-void Shader::setUniform(const std::string &name, const Light& light, const glm::mat4 view) const {
-    // Copy data from a light object to an equivalent light struct in the shader program.
-    setUniform(name + ".type", light.type);
-    // need to convert spatial vectors to view space
-    setUniform(name + ".pos", glm::vec3(view * glm::vec4(light.pos, 1.0f))); 
-    setUniform(name + ".dir", glm::mat3(view) * light.dir);
-    setUniform(name + ".ambient", light.ambient);
-    setUniform(name + ".diffuse", light.diffuse);
-    setUniform(name + ".specular", light.specular);
-    setUniform(name + ".constant", light.constant);
-    setUniform(name + ".linear", light.linear);
-    setUniform(name + ".quadratic", light.quadratic);
-    setUniform(name + ".inner", light.inner);
-    setUniform(name + ".outer", light.outer);
-    setUniform(name + ".shadowMap", light.getShadowMapSlot());
-}
-
 // TODO fix naming convention for "getJSON" methods
 Serializer Shader::getJSON() {
     // save shader parameters to a format object, which will convert them to a json or can be added to a scene object
@@ -194,17 +273,57 @@ Serializer Shader::getJSON() {
     object["texture_style"] = texture_style;
     object["postprocessing"] = postprocessing;
 
-    // TODO - offload to file saving method
-    // create unique file names based on parameters
-    std::string v_path = std::string(SHADER_SAVE_PATH) + genVertexShaderName(), 
-                f_path = std::string(SHADER_SAVE_PATH) + genFragmentShaderName();
-
-    // check if there are files that have those names already, if not make ones
-    if (!f_exists(v_path)) f_writeText(v_path, v_source);
-    if (!f_exists(f_path)) f_writeText(f_path, f_source);
+    // check if there are files saved from the current components already, if not make ones (a program loaded from its binary has no
+    // source to save)
+    std::string saved;
+    if (!v_source.empty() && !loadSavedSource(genVertexShaderName(), saved)) saveSource(genVertexShaderName(), v_source);
+    if (!f_source.empty() && !loadSavedSource(genFragmentShaderName(), saved)) saveSource(genFragmentShaderName(), f_source);
 
     return object;
 }
+bool Shader::loadBinary() {
+    if (!r_HasProgramBinaries()) return false;
+    std::string path = SHADER_SAVE_PATH + genBinaryName();
+    if (!f_exists(path)) return false;
+    size_t length = f_length(path);
+    if (length < sizeof(ProgramBinaryHeader)) return false;
+    std::vector<char> data(length);
+    f_readBinary(path, data.data(), length);
+
+    // a binary saved for other parameters, by another driver, or from older components falls back to the source (and is replaced)
+    ProgramBinaryHeader header;
+    std::memcpy(&header, data.data(), sizeof(ProgramBinaryHeader));
+    if (header.key != getKey() || header.driver != std::hash<std::string>()(r_GetDriverString()) || 
+        header.components != getComponentHash() || header.length != length - sizeof(ProgramBinaryHeader)) return false;
+
+    // the driver can still reject a binary (e.g. after an update that didn't change its version string), which leaves the program unlinked
+    r_glProgramBinary(programID, header.format, data.data() + sizeof(ProgramBinaryHeader), header.length);
+    int success;
+    glGetProgramiv(programID, GL_LINK_STATUS, &success);
+    return success;
+}
+void Shader::saveBinary() const {
+    if (!r_HasProgramBinaries()) return;
+    int length = 0;
+    glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    ProgramBinaryHeader header = { getKey(), std::hash<std::string>()(r_GetDriverString()), getComponentHash(), 0, (uint32_t) length };
+    std::vector<char> data(sizeof(ProgramBinaryHeader) + length);
+    r_glGetProgramBinary(programID, length, nullptr, &header.format, data.data() + sizeof(ProgramBinaryHeader));
+    std::memcpy(data.data(), &header, sizeof(ProgramBinaryHeader));
+
+    std::string path = SHADER_SAVE_PATH + genBinaryName();
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    f_writeBinary(path, data.data(), data.size());
+}
+std::string Shader::genBinaryName() const {
+    // every parameter is part of the key, so the key alone names the program
+    char name[32];
+    std::snprintf(name, sizeof(name), "p_%014llx.bin", (unsigned long long) getKey());
+    return std::string("p_shaders/") + name;
+}
+
 // TODO - this should be in io/file_io.hpp
 std::string Shader::loadFile(std::string fileName, std::string path) {
     // add shader directory root to the fileName
@@ -216,18 +335,33 @@ std::string Shader::loadFile(std::string fileName, std::string path) {
 
     return contents;
 }
-std::string Shader::genVertexShaderName() {
+bool Shader::loadSavedSource(const std::string& fileName, std::string& source) {
+    if (!f_exists(SHADER_SAVE_PATH + fileName)) return false;
+    std::string contents = loadFile(fileName, SHADER_SAVE_PATH);
+    std::string stamp = getSourceStamp();
+    if (contents.compare(0, stamp.length(), stamp) != 0) return false;
+    source = contents.substr(stamp.length());
+    return true;
+}
+void Shader::saveSource(const std::string& fileName, const std::string& source) const {
+    std::string path = SHADER_SAVE_PATH + fileName;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    f_writeText(path, getSourceStamp() + source);
+}
+std::string Shader::genVertexShaderName() const {
     // note: not all parameters are needed to fully specify a vertex shader
 
     // concatenate a string with various components that indicate what kind of vertex shader it is
     // "v" marks that this is a vertex shader
     std::string v_shader_name = "v";
     // rendering strategy determines whether other parameters will be used
-    switch(rendering_style) {
+    switch(getVertexStyle()) {
     case R_BASIC_2D: { v_shader_name += "_2D"; } break;
     case R_BASIC_3D: { v_shader_name += "_3D"; } break;
     case R_LIGHTING_3D: { 
         v_shader_name += "_l3D";
+        // the depth pre-pass only transforms positions
+        if (isDepthPrepass()) v_shader_name += "_dbuf";
         // if there is lighting, there might also be shadows (if nothing, then shadows are disabled)
         switch(shadow_style) {
         case S_SHADOW_MAPPING: { v_shader_name += "_ssmap"; } break;
@@ -240,11 +374,12 @@ std::string Shader::genVertexShaderName() {
     switch(texture_style) {
     case T_BASIC_2D: { v_shader_name += "_t2D"; } break;
     case T_CUBE: { v_shader_name += "_tcube"; } break;
+    case T_ARRAY_2D: { v_shader_name += "_tarr"; } break;
     }
     // make sure to place in vertex shader folder and add the correct file type
     return "v_shaders/" + v_shader_name + ".glsl";
 }
-std::string Shader::genFragmentShaderName() {
+std::string Shader::genFragmentShaderName() const {
     // concatenate a string with various components that indicate what kind of fragment shader it is
     // "f" marks that this is a vertex shader
     std::string f_shader_name = "f";
@@ -252,9 +387,15 @@ std::string Shader::genFragmentShaderName() {
     switch(rendering_style) {
     case R_BASIC_2D: { f_shader_name += "_2D"; } break;
     case R_BASIC_3D: { f_shader_name += "_3D"; } break;
-    case R_LIGHTING_3D: { 
-        // if there is lighting, we will also need a lighting style, material style, and shadow style
-        f_shader_name += "_l3D"; 
+    case R_LIGHTING_3D: { f_shader_name += "_l3D"; } break;
+    case R_SKYBOX: { f_shader_name += "_box"; } break;
+    case R_GBUFFER_3D: { f_shader_name += "_gb3D"; } break;
+    case R_DEFERRED_LIGHTING: { f_shader_name += "_dl"; } break;
+    }
+    // if there is lighting, we will also need a lighting style, material style, and shadow style (in deferred shading, the materials are
+    // written by the G-buffer pass and lit by the lighting pass)
+    bool lit = rendering_style == R_LIGHTING_3D || rendering_style == R_DEFERRED_LIGHTING;
+    if (lit) {
         switch(lighting_style) {
         case L_DIR: { f_shader_name += "_ld"; } break;
         case L_POINT: { f_shader_name += "_lp"; } break;
@@ -264,17 +405,20 @@ std::string Shader::genFragmentShaderName() {
         case L_POINT_SPOT: { f_shader_name += "_lps"; } break;
         case L_ALL_ENABLED: { f_shader_name += "_ldps"; } break;
         }
+    }
+    if (rendering_style == R_LIGHTING_3D || rendering_style == R_GBUFFER_3D) {
         switch(material_style) {
         case M_BASIC: { f_shader_name += "_mbas"; } break;
         case M_D_MAP: { f_shader_name += "_mdmap"; } break;
         case M_DS_MAP: { f_shader_name += "_mdsmap"; } break;
         case M_DSE_MAP: { f_shader_name += "_mdsemap"; } break;
+        case M_UBER: { f_shader_name += "_muber"; } break;
         }
+    }
+    if (lit) {
         switch(shadow_style) {
         case S_SHADOW_MAPPING: { f_shader_name += "_ssmap"; } break;
         }
-    } break;
-    case R_SKYBOX: { f_shader_name += "_box"; } break;
     }
     // next, specify output buffer (if there is nothing, that means it is a color buffer)
     switch(output_buffer) {
@@ -285,6 +429,7 @@ std::string Shader::genFragmentShaderName() {
     switch(texture_style) {
     case T_BASIC_2D: { f_shader_name += "_t2D"; } break;
     case T_CUBE: { f_shader_name += "_tcube"; } break;
+    case T_ARRAY_2D: { f_shader_name += "_tarr"; } break;
     }
     // then postprocessing strategy (if nothing, then postprocessing is disabled)
     switch(postprocessing) {
@@ -296,41 +441,35 @@ std::string Shader::genFragmentShaderName() {
     return "f_shaders/" + f_shader_name + ".glsl";
 }
 
-std::string& Shader::generateVertexShader() {
-    // Version declaration
-    v_source = getVersion();
-
+std::vector<const ShaderTemplate::Block*> Shader::getVertexComponents() const {
     // iterate through various component files, each of which corresponds to a shader parameter. Each element in the array corresponds 
     // a section, which is indicated by a structural key.
-    std::string v_components = "";
-    //std::vector<std::unique_ptr<std::string>> v_components;
-    addComponent(v_components, RENDERING_FILE, RENDERING_KEYS[rendering_style], GL_VERTEX_SHADER);
+    std::vector<const ShaderTemplate::Block*> v_components;
+    addComponent(v_components, RENDERING_FILE, (isDepthPrepass()) ? DEPTH_PREPASS_KEY : RENDERING_KEYS[getVertexStyle()], GL_VERTEX_SHADER);
     addComponent(v_components, TEXTURE_FILE, TEXTURE_KEYS[texture_style], GL_VERTEX_SHADER);
-    if (rendering_style == R_LIGHTING_3D)
+    if (getVertexStyle() == R_LIGHTING_3D && !isDepthPrepass())
         addComponent(v_components, SHADOW_FILE, SHADOW_KEYS[shadow_style], GL_VERTEX_SHADER);
+    return v_components;
+}
+std::vector<const ShaderTemplate::Block*> Shader::getFragmentComponents() const {
+    std::vector<const ShaderTemplate::Block*> f_components;
 
-    // once all components are added, they will need to be arranged into the proper order and placeholder sections will need to be with
-    // the correct code snippets.
-    // the code with be rearranged by section such that each section has the appropriate code snippets from each component in the order
-    // the components were added above.
-    assembleSource(v_source, v_components);
-
-    // some placeholders are indicated by a '$'. These are used to specify layout positions. Layout positions must occur in
-    // in incrementing order, so we simply set them to an incrementing value for each one we find.
-    size_t c = 0, pos = v_source.find('$');
-    while(pos != std::string::npos) {
-        v_source.replace(pos, 1, std::to_string(c++));
-        pos = v_source.find('$');
+    // the depth pre-pass has no outputs, the depth buffer is written by the fixed function pipeline (writing gl_FragDepth would
+    // disable early depth testing)
+    if (isDepthPrepass()) {
+        addComponent(f_components, OUTPUT_FILE, DEPTH_PREPASS_KEY, GL_FRAGMENT_SHADER);
+        return f_components;
     }
 
-    return v_source;
-}
-std::string& Shader::generateFragmentShader() {
-    // version declaration
-    f_source = getVersion();
-
-    std::string f_components = "";
-    //std::vector<std::unique_ptr<std::string>> f_components;
+    // the G-buffer pass writes material values to several outputs instead of lighting them (the output is added last, since the
+    // functions that write each output sample the material)
+    if (rendering_style == R_GBUFFER_3D) {
+        addComponent(f_components, RENDERING_FILE, RENDERING_KEYS[rendering_style], GL_FRAGMENT_SHADER);
+        addComponent(f_components, TEXTURE_FILE, TEXTURE_KEYS[texture_style], GL_FRAGMENT_SHADER);
+        addComponent(f_components, MATERIAL_FILE, MATERIAL_KEYS[material_style], GL_FRAGMENT_SHADER);
+        addComponent(f_components, OUTPUT_FILE, GBUFFER_KEY, GL_FRAGMENT_SHADER);
+        return f_components;
+    }
 
     // similar to above, though there are more parameters that must be specified
     addComponent(f_components, RENDERING_FILE, RENDERING_KEYS[rendering_style], GL_FRAGMENT_SHADER);
@@ -340,11 +479,48 @@ std::string& Shader::generateFragmentShader() {
         addComponent(f_components, LIGHTING_FILE, LIGHTING_KEYS[lighting_style], GL_FRAGMENT_SHADER);
         addComponent(f_components, SHADOW_FILE, SHADOW_KEYS[shadow_style], GL_FRAGMENT_SHADER);
         addComponent(f_components, MATERIAL_FILE, MATERIAL_KEYS[material_style], GL_FRAGMENT_SHADER );
+    } else if (rendering_style == R_DEFERRED_LIGHTING) {
+        // the deferred lighting pass reads materials from the G-buffer and finds light space positions from the depth target
+        addComponent(f_components, LIGHTING_FILE, LIGHTING_KEYS[lighting_style], GL_FRAGMENT_SHADER);
+        addComponent(f_components, SHADOW_FILE, 
+                     (shadow_style == S_SHADOW_MAPPING) ? DEFERRED_SHADOW_KEY : SHADOW_KEYS[shadow_style], GL_FRAGMENT_SHADER);
+        addComponent(f_components, MATERIAL_FILE, DEFERRED_MATERIAL_KEY, GL_FRAGMENT_SHADER);
     } else 
         addComponent(f_components, POSTPROCESSING_FILE, POSTPROCESSING_KEYS[postprocessing], GL_FRAGMENT_SHADER);
+    return f_components;
+}
+
+std::string& Shader::generateVertexShader() {
+    // Version declaration
+    v_source = getVersion();
+
+    // once all components are added, they will need to be arranged into the proper order and placeholder sections will need to be with
+    // the correct code snippets.
+    // the code with be rearranged by section such that each section has the appropriate code snippets from each component in the order
+    // the components were added (see getVertexComponents()).
+    generated = assembleSource(v_source, getVertexComponents()) && generated;
+
+    // some placeholders are indicated by a '$'. These are used to specify layout positions. Layout positions must occur in
+    // in incrementing order, so we simply set them to an incrementing value for each one we find.
+    if (v_source.find('$') != std::string::npos) {
+        std::string source;
+        source.reserve(v_source.length() + 16);
+        unsigned int c = 0;
+        for (char ch : v_source) {
+            if (ch == '$') source += std::to_string(c++);
+            else source += ch;
+        }
+        v_source = std::move(source);
+    }
+
+    return v_source;
+}
+std::string& Shader::generateFragmentShader() {
+    // version declaration
+    f_source = getVersion();
 
     // as above
-    assembleSource(f_source, f_components);
+    generated = assembleSource(f_source, getFragmentComponents()) && generated;
 
     return f_source;
 }
@@ -359,115 +535,25 @@ std::string Shader::getVersion() {
 
     return version;
 }
-void Shader::addComponent(std::string& components, const std::string fileName, const std::string key, const unsigned int shaderType) {
+void Shader::addComponent(std::vector<const ShaderTemplate::Block*>& components, const std::string fileName, const std::string key, 
+                          const unsigned int shaderType) const {
     // specify between vertex and fragment components
     std::string _fileName;
     switch(shaderType) {
     case GL_VERTEX_SHADER: { _fileName = "v_" + fileName; } break;
     case GL_FRAGMENT_SHADER: { _fileName = "f_" + fileName; } break;
     }
-    // load file
-    std::string source = loadFile(_fileName, SHADER_COMPONENTS_PATH);
+    // component files are indexed by the shader template, which reads them once and shares their blocks with every shader
+    const ShaderTemplate& shaderTemplate = ShaderTemplate::get();
     // some component files have snippets that are needed regardless of shader parameters, which are accessed with the general key
-    if (p_hasKey(source, GENERAL_KEY)) components += p_getKeyedSubstr(source, "@@", GENERAL_KEY);
+    const ShaderTemplate::Block* general = shaderTemplate.getBlock(_fileName, GENERAL_KEY);
+    if (general != nullptr) components.push_back(general);
     // otherwise, only copy the code associated with the specified key
-    components += p_getKeyedSubstr(source, "@@", key);
-}
-void Shader::assembleSource(std::string& source, const std::string components) {
-    for (std::string key : STRUCTURAL_KEYS) {
-        std::string section = "";
-        int c = components.find(key);
-        while(c != std::string::npos) {
-            section += p_getKeyedSubstr(components.substr(c), '@', key);
-            c = components.find(key, c + 1);
-        }
-        fillPlaceholders(section, "&&");
-        fillPlaceholders(section, '&');
-        if (section.length() > 0) source += '\n' + section;
-    }
-}
-void Shader::fillPlaceholders(std::string& section, char flag) {
-    // keeps running until there are no more of the specified flags
-    while(p_hasKey(section, flag)) {
-        // look for the first and second appearances of the flag. These are the opening and closing flags of the first placeholder.
-        size_t var_start = section.find(flag), var_end = section.find(flag, var_start + 1), fill_start = 0, fill_end = 0;
-        // the text contained within the flags is either the placeholder or the snippet that should replace the placeholder
-        std::string var = section.substr(var_start, var_end - var_start), fill = "";
-        // if var has a line break in it, it must be the snippet that replaces the placeholder
-        if (p_hasKey(var, '\n')) {
-            // the placeholder is the text that occurs before the line break plus a closing flag
-            var = var.substr(0, var.find('\n')) + flag;
-            // the replacement text is everything after the line break until the closing character
-            fill = section.substr(var_start + var.length(), var_end - var_start - var.length());
-            // erase the replacement text
-            section.erase(var_start, var_end - var_start + 2);
-            // search for the key and replace it with the replacement text
-            fill_start = section.find(var);
-            if (fill_start != std::string::npos) {
-                fill_end = section.find(flag, fill_start + 1);
-                section.replace(fill_start, fill_end - fill_start + 1, fill);
-            }
-            #if DEBUG_SHADER_BUILDER_SHOW_UNUSED_VARS
-                // if could not find the key, then there was a designated replacement text but it was unused
-                // this is not necessarily an error (because the replacement text still gets deleted), but may not be intended
-                else std::cout << "ERROR::SHADER::UNUSED_VARIABLE: Variable \"" << var << "\" defined but not used." << std::endl;
-            #endif
-        // otherwise, var is already a placeholder
-        } else {
-            // add a line break and look for the replacement text
-            var += '\n';
-            if (!p_hasKey(section, var)) {
-                // if the flag-key-line break combo doesn't exist, then there is no replacement section
-                // this is critical because the shader code is unlikely to compile if placeholders are not replaced
-                std::cout << "ERROR::SHADER::MISSING_DEFINITION: Variable \"" << var.substr(0, var.length() - 1) 
-                    << flag << "\" undefined." << std::endl;
-                break;
-            }
-            // locating replacement text so that it can be erased
-            fill_start = section.find(var), fill_end = section.find(flag, fill_start + 1);
-            // replacement code starts after the line break
-            fill = section.substr(fill_start + var.length(), fill_end - fill_start - var.length());
-            // replace the original placeholder with replacement code
-            section.replace(var_start, var_end - var_start + 1, fill);
-            // account for the change in text positions given the above replacement, then erase the replacement code
-            size_t l = fill_end - fill_start + 2;
-            fill_start += (var_start < fill_start) ? fill.length() - var_end + var_start - 1 : 0;
-            section.erase(fill_start, l);
-        }
-    }
+    const ShaderTemplate::Block* block = shaderTemplate.getBlock(_fileName, key);
+    if (block != nullptr) components.push_back(block);
 }
-void Shader::fillPlaceholders(std::string& section, std::string flag) {
-    while(p_hasKey(section, flag)) {
-        size_t var_start = section.find(flag), var_end = section.find(flag, var_start + 1), fill_start = 0, fill_end = 0;
-        std::string var = section.substr(var_start, var_end - var_start), fill = "";
-        if (p_hasKey(var, '\n')) {
-            var = var.substr(0, var.find('\n')) + flag;
-            fill = section.substr(var_start + var.length() - flag.length() + 1, 
-                                  var_end - var_start - var.length() + flag.length() - 1);
-            section.erase(var_start, var_end - var_start + flag.length() + 1);
-            fill_start = section.find(var);
-            if (fill_start != std::string::npos) {
-                fill_end = section.find(flag, fill_start + 1);
-                section.replace(fill_start, fill_end - fill_start + flag.length(), fill);
-            } 
-            #if DEBUG_SHADER_BUILDER_SHOW_UNUSED_VARS
-                else std::cout << "ERROR::SHADER::UNUSED_VARIABLE: Variable \"" << var << "\" defined but not used." << std::endl;
-            #endif
-        } else {
-            var += '\n';
-            if (!p_hasKey(section, var)) {
-                std::cout << "ERROR::SHADER::MISSING_DEFINITION: Variable \"" << var.substr(0, var.length() - flag.length()) 
-                    << flag << "\" undefined." << std::endl;
-                break;
-            }
-            fill_start = section.find(var), fill_end = section.find(flag, fill_start + 1);
-            fill = section.substr(fill_start + var.length(), fill_end - fill_start - var.length());
-            section.replace(var_start, var_end - var_start + flag.length(), fill);
-            size_t l = fill_end - fill_start + flag.length() + 1;
-            fill_start += (var_start < fill_start) ? fill.length() - var_end + var_start - flag.length() : 0;
-            section.erase(fill_start, l);
-        }
-    }
+bool Shader::assembleSource(std::string& source, const std::vector<const ShaderTemplate::Block*>& components) {
+    return ShaderTemplate::get().assemble(source, components);
 }
 
 
@@ -478,6 +564,8 @@ void Shader::print() const {
     case R_BASIC_3D: { std::cout << "Basic 3D"; } break;
     case R_LIGHTING_3D: { std::cout << "Lighting 3D"; } break;
     case R_SKYBOX: { std::cout << "Skybox"; } break;
+    case R_GBUFFER_3D: { std::cout << "G-Buffer 3D"; } break;
+    case R_DEFERRED_LIGHTING: { std::cout << "Deferred Lighting"; } break;
     }
     std::cout << std::endl;
     std::cout << "Texture Style (" << texture_style << "):\t";
@@ -485,6 +573,7 @@ void Shader::print() const {
     case T_DISABLED: { std::cout << "Texture Disabled"; } break;
     case T_BASIC_2D: { std::cout << "Basic 2D"; } break;
     case T_CUBE: { std::cout << "Cube"; } break;
+    case T_ARRAY_2D: { std::cout << "2D Array"; } break;
     }
     std::cout << std::endl;
     std::cout << "Material Style (" << material_style << "):\t";
@@ -494,6 +583,7 @@ void Shader::print() const {
     case M_D_MAP: { std::cout << "D Map"; } break;
     case M_DS_MAP: { std::cout << "DS Map"; } break;
     case M_DSE_MAP: { std::cout << "DSE Map"; } break;
+    case M_UBER: { std::cout << "Uber Material"; } break;
     }
     std::cout << std::endl;
     std::cout << "Lighting Style (" << lighting_style << "):\t";
@@ -0,0 +1,247 @@
+#include "gui/shader_template.hpp"
+
+#if EMBED_SHADER_COMPONENTS
+    #include "gui/shader_components.hpp"
+#endif
+
+// structural keys open each section of a block, the section runs until the next '@' (in the order the sections appear in the source)
+static const std::string SECTION_KEYS[N_SHADER_SECTIONS] = { "@GLOBAL\n", "@STRUCTS\n", "@IN\n", "@OUT\n", "@UNIFORMS\n", "@FUNCTIONS\n",
+                                                             "@MAIN\n" };
+// blocks are closed by the block flag
+static const std::string BLOCK_FLAG = "@@";
+
+/* Split text into tokens at each pair of flags. The text between two flags is a definition if it has a line break (the name comes before
+ * the line break, the replacement text after it) and a reference otherwise. A definition is erased along with the character that follows
+ * it (usually its line break), so that character is left out of the text after it. Returns false if the text can't be split this way (an
+ * unpaired flag, flags that run into each other or a definition that isn't followed by plain text).
+ */
+static bool tokenize(const std::string_view text, const std::string_view flag, std::vector<ShaderTemplate::Token>& tokens) {
+    size_t pos = 0;
+    while (pos < text.length()) {
+        size_t open = text.find(flag, pos);
+        if (open == std::string_view::npos) break;
+        size_t close = text.find(flag, open + 1);
+        if (close == std::string_view::npos || close < open + flag.length()) return false;
+
+        if (open > pos) tokens.push_back({ ShaderTemplate::TOKEN_TEXT, {}, text.substr(pos, open - pos) });
+        std::string_view contents = text.substr(open + flag.length(), close - open - flag.length());
+        pos = close + flag.length();
+        size_t lineBreak = contents.find('\n');
+        if (lineBreak == std::string_view::npos) {
+            if (contents.empty()) return false;
+            tokens.push_back({ ShaderTemplate::TOKEN_REFERENCE, contents, {} });
+        } else {
+            if (lineBreak == 0 || pos >= text.length() || text[pos] == '&') return false;
+            tokens.push_back({ ShaderTemplate::TOKEN_DEFINITION, contents.substr(0, lineBreak), contents.substr(lineBreak + 1) });
+            pos++;
+        }
+    }
+    if (pos < text.length()) tokens.push_back({ ShaderTemplate::TOKEN_TEXT, {}, text.substr(pos) });
+    return true;
+}
+/* Match the references of a list of tokens to definitions, the same way they would be matched by splicing them in from the first flag to
+ * the last: a reference takes the first definition of its name that hasn't been used, and a definition that comes first goes to the next
+ * reference of its name. Each definition is used at most once. bindings[t] is set to the definition used by each reference (nullptr for
+ * other tokens). Returns false (and reports the reference) if a reference has no definition.
+ */
+static bool bindReferences(const std::vector<const ShaderTemplate::Token*>& tokens, const std::string_view flag,
+                           std::vector<const ShaderTemplate::Token*>& bindings, std::vector<std::string_view>& unused) {
+    struct Placeholder {
+        std::vector<unsigned int> definitions, references;
+        unsigned int nextDefinition = 0, nextReference = 0;
+    };
+    std::unordered_map<std::string_view, Placeholder> placeholders;
+    for (unsigned int t = 0; t < tokens.size(); t++) {
+        if (tokens[t]->type == ShaderTemplate::TOKEN_DEFINITION) placeholders[tokens[t]->name].definitions.push_back(t);
+        else if (tokens[t]->type == ShaderTemplate::TOKEN_REFERENCE) placeholders[tokens[t]->name].references.push_back(t);
+    }
+
+    bindings.assign(tokens.size(), nullptr);
+    std::vector<bool> used(tokens.size(), false);
+    for (unsigned int t = 0; t < tokens.size(); t++) {
+        const ShaderTemplate::Token& token = *tokens[t];
+        if (token.type == ShaderTemplate::TOKEN_TEXT || used[t] || bindings[t] != nullptr) continue;
+        Placeholder& placeholder = placeholders[token.name];
+        if (token.type == ShaderTemplate::TOKEN_DEFINITION) {
+            placeholder.nextDefinition++;
+            if (placeholder.nextReference < placeholder.references.size())
+                bindings[placeholder.references[placeholder.nextReference++]] = &token;
+            else unused.push_back(token.name);
+        } else {
+            if (placeholder.nextDefinition >= placeholder.definitions.size()) {
+                // this is critical because the shader code is unlikely to compile if placeholders are not replaced
+                std::cout << "ERROR::SHADER::MISSING_DEFINITION: Variable \"" << flag << token.name << flag << "\" undefined." << std::endl;
+                return false;
+            }
+            unsigned int d = placeholder.definitions[placeholder.nextDefinition++];
+            used[d] = true;
+            bindings[t] = tokens[d];
+            placeholder.nextReference++;
+        }
+    }
+    return true;
+}
+
+ShaderTemplate::ShaderTemplate() {
+    // files are added in order of name, so that the hash doesn't depend on the order they are found in
+    std::vector<std::pair<std::string, std::string>> files;
+    #if EMBED_SHADER_COMPONENTS
+        for (const auto& component : EMBEDDED_COMPONENTS) files.push_back({ component[0], component[1] });
+    #else
+        // every component file is read once (comment blocks are stripped as they are read)
+        if (!std::filesystem::is_directory(SHADER_COMPONENTS_PATH)) {
+            std::cout << "ERROR::SHADER_TEMPLATE::MISSING_COMPONENTS: No component files found at " << SHADER_COMPONENTS_PATH << "."
+                << std::endl;
+            return;
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(SHADER_COMPONENTS_PATH)) {
+            if (entry.path().extension() != ".glsl") continue;
+            std::string text;
+            files.push_back({ entry.path().filename().string(), f_readText(entry.path().string(), text) });
+        }
+    #endif
+    std::sort(files.begin(), files.end());
+
+    std::string contents;
+    for (const auto& [fileName, text] : files) {
+        addComponent(fileName, text);
+        contents += fileName + '\n' + text;
+    }
+    hash = (uint64_t) std::hash<std::string>()(contents);
+}
+
+const ShaderTemplate& ShaderTemplate::get() {
+    static ShaderTemplate shaderTemplate;
+    return shaderTemplate;
+}
+
+const ShaderTemplate::Block* ShaderTemplate::getBlock(const std::string& fileName, const std::string& key) const {
+    auto c = components.find(fileName);
+    if (c == components.end()) {
+        std::cout << "ERROR::SHADER_TEMPLATE::MISSING_COMPONENT: No component file named " << fileName << "." << std::endl;
+        return nullptr;
+    }
+    auto b = c->second.find(key);
+    return (b == c->second.end()) ? nullptr : b->second.get();
+}
+
+void ShaderTemplate::addComponent(const std::string& fileName, const std::string& text) {
+    std::unordered_map<std::string, std::unique_ptr<Block>>& blocks = components[fileName];
+    // anything before the first block is kept under the empty key
+    size_t open = text.find(BLOCK_FLAG);
+    addBlock(blocks.emplace("", std::make_unique<Block>()).first->second.get(), text.substr(0, open), fileName);
+    while (open != std::string::npos) {
+        // a block's key is the block flag followed by a name, and the block runs until the next block flag
+        size_t start = open + BLOCK_FLAG.length();
+        while (start < text.length() && (std::isalnum((unsigned char) text[start]) || text[start] == '_')) start++;
+        std::string key = text.substr(open, start - open);
+        size_t end = text.find(BLOCK_FLAG, start);
+        // if a key appears twice, the first block is kept
+        if (blocks.find(key) == blocks.end())
+            addBlock(blocks.emplace(key, std::make_unique<Block>()).first->second.get(),
+                     text.substr(start, (end == std::string::npos) ? std::string::npos : end - start), fileName + key);
+        if (end == std::string::npos) break;
+        // the block flag that closes a block is followed by the key of the next
+        open = text.find(BLOCK_FLAG, end + BLOCK_FLAG.length());
+    }
+}
+void ShaderTemplate::addBlock(Block* block, const std::string& text, const std::string& name) {
+    block->text = text;
+    // a section runs from its key to the next '@', and a block may add to the same section more than once
+    const std::string_view blockText = block->text;
+    for (unsigned int s = 0; s < N_SHADER_SECTIONS; s++) {
+        size_t c = blockText.find(SECTION_KEYS[s]);
+        while (c != std::string_view::npos) {
+            size_t sectionStart = c + SECTION_KEYS[s].length(), sectionEnd = blockText.find('@', sectionStart);
+            if (sectionEnd == std::string_view::npos) {
+                std::cout << "ERROR::SHADER_TEMPLATE::UNCLOSED_SECTION: Section \"" << SECTION_KEYS[s].substr(0, SECTION_KEYS[s].length() - 1)
+                    << "\" in " << name << " is never closed." << std::endl;
+                sectionEnd = blockText.length();
+            }
+            Section& section = block->sections[s].emplace_back();
+            section.text = blockText.substr(sectionStart, sectionEnd - sectionStart);
+            section.regular = tokenize(section.text, "&&", section.tokens);
+            if (!section.regular)
+                std::cout << "ERROR::SHADER_TEMPLATE::MALFORMED_PLACEHOLDER: Section \""
+                    << SECTION_KEYS[s].substr(0, SECTION_KEYS[s].length() - 1) << "\" in " << name
+                    << " has a placeholder whose flags can't be paired." << std::endl;
+            c = blockText.find(SECTION_KEYS[s], c + 1);
+        }
+    }
+}
+
+bool ShaderTemplate::assemble(std::string& source, const std::vector<const Block*>& blocks) const {
+    // filling placeholders only moves text around and erases it, so the source is never longer than the text of its blocks
+    size_t length = source.length();
+    for (const Block* block : blocks) length += block->text.length() + N_SHADER_SECTIONS;
+    source.reserve(length);
+
+    bool filled = true;
+    for (unsigned int s = 0; s < N_SHADER_SECTIONS; s++) {
+        // each section that isn't empty starts on a new line
+        size_t start = source.length();
+        source += '\n';
+        filled = fillSection(source, blocks, s) && filled;
+        if (source.length() == start + 1) source.resize(start);
+    }
+    return filled;
+}
+
+bool ShaderTemplate::fillSection(std::string& source, const std::vector<const Block*>& blocks, const unsigned int s) const {
+    // a section that can't be filled is written as it is, so that the compile errors show the placeholders that were left
+    auto writeUnfilled = [&]() {
+        for (const Block* block : blocks) for (const Section& section : block->sections[s]) source += section.text;
+        return false;
+    };
+    auto reportMalformed = [&]() {
+        std::cout << "ERROR::SHADER_TEMPLATE::MALFORMED_PLACEHOLDER: Section \"" << SECTION_KEYS[s].substr(0, SECTION_KEYS[s].length() - 1)
+            << "\" has a placeholder whose flags can't be paired." << std::endl;
+        return writeUnfilled();
+    };
+
+    // gather the "&&" tokens of the section from every block (malformed sections were already reported when their block was read, flags
+    // that only meet where two blocks join are reported now)
+    std::vector<const Token*> tokens;
+    size_t length = 0;
+    char last = '\0';
+    for (const Block* block : blocks) for (const Section& section : block->sections[s]) {
+        if (!section.regular) return writeUnfilled();
+        if (last == '&' && !section.text.empty() && section.text.front() == '&') return reportMalformed();
+        for (const Token& token : section.tokens) tokens.push_back(&token);
+        length += section.text.length();
+        if (!section.text.empty()) last = section.text.back();
+    }
+
+    // write the section with each "&&" reference replaced by its definition
+    std::vector<const Token*> bindings;
+    std::vector<std::string_view> unused;
+    if (!bindReferences(tokens, "&&", bindings, unused)) return writeUnfilled();
+    std::string text;
+    text.reserve(length);
+    for (unsigned int t = 0; t < tokens.size(); t++) {
+        if (tokens[t]->type == TOKEN_TEXT) text += tokens[t]->text;
+        else if (tokens[t]->type == TOKEN_REFERENCE) text += bindings[t]->text;
+    }
+
+    // then replace each '&' reference (these are only tokenized now, since a '&' definition can be made of "&&" references, see
+    // f_postprocessing.glsl)
+    std::vector<Token> innerTokens;
+    if (text.find("&&") != std::string::npos || !tokenize(text, "&", innerTokens)) return reportMalformed();
+    std::vector<const Token*> innerPointers, innerBindings;
+    std::vector<std::string_view> innerUnused;
+    for (const Token& token : innerTokens) innerPointers.push_back(&token);
+    if (!bindReferences(innerPointers, "&", innerBindings, innerUnused)) return writeUnfilled();
+    for (unsigned int t = 0; t < innerTokens.size(); t++) {
+        if (innerTokens[t].type == TOKEN_TEXT) source += innerTokens[t].text;
+        else if (innerTokens[t].type == TOKEN_REFERENCE) source += innerBindings[t]->text;
+    }
+
+    #if DEBUG_SHADER_BUILDER_SHOW_UNUSED_VARS
+        // this is not necessarily an error (because the replacement text still gets deleted), but may not be intended
+        for (std::string_view name : unused)
+            std::cout << "ERROR::SHADER::UNUSED_VARIABLE: Variable \"&&" << name << "&&\" defined but not used." << std::endl;
+        for (std::string_view name : innerUnused)
+            std::cout << "ERROR::SHADER::UNUSED_VARIABLE: Variable \"&" << name << "&\" defined but not used." << std::endl;
+    #endif
+    return true;
+}
@@ -1,5 +1,8 @@
 #include "gui/texture.hpp"
 
+#include <cstring>
+#include <filesystem>
+
 std::string TEXTURE_PATH = "../res/textures/";
 std::string BASIC_PATH = "basic/";
 std::string CUBE_MAP_PATH = "cubemaps/";
@@ -10,6 +13,301 @@ const unsigned int COLOR_FORMAT[] {0, GL_DEPTH_COMPONENT, 0, GL_RGB, GL_RGBA};
 // for now, only handles 2D textures
 const unsigned int DEFAULT_TYPE = GL_TEXTURE_2D;
 
+// the minification filter depends on both the filter and the mipmap type (e.g. linear filter with nearest mipmap)
+static unsigned int getMinFilter(const unsigned int filter, const unsigned int mipmap) {
+    switch(mipmap) {
+    case MIPMAP_LINEAR: return (filter == GL_LINEAR) ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR;
+    case MIPMAP_NEAREST: return (filter == GL_LINEAR) ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST;
+    default: return filter;
+    }
+}
+
+// the image files a texture is read from, by texture format
+static std::vector<std::string> getFilePaths(const unsigned int textureFormat, const std::string& fileName, const std::string& extn) {
+    std::vector<std::string> filePaths;
+    switch(textureFormat) {
+    case TEXTURE_2D: {
+        // ../res/textures/basic/(fileName).(extension)
+        filePaths.push_back(TEXTURE_PATH + BASIC_PATH + fileName + extn);
+    } break;
+    case TEXTURE_CUBE: {
+        // cube maps require 6 image files (one for each face)
+        // ../res/textures/cubemaps/(fileName)/(front, back, right, etc.).(extension)
+        for (int i = 0; i < 6; i++) filePaths.push_back(TEXTURE_PATH + CUBE_MAP_PATH + fileName + "/" + CUBE_MAP_PATHS[i] + extn);
+    } break;
+    }
+    return filePaths;
+}
+
+TextureImage::TextureImage(const unsigned int textureFormat, const std::vector<std::string>& filePaths, const bool mipmapped) 
+        : textureFormat(textureFormat), mipmapped(mipmapped) {
+    textureType = (textureFormat == TEXTURE_CUBE) ? T_CUBE : T_BASIC_2D;
+
+    // generate a texture object in the OpenGL context save the id
+    glGenTextures(1, &textureID);
+    #if DEBUG_OPENGL_OBJECTS
+        std::cout << "Texture Image " << textureID << " was created." << std::endl;
+    #endif
+
+    // until the files are uploaded, every face holds a single grey texel
+    const unsigned char placeholder[] = { 128, 128, 128, 255 };
+    glBindTexture(textureFormat, textureID);
+    for (int i = 0; i < filePaths.size(); i++) {
+        unsigned int format = (textureFormat == TEXTURE_CUBE) ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + i : textureFormat;
+        glTexImage2D(format, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+    }
+    glBindTexture(textureFormat, 0);
+
+    // the files are read by a worker (never by the main thread, even while it waits on the jobs of a frame), and the texture cache uploads
+    // them once they are decoded
+    JobSystem::get().submitBackground([this, filePaths]() { decode(filePaths); }, &decoded);
+}
+TextureImage::~TextureImage() {
+    // the decoding job writes to the image, so it has to finish first
+    wait();
+    for (Face& face : faces) if (face.data != nullptr) stbi_image_free(face.data);
+
+    glDeleteTextures(1, &textureID);
+    #if DEBUG_OPENGL_OBJECTS 
+        std::cout << "Texture Image " << textureID << " was deleted." << std::endl;
+    #endif
+}
+
+void TextureImage::decode(const std::vector<std::string> filePaths) {
+    // OpenGL considers (0, 0) to be the bottom left corner, but most image types considered (0, 0) to be the top left corner, so flip
+    // (but for some reason OpenGL changes its mind for cube maps). Workers decode several images at once, so the setting is per thread.
+    stbi_set_flip_vertically_on_load_thread(textureFormat != TEXTURE_CUBE);
+
+    faces.resize(filePaths.size());
+    for (int i = 0; i < filePaths.size(); i++) {
+        Face& face = faces[i];
+        // load image data from file
+        face.data = stbi_load(filePaths[i].c_str(), &face.width, &face.height, &face.nChannels, 0);
+        if (face.data != nullptr) {
+            width = face.width;
+            height = face.height;
+            nChannels = face.nChannels;
+        } else {
+            // if data is null, then file was not read correctly, throw error
+            std::cout << "\nError: Failed to load texture" << std::endl;
+            std::cout << filePaths[i] << ": " << stbi_failure_reason() << std::endl;
+        }
+    }
+}
+
+size_t TextureImage::getDataSize() const {
+    size_t size = 0;
+    for (const Face& face : faces) if (face.data != nullptr) size += face.size();
+    return size;
+}
+
+void TextureImage::upload(const std::vector<const void*>& sources) {
+    glBindTexture(textureFormat, textureID);
+
+    // generate a texture for each file, but all associated with the same openGL texture object
+    for (int i = 0; i < faces.size(); i++) {
+        Face& face = faces[i];
+        if (face.data == nullptr) continue;
+        unsigned int format;
+        // set the texture format value
+        switch(textureFormat) {
+        case TEXTURE_CUBE: { format = GL_TEXTURE_CUBE_MAP_POSITIVE_X + i; } break;  // openGL uses 6 separate formats for each face
+        default: { format = textureFormat; } break;
+        }
+        // load the image data and information about its format to the OpenGL texture object and then free the data
+        glTexImage2D(format, 0, COLOR_FORMAT[face.nChannels], face.width, face.height, 0, COLOR_FORMAT[face.nChannels], GL_UNSIGNED_BYTE, 
+                     sources[i]);
+        stbi_image_free(face.data);
+        face.data = nullptr;
+    }
+    if (mipmapped) glGenerateMipmap(textureFormat);
+
+    glBindTexture(textureFormat, 0);
+    resident = true;
+}
+
+Sampler::Sampler(const unsigned int filter, const unsigned int wrapper, const unsigned int mipmap, const std::array<float, 4>& borderColor) {
+    glGenSamplers(1, &samplerID);
+    #if DEBUG_OPENGL_OBJECTS 
+        std::cout << "Sampler " << samplerID << " was created." << std::endl;
+    #endif
+
+    // the same parameters that a texture sets on itself (see Texture::setFilter() and Texture::setWrapper())
+    if (filter) {
+        glSamplerParameteri(samplerID, GL_TEXTURE_MIN_FILTER, getMinFilter(filter, mipmap));
+        glSamplerParameteri(samplerID, GL_TEXTURE_MAG_FILTER, filter);
+    }
+    if (wrapper) {
+        // the R wrapper only applies to cube maps, and is ignored by 2D textures
+        glSamplerParameteri(samplerID, GL_TEXTURE_WRAP_S, wrapper);
+        glSamplerParameteri(samplerID, GL_TEXTURE_WRAP_T, wrapper);
+        glSamplerParameteri(samplerID, GL_TEXTURE_WRAP_R, wrapper);
+    }
+    glSamplerParameterfv(samplerID, GL_TEXTURE_BORDER_COLOR, borderColor.data());
+}
+Sampler::~Sampler() {
+    glDeleteSamplers(1, &samplerID);
+    #if DEBUG_OPENGL_OBJECTS 
+        std::cout << "Sampler " << samplerID << " was deleted." << std::endl;
+    #endif
+}
+
+TextureCache& TextureCache::get() {
+    static TextureCache textureCache;
+    return textureCache;
+}
+
+std::shared_ptr<const TextureImage> TextureCache::getImage(const unsigned int textureFormat, const std::string& fileName, 
+                                                           const std::string& extn, const bool mipmapped) {
+    std::vector<std::string> filePaths = getFilePaths(textureFormat, fileName, extn);
+
+    // the key names every file and when it was last written, so an edited file doesn't match the image read from the old one
+    std::string key = std::to_string(textureFormat) + (mipmapped ? ":mipmapped" : "");
+    for (const std::string& filePath : filePaths) {
+        std::error_code error;
+        auto writeTime = std::filesystem::last_write_time(filePath, error);
+        key += ":" + filePath + "@" + (error ? "?" : std::to_string(writeTime.time_since_epoch().count()));
+    }
+
+    std::shared_ptr<TextureImage> image = images[key].lock();
+    if (image != nullptr) {
+        imageHits++;
+        return image;
+    }
+    image = std::make_shared<TextureImage>(textureFormat, filePaths, mipmapped);
+    images[key] = image;
+    uploads.push_back(image);
+    imageLoads++;
+    return image;
+}
+
+std::shared_ptr<const Sampler> TextureCache::getSampler(const unsigned int filter, const unsigned int wrapper, const unsigned int mipmap,
+                                                        const std::array<float, 4>& borderColor) {
+    std::weak_ptr<const Sampler>& entry = samplers[{ filter, wrapper, mipmap, borderColor }];
+    std::shared_ptr<const Sampler> sampler = entry.lock();
+    if (sampler != nullptr) {
+        samplerHits++;
+        return sampler;
+    }
+    sampler = std::make_shared<const Sampler>(filter, wrapper, mipmap, borderColor);
+    entry = sampler;
+    samplerLoads++;
+    return sampler;
+}
+
+void TextureCache::upload() {
+    if (uploads.empty()) return;
+    uploadBatch(TEXTURE_UPLOAD_BUDGET);
+}
+void TextureCache::finishUploads() {
+    for (std::weak_ptr<TextureImage>& entry : uploads) {
+        std::shared_ptr<TextureImage> image = entry.lock();
+        if (image != nullptr) image->wait();
+    }
+    // every image is decoded, so each batch uploads something until the queue is empty (or waits for a region to be free)
+    while (!uploads.empty()) {
+        if (!uploadBatch(TEXTURE_UPLOAD_BUDGET)) {
+            GLsync fence = fences[region];
+            if (fence == nullptr) break;
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        }
+    }
+}
+
+void TextureCache::createPixelBuffer() {
+    glGenBuffers(1, &pixelBufferID);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBufferID);
+    if (r_HasBufferStorage()) {
+        // storage that stays mapped while OpenGL reads from it, the fences keep the two from touching the same region
+        unsigned int flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        r_glBufferStorage(GL_PIXEL_UNPACK_BUFFER, TEXTURE_UPLOAD_BUDGET * N_UPLOAD_REGIONS, NULL, flags);
+        mapped = (unsigned char*) glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, TEXTURE_UPLOAD_BUDGET * N_UPLOAD_REGIONS, flags);
+    } else glBufferData(GL_PIXEL_UNPACK_BUFFER, TEXTURE_UPLOAD_BUDGET * N_UPLOAD_REGIONS, NULL, GL_STREAM_DRAW);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+bool TextureCache::uploadBatch(const size_t size) {
+    // the region is free once OpenGL has read the last batch written to it, otherwise try again next frame
+    GLsync& fence = fences[region];
+    if (fence != nullptr) {
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) return false;
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    // take decoded images in order until the region is full (images that are still decoding keep their place in the queue)
+    std::vector<std::shared_ptr<TextureImage>> batch;
+    size_t batchSize = 0;
+    for (auto entry = uploads.begin(); entry != uploads.end();) {
+        std::shared_ptr<TextureImage> image = entry->lock();
+        if (image == nullptr) {
+            entry = uploads.erase(entry);
+            continue;
+        }
+        if (!image->isDecoded()) {
+            entry++;
+            continue;
+        }
+        size_t imageSize = image->getDataSize();
+        if (imageSize > size) {
+            // an image that doesn't fit in a region at all is uploaded straight from memory, as the only upload of the frame
+            if (!batch.empty()) break;
+            std::vector<const void*> sources;
+            for (TextureImage::Face& face : image->faces) sources.push_back(face.data);
+            image->upload(sources);
+            uploads.erase(entry);
+            return true;
+        }
+        if (batchSize + imageSize > size) break;
+        batch.push_back(image);
+        // keep each image aligned in the buffer
+        batchSize += (imageSize + 15) & ~(size_t) 15;
+        entry = uploads.erase(entry);
+    }
+    if (batch.empty()) return false;
+
+    if (pixelBufferID == 0) createPixelBuffer();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBufferID);
+    size_t base = region * TEXTURE_UPLOAD_BUDGET;
+    unsigned char* destination = mapped;
+    if (mapped != nullptr) destination += base;
+    else {
+        // nothing is reading the region (the fence says so), so it can be mapped without synchronizing
+        unsigned int access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        destination = (unsigned char*) glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, base, batchSize, access);
+    }
+
+    // copy every face into the region, then have OpenGL read each from its offset
+    std::vector<std::vector<const void*>> sources(batch.size());
+    size_t offset = 0;
+    for (int i = 0; i < batch.size(); i++) {
+        size_t imageOffset = offset;
+        for (TextureImage::Face& face : batch[i]->faces) {
+            sources[i].push_back((const void*) (base + offset));
+            if (face.data == nullptr) continue;
+            std::memcpy(destination + offset, face.data, face.size());
+            offset += face.size();
+        }
+        offset = imageOffset + ((batch[i]->getDataSize() + 15) & ~(size_t) 15);
+    }
+    if (mapped == nullptr) glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    for (int i = 0; i < batch.size(); i++) batch[i]->upload(sources[i]);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // the next batch uses the next region, this one is free again once OpenGL has read it
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    region = (region + 1) % N_UPLOAD_REGIONS;
+    return true;
+}
+
+void TextureCache::print() const {
+    unsigned int nImages = 0, nSamplers = 0;
+    for (auto& [key, image] : images) if (!image.expired()) nImages++;
+    for (auto& [key, sampler] : samplers) if (!sampler.expired()) nSamplers++;
+    std::cout << "Texture cache: " << nImages << " images in use (" << imageLoads << " loaded, " << imageHits << " shared), " <<
+                 nSamplers << " samplers in use (" << samplerLoads << " created, " << samplerHits << " shared)" << std::endl;
+}
+
 Texture::Texture(const unsigned int textureFormat, const int width, const int height, const unsigned int component,
                  const unsigned int filter, const unsigned int wrapper, const unsigned int mipmap) 
             : textureFormat(textureFormat), slot(0), width(width), height(height) {
@@ -17,7 +315,8 @@ Texture::Texture(const unsigned int textureFormat, const int width, const int he
     switch(component) {
     case DEPTH_BUFFER: { nChannels = 1; } break;
     case COLOR_BUFFER: { nChannels = 3; } break;
-    case ALPHA_BUFFER: { nChannels = 4; } break;
+    case ALPHA_BUFFER: 
+    case FLOAT_BUFFER: { nChannels = 4; } break;
     }
 
     // generate a texture object in the OpenGL context save the id
@@ -38,7 +337,9 @@ Texture::Texture(const unsigned int textureFormat, const int width, const int he
     } break;
     // otherwise, call the normal 2D texture function
     default: { 
-        glTexImage2D(textureFormat, 0, component, width, height, 0, component, GL_UNSIGNED_BYTE, NULL); 
+        // float buffers have a sized internal format, so the (unused) pixel data format needs to be given separately
+        if (component == FLOAT_BUFFER) glTexImage2D(textureFormat, 0, component, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+        else glTexImage2D(textureFormat, 0, component, width, height, 0, component, GL_UNSIGNED_BYTE, NULL); 
         textureType = T_CUBE;
     } break;
     }
@@ -56,74 +357,17 @@ Texture::Texture(const unsigned int textureFormat, const std::string file_name,
         : Texture(textureFormat, file_name, extn, filter, wrapper, mipmap, 0) {}
 Texture::Texture(const unsigned int textureFormat, const std::string file_name, const std::string extn, 
                  const unsigned int filter, const unsigned int wrapper, const unsigned int mipmap, 
-                 const int slot) {
-    this->textureFormat = textureFormat;
-    this->file_name = file_name;
-    this->extension = extn;
-    this->slot = slot;
-    // add the texture directory path to the file name (each format has its own filepath)
-    
-    std::vector<std::string> filePaths;
-    switch(textureFormat) {
-    case TEXTURE_2D: {
-        // ../res/textures/basic/(fileName).(extension)
-        std::string file_path = TEXTURE_PATH + BASIC_PATH + file_name + extn;
-        filePaths.push_back(file_path);
-        textureType = T_BASIC_2D;
-    } break;
-    case TEXTURE_CUBE: {
-        // cube maps require 6 image files (one for each face)
-        for (int i = 0; i < 6; i++) {
-            // ../res/textures/cubemaps/(fileName)/(front, back, right, etc.).(extension)
-            std::string file_path = TEXTURE_PATH + CUBE_MAP_PATH + file_name + "/" + CUBE_MAP_PATHS[i] + extn;
-            filePaths.push_back(file_path);
-        }
-
-        textureType = T_CUBE;
-    } break;
-    }
-
-    // OpenGL considers (0, 0) to be the bottom left corner, but most image types considered (0, 0) to be the top left corner, so flip
-    if (textureFormat == TEXTURE_CUBE) stbi_set_flip_vertically_on_load(false); // but for some reason OpenGL changes its mind for cube maps
-    else stbi_set_flip_vertically_on_load(true);
-
-    // generate a texture object in the OpenGL context save the id
-    glGenTextures(1, &textureID);
-    #if DEBUG_OPENGL_OBJECTS
-        std::cout << "Texture " << textureID << " was created." << std::endl;
-    #endif
+                 const int slot) 
+        : textureFormat(textureFormat), file_name(file_name), extension(extn), slot(slot), filter(filter), wrapper(wrapper), 
+          mipmap(mipmap) {
+    // the image data and sampling parameters are shared with every other texture made from the same file (see TextureCache)
+    image = TextureCache::get().getImage(textureFormat, file_name, extn, mipmap != 0);
+    sampler = TextureCache::get().getSampler(filter, wrapper, mipmap, borderColor);
 
-    // bind the texture to the context
-    glBindTexture(textureFormat, textureID);
-
-    // generate a texture for each file, but all associated with the same openGL texture object
-    for (int i = 0; i < filePaths.size(); i++) {
-        // load image data from file
-        unsigned char* data = stbi_load(filePaths[i].c_str(), &width, &height, &nChannels, 0);
-        if (data != nullptr) {
-            unsigned int format;
-            // set the texture format value
-            switch(textureFormat) {
-            case TEXTURE_CUBE: { format = GL_TEXTURE_CUBE_MAP_POSITIVE_X + i; } break;  // openGL uses 6 separate formats for each face
-            default: { format = textureFormat; } break;
-            }
-            // load the image data and information about its format to the OpenGL texture object and then free the data
-            glTexImage2D(format, 0, COLOR_FORMAT[nChannels], width, height, 0, COLOR_FORMAT[nChannels], GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        } else {    
-            // if data is null, then file was not read correctly, throw error
-            std::cout << "\nError: Failed to load texture" << std::endl;
-            std::cout << stbi_failure_reason() << std::endl;
-        }
-    }
-
-    // set texture parameters
-    if (mipmap) createMipmap(mipmap);
-    if (filter) setFilter(filter);
-    if (wrapper) setWrapper(wrapper);
-
-    // unbind the texture
-    glBindTexture(textureFormat, 0);
+    textureID = image->getID();
+    textureType = image->getType();
+    // the size and format belong to the image, which may still be decoding
+    width = height = nChannels = 0;
 }
 Texture::Texture(Serializer object) 
     : Texture(static_cast<unsigned int>(object["texture_format"]), 
@@ -131,6 +375,8 @@ Texture::Texture(Serializer object)
               static_cast<unsigned int>(object["filter"]), static_cast<unsigned int>(object["wrapper"]),
               static_cast<unsigned int>(object["mipmap"])) {}
 Texture::~Texture() {
+    // textures made from a file share their image, which is deleted once it is no longer used by any texture
+    if (!file_name.empty()) return;
     // When the texture is deleted, make sure it is also deleted from the openGL context
     glDeleteTextures(1, &textureID);
     #if DEBUG_OPENGL_OBJECTS 
@@ -138,9 +384,20 @@ Texture::~Texture() {
     #endif
 }
 
+void Texture::releaseImage() {
+    if (image == nullptr) return;
+    width = image->getWidth();
+    height = image->getHeight();
+    nChannels = image->getChannels();
+    image = nullptr;
+    sampler = nullptr;
+    textureID = 0;
+}
+
 bool Texture::operator==(const Texture& other) const {
     return textureFormat == other.textureFormat && file_name == other.file_name && extension == other.extension &&
-           width == other.width && height == other.height && nChannels == other.nChannels && mipmap == other.mipmap &&
+           getWidth() == other.getWidth() && getHeight() == other.getHeight() && getChannels() == other.getChannels() && 
+           mipmap == other.mipmap &&
            filter == other.filter && wrapper == other.wrapper;
 }
 bool Texture::operator!=(const Texture& other) const { return !operator==(other); }
@@ -149,10 +406,20 @@ void Texture::bind() const {
     // Rather than setting a texture uniform, textures are fed to shaders by making them "active" with a numerical slot identifier
     glActiveTexture(GL_TEXTURE0 + slot);
     glBindTexture(textureFormat, textureID);
+    // a sampler left on the slot would override the texture's own parameters, so textures without one clear it
+    glBindSampler(slot, (sampler != nullptr) ? sampler->getID() : 0);
 }
 inline void Texture::unbind() const { glBindTexture(textureFormat, 0); } 
 
 void Texture::createMipmap(const unsigned int value) {
+    // shared images can't be changed, so a texture made from a file switches to the mipmapped image of the file (and a matching sampler)
+    if (image != nullptr) {
+        mipmap = value;
+        if (!image->isMipmapped()) image = TextureCache::get().getImage(textureFormat, file_name, extension, true);
+        textureID = image->getID();
+        sampler = TextureCache::get().getSampler(filter, wrapper, mipmap, borderColor);
+        return;
+    }
     // generates a mipmap for a loaded texture and saves the parameter that should be used for it
     glGenerateMipmap(textureFormat);
     mipmap = value;
@@ -161,32 +428,11 @@ void Texture::setFilter(const unsigned int value) {
     ///NOTE: Uses the same parameter for both the min and mag filter, but doesn't necessarily have to
     // sets the minimization filter according to the input value and the existing mipmaptype value
     filter = value;
-
-    switch(mipmap) {
-    case MIPMAP_LINEAR:
-        switch(value) {
-        case GL_LINEAR:
-            setParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            break;
-        case GL_NEAREST:
-            setParameter(GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
-            break;
-        }
-        break;
-    case MIPMAP_NEAREST:
-        switch(value) {
-            case GL_LINEAR:
-            setParameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-            break;
-        case GL_NEAREST:
-            setParameter(GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-            break;
-        }
-        break;
-    default:
-        setParameter(GL_TEXTURE_MIN_FILTER, value);
-        break;
+    if (image != nullptr) {
+        sampler = TextureCache::get().getSampler(filter, wrapper, mipmap, borderColor);
+        return;
     }
+    setParameter(GL_TEXTURE_MIN_FILTER, getMinFilter(value, mipmap));
     // sets the magnification filter according to the input parameter
     setParameter(GL_TEXTURE_MAG_FILTER, value);
 }
@@ -194,11 +440,20 @@ void Texture::setWrapper(const unsigned int value) {
     ///NOTE: Sets the S (horizontal) and T (vertical) wrappers to be the same, but they don't have to be
     // sets both wrapper directions with the input parameter
     wrapper = value;
+    if (image != nullptr) {
+        sampler = TextureCache::get().getSampler(filter, wrapper, mipmap, borderColor);
+        return;
+    }
 
     setParameter(GL_TEXTURE_WRAP_S, value);
     setParameter(GL_TEXTURE_WRAP_T, value);
     if (textureFormat == TEXTURE_CUBE) setParameter(GL_TEXTURE_WRAP_R, value);
 }
+void Texture::setBorderColor(const float r, const float g, const float b, const float a) {
+    borderColor = { r, g, b, a };
+    if (image != nullptr) sampler = TextureCache::get().getSampler(filter, wrapper, mipmap, borderColor);
+    else setParameter(GL_TEXTURE_BORDER_COLOR, borderColor.data());
+}
 
 Serializer Texture::getJSON() const {
     Serializer object;
@@ -223,9 +478,11 @@ void Texture::print() {
     default: { std::cout << "Unrecognized type"; } break;
     }
     std::cout << std::endl;
-    std::cout << "Size: (" << width << " x " << height << ")" << std::endl;
-    std::cout << "# of channels: " << nChannels << std::endl;
+    std::cout << "Size: (" << getWidth() << " x " << getHeight() << ")" << std::endl;
+    std::cout << "# of channels: " << getChannels() << std::endl;
     std::cout << "Slot: " << slot << std::endl;
+    if (image != nullptr && !image->isResident()) std::cout << "Not uploaded yet" << std::endl;
+    if (image != nullptr) std::cout << "Shared by " << image.use_count() << " texture(s)" << std::endl;
     std::cout << "Mipmapping: ";
     switch(mipmap) {
     case 0:
@@ -246,6 +503,76 @@ void Texture::print() {
 }
 
 
+TextureArray::TextureArray(const std::vector<std::shared_ptr<const Texture>>& textures, const int slot) 
+        : width(textures[0]->getWidth()), height(textures[0]->getHeight()), nChannels(textures[0]->getChannels()), 
+          nLayers(textures.size()), slot(slot),
+          filter(textures[0]->getFilter()), wrapper(textures[0]->getWrapper()), mipmap(textures[0]->getMipmap()) {
+    unsigned int format = COLOR_FORMAT[nChannels];
+
+    glGenTextures(1, &textureID);
+    #if DEBUG_OPENGL_OBJECTS
+        std::cout << "Texture Array " << textureID << " was created." << std::endl;
+    #endif
+
+    // allocate every layer at once, then fill them one at a time
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, format, width, height, nLayers, 0, format, GL_UNSIGNED_BYTE, NULL);
+
+    // the layers are copied on the GPU from the images of the textures (which must be uploaded, see TextureCache::finishUploads()), by
+    // attaching each image to a read frame buffer
+    unsigned int readBuffer;
+    glGenFramebuffers(1, &readBuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readBuffer);
+    for (int l = 0; l < nLayers; l++) {
+        const Texture& texture = *textures[l];
+        if (texture.getWidth() != width || texture.getHeight() != height || texture.getChannels() != nChannels) {
+            std::cout << "ERROR::TEXTURE_ARRAY::FORMAT_MISMATCH: " << texture.getFileName() << texture.getExtension() << 
+                         " does not match the format of layer 0." << std::endl;
+            continue;
+        }
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.getID(), 0);
+        glCopyTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, l, 0, 0, width, height);
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &readBuffer);
+
+    // set texture parameters (the same as the textures that make up the array)
+    if (mipmap) glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    if (filter) {
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, getMinFilter(filter, mipmap));
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, filter);
+    }
+    if (wrapper) {
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrapper);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrapper);
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+TextureArray::~TextureArray() {
+    glDeleteTextures(1, &textureID);
+    #if DEBUG_OPENGL_OBJECTS
+        std::cout << "Texture Array " << textureID << " was deleted." << std::endl;
+    #endif
+}
+
+void TextureArray::bind() const {
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+    // the array's parameters are its own (see Texture::bind())
+    glBindSampler(slot, 0);
+}
+
+void TextureArray::print() const {
+    std::cout << "Address = " << this << std::endl;
+    std::cout << "ID = " << textureID << std::endl;
+    std::cout << "Size: (" << width << " x " << height << " x " << nLayers << ")" << std::endl;
+    std::cout << "# of channels: " << nChannels << std::endl;
+    std::cout << "Slot: " << slot << std::endl;
+    std::cout << std::endl;
+}
+
+
 TextureGroup::TextureGroup(Serializer& object) {
     nextSlot = object["first_slot"];
     for (int i = 0; i < object["textures"].size(); i++)
@@ -259,10 +586,55 @@ bool TextureGroup::operator==(TextureGroup& other) {
 }
 bool TextureGroup::operator==(Texture& other) { return textures.size() == 1 && *textures[0] == other; }
 
+unsigned int TextureGroup::getType() const {
+    if (textures.size() == 0) return T_DISABLED;
+    for (int t = 0; t < arrays.size(); t++) if (arrays[t] == nullptr) return getTexture()->getType();
+    return T_ARRAY_2D;
+}
+
 Serializer TextureGroup::getJSON() {
     Serializer object;
     object["first_slot"] = getSlot(0);
     for (int i = 0; i < textures.size(); i++) object["textures"][i] = std::move(getTexture(i)->getJSON());
 
     return object;
-}
\ No newline at end of file
+}
+
+TextureBuffer::TextureBuffer(const unsigned int internalFormat, const int slot) : internalFormat(internalFormat), slot(slot) {
+    // generate the buffer object that holds the data and the texture object that shaders read it through
+    glGenBuffers(1, &bufferID);
+    glGenTextures(1, &textureID);
+    #if DEBUG_OPENGL_OBJECTS 
+        std::cout << "Texture Buffer " << textureID << " was created." << std::endl;
+    #endif
+
+    // the texture refers to the buffer object rather than its data store, so it stays attached when the buffer is reallocated
+    setData(0, NULL);
+    glBindTexture(GL_TEXTURE_BUFFER, textureID);
+    glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, bufferID);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+TextureBuffer::~TextureBuffer() {
+    glDeleteTextures(1, &textureID);
+    glDeleteBuffers(1, &bufferID);
+    #if DEBUG_OPENGL_OBJECTS 
+        std::cout << "Texture Buffer " << textureID << " was deleted." << std::endl;
+    #endif
+}
+
+void TextureBuffer::setData(const size_t size, const void* data) {
+    glBindBuffer(GL_TEXTURE_BUFFER, bufferID);
+    if (size > capacity || capacity == 0) {
+        // grow to at least double the old size so that a slowly growing buffer is not reallocated every frame
+        capacity = (size > 2 * capacity) ? size : 2 * capacity;
+        if (capacity < 16) capacity = 16;
+        glBufferData(GL_TEXTURE_BUFFER, capacity, NULL, GL_STREAM_DRAW);
+    }
+    if (size > 0) glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void TextureBuffer::bind() const {
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_BUFFER, textureID);
+}
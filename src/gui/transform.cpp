@@ -0,0 +1,82 @@
+#include "gui/transform.hpp"
+
+int TransformHierarchy::add(const int parent, const glm::vec3 pos, const glm::vec3 scale, const glm::vec3 aos, const float angle) {
+    if (parent >= (int) size()) {
+        std::cout << "ERROR::TRANSFORM_HIERARCHY::INVALID_PARENT: Node " << parent << " does not exist." << std::endl;
+        return -1;
+    }
+    if (parent != -1) nChildren[parent]++;
+
+    // a free slot can only be reused if it comes after the parent
+    for (int f = freeNodes.size() - 1; f >= 0; f--) if (freeNodes[f] > parent) {
+        int node = freeNodes[f];
+        freeNodes[f] = freeNodes.back();
+        freeNodes.pop_back();
+        parents[node] = parent;
+        positions[node] = pos;
+        scales[node] = scale;
+        axes[node] = aos;
+        angles[node] = angle;
+        nChildren[node] = 0;
+        markDirty(node);
+        return node;
+    }
+
+    parents.push_back(parent);
+    positions.push_back(pos);
+    scales.push_back(scale);
+    axes.push_back(aos);
+    angles.push_back(angle);
+    worlds.push_back(glm::mat4(1.0f));
+    normals.push_back(glm::mat3(1.0f));
+    dirty.push_back(0);
+    nChildren.push_back(0);
+
+    int node = size() - 1;
+    markDirty(node);
+    return node;
+}
+bool TransformHierarchy::remove(const int node) {
+    if (nChildren[node] > 0) return false;
+    if (parents[node] != -1) nChildren[parents[node]]--;
+    // a free slot is a clean root, so the sweep passes over it without doing anything
+    parents[node] = -1;
+    dirty[node] = 0;
+    nChildren[node] = -1;
+    freeNodes.push_back(node);
+    return true;
+}
+
+void TransformHierarchy::update() {
+    updated.clear();
+    if (firstDirty >= (int) size()) return;
+
+    for (int n = firstDirty; n < size(); n++) {
+        int parent = parents[n];
+        // a node moves with its parent, and the parent (being stored first) has already been handled
+        if (parent != -1 && dirty[parent]) dirty[n] = 1;
+        if (!dirty[n]) continue;
+
+        glm::mat4 local = glm::mat4(1.0f);
+        local = glm::translate(local, positions[n]);
+        local = glm::scale(local, scales[n]);
+        local = glm::rotate(local, angles[n], axes[n]);
+        worlds[n] = (parent == -1) ? local : worlds[parent] * local;
+        normals[n] = glm::mat3(glm::transpose(glm::inverse(worlds[n])));
+        updated.push_back(n);
+    }
+    // flags are only cleared once the sweep is over, since children read their parent's flag
+    for (int n : updated) dirty[n] = 0;
+    firstDirty = INT_MAX;
+}
+
+void TransformHierarchy::print() const {
+    std::cout << "Transform Hierarchy: " << size() - freeNodes.size() << " nodes" << std::endl;
+    for (int n = 0; n < size(); n++) if (!isFree(n)) {
+        // indent each node by its depth
+        int depth = 0;
+        for (int p = parents[n]; p != -1; p = parents[p]) depth++;
+        std::cout << std::string(depth + 1, '\t') << "Node[" << n << "]: pos (" << positions[n].x << ", " << positions[n].y << ", " <<
+                     positions[n].z << ")" << (dirty[n] ? ", dirty" : "") << std::endl;
+    }
+}
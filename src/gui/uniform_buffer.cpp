@@ -0,0 +1,37 @@
+#include "gui/uniform_buffer.hpp"
+
+const unsigned int N_UNIFORM_BLOCKS = 4;
+const std::string UNIFORM_BLOCK_NAMES[] = { "Camera", "Lights", "Shadows", "Materials" };
+
+UniformBuffer::UniformBuffer(const unsigned int binding, const size_t size) : binding(binding), size(size) {
+    // create the openGL buffer object
+    glGenBuffers(1, &bufferID);
+    #if DEBUG_OPENGL_OBJECTS
+        std::cout << "Uniform Buffer " << bufferID << " was created." << std::endl;
+    #endif
+
+    // allocate the block without filling it, data will be written each frame
+    bind();
+    glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+    unbind();
+
+    // attach the buffer to its binding point
+    bindBase();
+}
+UniformBuffer::~UniformBuffer() {
+    glDeleteBuffers(1, &bufferID);
+    #if DEBUG_OPENGL_OBJECTS
+        std::cout << "Uniform Buffer " << bufferID << " was deleted." << std::endl;
+    #endif
+}
+
+void UniformBuffer::setData(const size_t offset, const size_t size, const void* data) const {
+    if (offset + size > this->size) {
+        std::cout << "ERROR::UNIFORM_BUFFER::OUT_OF_RANGE: Write of " << size << " bytes at offset " << offset <<
+                     " exceeds block size " << this->size << "." << std::endl;
+        return;
+    }
+    bind();
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    unbind();
+}
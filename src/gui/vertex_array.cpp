@@ -1,5 +1,7 @@
 #include "gui/vertex_array.hpp"
 
+#include "gui/pool.hpp"
+
 float NULL_FUNCTION(float, float) { return 0; }
 float HILL_FUNCTION(float x, float y) {
     const float K = 1.0f;
@@ -96,10 +98,11 @@ VertexArray::VertexArray(Serializer& object)
                             static_cast<float>(object["pane_dims"][2]), static_cast<float>(object["pane_dims"][3])); } break;
     case G_PLANE: { makeHeightMap(static_cast<unsigned int>(object["resolution"]), static_cast<unsigned int>(object["function_id"])); } break;
     case G_SPHERE: { makeSphereMap(static_cast<unsigned int>(object["resolution"]), static_cast<unsigned int>(object["function_id"])); } break;
+    case G_BOX: { makeBox(); } break;
     }
 }
 
-bool VertexArray::operator==(VertexArray& other) {
+bool VertexArray::operator==(const VertexArray& other) const {
     if (draw_type == other.draw_type && geometry_type == other.geometry_type) {
         switch(geometry_type) {
         case G_SAVED: { return file_name == other.file_name; } break;
@@ -108,10 +111,33 @@ bool VertexArray::operator==(VertexArray& other) {
                    pane_dims[2] == other.pane_dims[2] && pane_dims[3] == other.pane_dims[3]; 
         } break;
         case G_PLANE: case G_SPHERE: { return resolution == other.resolution && function_id == other.function_id; } break;
+        case G_BOX: { return true; } break;
         }
     } 
     return false;
 }
+std::size_t VertexArray::hash() const {
+    std::size_t seed = 0;
+    hashCombine(seed, draw_type);
+    hashCombine(seed, geometry_type);
+    switch(geometry_type) {
+    case G_SAVED: { hashCombine(seed, file_name); } break;
+    case G_PANE: { for (float dim : pane_dims) hashCombine(seed, dim); } break;
+    case G_PLANE: case G_SPHERE: { hashCombine(seed, resolution); hashCombine(seed, function_id); } break;
+    }
+    return seed;
+}
+std::size_t VertexArray::getLayout() const {
+    std::size_t seed = 0;
+    hashCombine(seed, stride);
+    for (const std::unique_ptr<VertexAttribute>& attribute : vertexAttributes) {
+        hashCombine(seed, attribute->dimension);
+        hashCombine(seed, attribute->dataType);
+        hashCombine(seed, attribute->normalized);
+        hashCombine(seed, (std::size_t) attribute->offset);
+    }
+    return seed;
+}
 
 void VertexArray::genOpenGL() {
     // create a vertex array object in the openGL context
@@ -162,6 +188,35 @@ void VertexArray::makePane(const float cornerX, const float cornerY, const float
     activateAll();
     unbind();
 }
+void VertexArray::makeBox() {
+    draw_type = STATIC;
+    geometry_type = G_BOX;
+
+    const unsigned int N_VERTICES = 8, N_INDICES = 36;  // 8 corners, 6 faces of 2 triangles each
+    const size_t VERTEX_SIZE = 3 * sizeof(float), INDEX_SIZE = sizeof(unsigned int);
+
+    // corner i has x = +1 if bit 0 of i is set, y = +1 if bit 1 is set, and z = +1 if bit 2 is set
+    float vertices[3 * N_VERTICES];
+    for (int i = 0; i < N_VERTICES; i++) 
+        for (int axis = 0; axis < 3; axis++) vertices[3 * i + axis] = (i & (1 << axis)) ? 1.0f : -1.0f;
+    unsigned int indices[] {
+        0, 2, 1,    1, 2, 3,    // -z
+        4, 5, 6,    5, 7, 6,    // +z
+        0, 1, 4,    1, 5, 4,    // -y
+        2, 6, 3,    3, 6, 7,    // +y
+        0, 4, 2,    2, 4, 6,    // -x
+        1, 3, 5,    3, 7, 5     // +x
+    };
+
+    const void* p_vertices = &vertices, *p_indices = &indices;
+
+    bind();
+    addBuffer(VERTEX_BUFFER, p_vertices, N_VERTICES * VERTEX_SIZE, N_VERTICES);
+    addBuffer(INDEX_BUFFER, p_indices, N_INDICES * INDEX_SIZE, N_INDICES);
+    addAttribute(3, FLOAT, false);  // 3D position
+    activateAll();
+    unbind();
+}
 void VertexArray::makeHeightMap(const unsigned int resolution, float (*heightFunction)(const float, const float)) {
     /* A height map can be thought of as a grid of patches, each of which is split into two triangles. The height value of each vertex is 
      * determined by the input heighFunction as a function of the x and z grid values. 
@@ -377,6 +432,20 @@ void VertexArray::activateAll() {
         glVertexAttribPointer(i, vertexAttributes[i]->dimension, vertexAttributes[i]->dataType, vertexAttributes[i]->normalized, stride, vertexAttributes[i]->offset);
         glEnableVertexAttribArray(i);
     }
+    computeBounds();
+}
+void VertexArray::computeBounds() {
+    // positions are always the first attribute, 2D positions are treated as lying on the z = 0 plane
+    bounds = AABB();
+    if (activeVertexBuffer == -1 || vertexAttributes.size() == 0 || vertexAttributes[0]->dataType != FLOAT) return;
+    const Buffer& buffer = *buffers[activeVertexBuffer];
+    unsigned int dim = (vertexAttributes[0]->dimension < 3) ? vertexAttributes[0]->dimension : 3;
+    for (int v = 0; v < buffer.count; v++) {
+        const float* position = (const float*) ((const char*) buffer.data + v * stride + (size_t) vertexAttributes[0]->offset);
+        glm::vec3 point = glm::vec3(0.0f);
+        for (int i = 0; i < dim; i++) point[i] = position[i];
+        bounds.expand(point);
+    }
 }
 
 unsigned int VertexArray::getVertexCount() const { return (activeVertexBuffer != -1) ? buffers[activeVertexBuffer]->count : 0; }
@@ -73,6 +73,8 @@ void Window::bind() {
     //initialize GLAD using the correct OS
     ///TODO: is this a problem? IDK!
     if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) std::cout << "Failed to initialize GLAD" << std::endl;
+    // load the functions of extensions that the context supports beyond the core profile
+    r_LoadExtensions((GLADloadproc) glfwGetProcAddress);
 
     // set bound window to this
     boundWindow = this;
@@ -7,6 +7,7 @@
 #include "gui/camera.hpp"
 #include "gui/elements.hpp"
 #include "gui/frame_buffer.hpp"
+#include "gui/job_system.hpp"
 #include "gui/model.hpp"
 #include "gui/renderer.hpp"
 #include "gui/scene.hpp"
@@ -36,6 +37,9 @@ void handleKeystrokes();
 void handleCursor();
 
 int makeScene() {
+    // start the worker threads (the job system is created on first use, and the thread that creates it is the one that owns the OpenGL
+    // context)
+    JobSystem::get();
 
     // allow window to be resized
     window.enableResizing();
@@ -52,6 +56,9 @@ int makeScene() {
     scene.setPixelWidth(5);
     scene.enableAntiAliasing();
     scene.setShadowStyle(S_SHADOW_MAPPING);
+    // compare frame times with one program per material style against uber shaders (see printRenderStats() below)
+    //scene.enableUberShaders();
+    //scene.enableFrameTimer();
 
     int rWidth = window.getWidth() / 5, rHeight = window.getHeight() / 5;
     
@@ -106,6 +113,8 @@ int makeScene() {
 
     // load scene
     scene.load();
+    //scene.printWarmUpTimes();
+    //TextureCache::get().print();
     //scene.save("test.json");
 
     //scene.print();
@@ -119,6 +128,8 @@ int makeScene() {
         else {
             lastTime = window.getTime();
             std::cout << "FPS: " << frames << std::endl;
+            //scene.printRenderStats();
+            //scene.resetRenderStats();
             frames = 0;
         }
         deltaT = window.getDeltaT();
@@ -129,6 +140,10 @@ int makeScene() {
         handleCursor();                                 // handle mouse input
         camera->setAspectRatio(window.getAspectRatio()); // handle window resizing
 
+        //jobs
+        //----
+        JobSystem::get().runMainJobs();                 // run work that other threads handed back to the OpenGL thread
+
         //animations
         //----------
         float angle = 0.1 * window.getTime();
@@ -0,0 +1,50 @@
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "io/file_io.hpp"
+
+/* EMBED COMPONENTS
+ *
+ * Writes the shader component files in /res/shaders/components/ to include/gui/shader_components.hpp, so that they can be compiled into
+ * the program (see EMBED_SHADER_COMPONENTS in elements.hpp). Files are read the same way the shader template reads them at runtime
+ * (with comment blocks stripped), then written out as raw string literals. Run from the build directory, like the program itself.
+ */
+
+const char COMPONENTS_PATH[] = "../res/shaders/components/", OUTPUT_PATH[] = "../include/gui/shader_components.hpp";
+// raw string delimiter, which can't appear in a component file
+const std::string DELIMITER = "glsl";
+
+int main() {
+    if (!std::filesystem::is_directory(COMPONENTS_PATH)) {
+        std::cout << "ERROR::EMBED_COMPONENTS::MISSING_COMPONENTS: No component files found at " << COMPONENTS_PATH << "." << std::endl;
+        return 1;
+    }
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(COMPONENTS_PATH))
+        if (entry.path().extension() == ".glsl") paths.push_back(entry.path());
+    std::sort(paths.begin(), paths.end());
+
+    std::string header = "// generated by tools/embed_components.cpp from /res/shaders/components/, do not edit\n"
+                         "#ifndef SHADER_COMPONENTS_HPP\n"
+                         "#define SHADER_COMPONENTS_HPP\n\n"
+                         "// the name and text (with comment blocks stripped) of each component file\n"
+                         "const char* const EMBEDDED_COMPONENTS[][2] = {\n";
+    for (const std::filesystem::path& path : paths) {
+        std::string text;
+        f_readText(path.string(), text);
+        if (text.find(")" + DELIMITER + "\"") != std::string::npos) {
+            std::cout << "ERROR::EMBED_COMPONENTS::BAD_DELIMITER: " << path.filename().string() << " contains the raw string delimiter."
+                << std::endl;
+            return 1;
+        }
+        header += "    { \"" + path.filename().string() + "\", R\"" + DELIMITER + "(" + text + ")" + DELIMITER + "\" },\n";
+    }
+    header += "};\n\n#endif\n";
+
+    f_writeText(OUTPUT_PATH, header);
+    std::cout << "Embedded " << paths.size() << " component files in " << OUTPUT_PATH << "." << std::endl;
+    return 0;
+}
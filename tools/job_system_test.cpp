@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gui/job_system.hpp"
+
+/* JOB SYSTEM TEST
+ *
+ * Stress tests the scheduling guarantees of the job system (see job_system.hpp) on a job system of its own, many times over, so that
+ * races have a chance to show up. Build it with -fsanitize=thread to have ThreadSanitizer check every run as well. Each test checks:
+ *
+ *  - parallel for: every index is visited exactly once, and nothing runs after parallelFor() returns
+ *  - submit after: in a chain of batches, no job starts before every job of the batch it depends on has finished
+ *  - nested wait: jobs that submit jobs and wait on them (on workers as well as the main thread) finish without deadlocking
+ *  - main thread jobs: jobs given to submitMain() only ever run on the main thread, whether they are run by runMainJobs() or by a main
+ *    thread wait(), and runMainJobs() refuses to run them on a worker
+ *  - background jobs: jobs given to submitBackground(), and the jobs they submit, never run on the main thread, even while it waits on
+ *    other jobs, and a job system asked for no workers still gets one to run them
+ *
+ * Usage: job_system_test [iterations] [workers]. Returns 1 if any check failed.
+ */
+
+static unsigned int nFailed = 0;
+
+static void check(const bool condition, const std::string& test, const std::string& message) {
+    if (condition) return;
+    std::cout << "FAILED::" << test << ": " << message << std::endl;
+    nFailed++;
+}
+
+static void testParallelFor(JobSystem& jobs) {
+    const unsigned int N = 10000;
+    std::vector<std::atomic<int>> visits(N);
+    jobs.parallelFor(N, 64, [&](unsigned int i) { visits[i].fetch_add(1, std::memory_order_relaxed); });
+    // every batch has finished, so the counts can't change any more
+    unsigned int wrong = 0;
+    for (unsigned int i = 0; i < N; i++) if (visits[i].load() != 1) wrong++;
+    check(wrong == 0, "PARALLEL_FOR", std::to_string(wrong) + " indices were not visited exactly once");
+}
+
+static void testSubmitAfter(JobSystem& jobs) {
+    const unsigned int N_BATCHES = 8, BATCH_SIZE = 32;
+    // each batch counts its finished jobs, and every job checks that the batch before it was complete when it started
+    std::vector<std::unique_ptr<JobCounter>> counters;
+    std::vector<std::atomic<unsigned int>> finished(N_BATCHES);
+    std::atomic<unsigned int> early = 0;
+    for (unsigned int b = 0; b < N_BATCHES; b++) {
+        counters.push_back(std::make_unique<JobCounter>());
+        for (unsigned int j = 0; j < BATCH_SIZE; j++) {
+            auto job = [&, b]() {
+                if (b > 0 && finished[b - 1].load(std::memory_order_acquire) != BATCH_SIZE) early++;
+                finished[b].fetch_add(1, std::memory_order_release);
+            };
+            if (b == 0) jobs.submit(job, counters[b].get());
+            else jobs.submitAfter(*counters[b - 1], job, counters[b].get());
+        }
+    }
+    jobs.wait(*counters.back());
+    // the earlier counters are done too, but the job that finished them may still be queueing dependents, so wait on them before they go
+    for (auto& counter : counters) jobs.wait(*counter);
+    check(early == 0, "SUBMIT_AFTER", std::to_string(early.load()) + " jobs started before their dependency was done");
+    for (unsigned int b = 0; b < N_BATCHES; b++)
+        check(finished[b] == BATCH_SIZE, "SUBMIT_AFTER", "batch " + std::to_string(b) + " did not run every job");
+}
+
+// sum the leaves of a binary tree of jobs, where every job waits on the two jobs it submits
+static unsigned int treeSum(JobSystem& jobs, const unsigned int depth) {
+    if (depth == 0) return 1;
+    std::atomic<unsigned int> left = 0, right = 0;
+    JobCounter counter;
+    jobs.submit([&]() { left = treeSum(jobs, depth - 1); }, &counter);
+    jobs.submit([&]() { right = treeSum(jobs, depth - 1); }, &counter);
+    jobs.wait(counter);
+    return left + right;
+}
+static void testNestedWait(JobSystem& jobs) {
+    const unsigned int DEPTH = 10;
+    unsigned int sum = treeSum(jobs, DEPTH);
+    check(sum == (1u << DEPTH), "NESTED_WAIT", "the tree summed to " + std::to_string(sum) + " instead of " + std::to_string(1u << DEPTH));
+}
+
+static void testMainJobs(JobSystem& jobs) {
+    const unsigned int N = 64;
+    const std::thread::id mainThread = std::this_thread::get_id();
+    std::atomic<unsigned int> offMain = 0, ran = 0;
+    auto mainJob = [&]() {
+        if (std::this_thread::get_id() != mainThread) offMain++;
+        ran++;
+    };
+
+    // main thread jobs queued by workers, run by runMainJobs() once the workers are done
+    JobCounter queued;
+    for (unsigned int i = 0; i < N; i++) jobs.submit([&]() { jobs.submitMain(mainJob); }, &queued);
+    jobs.wait(queued);
+    jobs.runMainJobs();
+    check(ran == N, "MAIN_JOBS", "runMainJobs() ran " + std::to_string(ran.load()) + " of " + std::to_string(N) + " jobs");
+
+    // a main thread wait() runs main thread jobs, including those that it waits on (the workers queue theirs under the same counter, so
+    // they have all been queued once submitted is done)
+    ran = 0;
+    JobCounter submitted, waited;
+    for (unsigned int i = 0; i < N; i++) jobs.submit([&]() { jobs.submitMain(mainJob, &waited); }, &submitted);
+    for (unsigned int i = 0; i < N; i++) jobs.submitMain(mainJob, &waited);
+    jobs.wait(submitted);
+    jobs.wait(waited);
+    check(ran == 2 * N, "MAIN_JOBS", "wait() ran " + std::to_string(ran.load()) + " of " + std::to_string(2 * N) + " jobs");
+
+    // a worker can't run main thread jobs (it reports an error instead), so the job only runs once the main thread runs it
+    std::atomic<unsigned int> runs = 0;
+    JobCounter worker;
+    jobs.submitMain([&]() { if (std::this_thread::get_id() != mainThread) offMain++; runs++; });
+    jobs.submit([&]() { if (!jobs.isMainThread()) jobs.runMainJobs(); }, &worker);
+    jobs.wait(worker);
+    jobs.runMainJobs();
+
+    check(offMain == 0, "MAIN_JOBS", std::to_string(offMain.load()) + " main thread jobs ran on a worker");
+    check(runs == 1, "MAIN_JOBS", "a main thread job ran " + std::to_string(runs.load()) + " times");
+}
+
+static void testBackground(JobSystem& jobs) {
+    const unsigned int N = 64;
+    const std::thread::id mainThread = std::this_thread::get_id();
+    std::atomic<unsigned int> onMain = 0, ran = 0;
+    auto backgroundJob = [&]() {
+        if (std::this_thread::get_id() == mainThread) onMain++;
+        ran++;
+    };
+
+    // background jobs, and the jobs they submit (directly or after another job), are queued while the main thread waits on jobs of its
+    // own, which it would take from any deque it steals from
+    JobCounter background;
+    for (unsigned int i = 0; i < N; i++) jobs.submitBackground([&]() {
+        backgroundJob();
+        JobCounter child;
+        jobs.submit(backgroundJob, &child);
+        jobs.submitAfter(child, backgroundJob, &background);
+        jobs.wait(child);
+    }, &background);
+    for (unsigned int i = 0; i < 16; i++) jobs.parallelFor(1024, 16, [](unsigned int) {});
+    jobs.wait(background);
+    check(onMain == 0, "BACKGROUND", std::to_string(onMain.load()) + " background jobs ran on the main thread");
+    check(ran == 3 * N, "BACKGROUND", "ran " + std::to_string(ran.load()) + " of " + std::to_string(3 * N) + " background jobs");
+}
+// a job system with no workers would leave background jobs to the main thread, so it always has one
+static void testNoWorkers() {
+    JobSystem jobs(0);
+    check(jobs.nWorkers() == 1, "BACKGROUND", "a job system asked for no workers has " + std::to_string(jobs.nWorkers()));
+    testBackground(jobs);
+}
+
+int main(int argc, char** argv) {
+    unsigned int iterations = (argc > 1) ? std::stoi(argv[1]) : 100;
+    unsigned int nWorkers = (argc > 2) ? std::stoi(argv[2]) : std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+    // the job system of this test is made first, since the main thread belongs to one job system at a time
+    testNoWorkers();
+
+    JobSystem jobs(nWorkers);
+    jobs.print();
+    for (unsigned int i = 0; i < iterations && nFailed == 0; i++) {
+        testParallelFor(jobs);
+        testSubmitAfter(jobs);
+        testNestedWait(jobs);
+        testMainJobs(jobs);
+        testBackground(jobs);
+    }
+
+    if (nFailed == 0) std::cout << "Every check passed (" << iterations << " iterations, " << jobs.nWorkers() << " workers)." << std::endl;
+    return (nFailed > 0) ? 1 : 0;
+}
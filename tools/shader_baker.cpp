@@ -0,0 +1,109 @@
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include "io/serializer.hpp"
+#include "gui/elements.hpp"
+#include "gui/extensions.hpp"
+#include "gui/shader.hpp"
+#include "gui/shader_template.hpp"
+
+/* SHADER BAKER
+ *
+ * Generates every shader the parameters in elements.hpp can make and writes their source to /res/shaders/saves/ (see Shader::bake()),
+ * so that a build with REQUIRE_BAKED_SHADERS never runs the component assembler. Each combination of parameters is generated, and
+ * combinations that name the same vertex and fragment shaders (parameters that a rendering style ignores) are only baked once.
+ * Combinations that leave a placeholder undefined (e.g. a stencil output, which has no component) aren't shaders and are skipped.
+ *
+ * If an OpenGL context can be created (a hidden window, which also works with a software driver such as llvmpipe), every baked program
+ * is compiled and linked to check it for errors, unless "--no-validate" is given. The manifest (/res/shaders/saves/manifest.json) lists
+ * the parameters and file names of each baked shader, whether it was validated, and the hash of the component files it was baked from.
+ *
+ * Run from the build directory, like the program itself. Returns 1 if any program failed to build.
+ */
+
+// the number of values each parameter can take (see elements.hpp)
+const unsigned int N_RENDERING_STYLES = R_DEFERRED_LIGHTING + 1, N_OUTPUT_BUFFERS = B_STENCIL + 1, N_MATERIAL_STYLES = M_UBER + 1,
+                   N_LIGHTING_STYLES = L_ALL_ENABLED + 1, N_SHADOW_STYLES = S_SHADOW_MAPPING + 1, N_TEXTURE_STYLES = T_ARRAY_2D + 1,
+                   N_POSTPROCESSING = P_SHADOW_MAP + 1;
+
+// create a hidden window to get an OpenGL context of the version the program uses (nullptr if there is no display or driver)
+static GLFWwindow* createContext() {
+    if (!glfwInit()) return nullptr;
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, (int) VERSION);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, (int) (VERSION * 10) % 10);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    #ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    #endif
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(1, 1, "shader baker", NULL, NULL);
+    if (window == NULL) {
+        glfwTerminate();
+        return nullptr;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return nullptr;
+    }
+    r_LoadExtensions((GLADloadproc) glfwGetProcAddress);
+    return window;
+}
+
+int main(int argc, char** argv) {
+    bool validate = !(argc > 1 && std::string(argv[1]) == "--no-validate");
+    GLFWwindow* window = validate ? createContext() : nullptr;
+    if (validate && window == nullptr)
+        std::cout << "No OpenGL context could be created, shaders will be baked without being validated." << std::endl;
+
+    Serializer manifest;
+    char hash[32];
+    std::snprintf(hash, sizeof(hash), "%016llx", (unsigned long long) ShaderTemplate::get().getHash());
+    manifest["components"] = std::string(hash);
+    manifest["validated"] = (window != nullptr);
+
+    std::set<std::pair<std::string, std::string>> baked;
+    int nShaders = 0, nSkipped = 0, nFailed = 0;
+    for (unsigned int r = 0; r < N_RENDERING_STYLES; r++) for (unsigned int o = 0; o < N_OUTPUT_BUFFERS; o++)
+    for (unsigned int m = 0; m < N_MATERIAL_STYLES; m++) for (unsigned int l = 0; l < N_LIGHTING_STYLES; l++)
+    for (unsigned int s = 0; s < N_SHADOW_STYLES; s++) for (unsigned int t = 0; t < N_TEXTURE_STYLES; t++)
+    for (unsigned int p = 0; p < N_POSTPROCESSING; p++) {
+        std::unique_ptr<Shader> shader = std::make_unique<Shader>(r, o, m, l, s, t, p);
+        std::pair<std::string, std::string> names = { shader->genVertexShaderName(), shader->genFragmentShaderName() };
+        if (baked.contains(names)) continue;
+        baked.insert(names);
+
+        if (!shader->bake()) {
+            nSkipped++;
+            continue;
+        }
+        bool valid = (window == nullptr) || shader->validate();
+        if (!valid) nFailed++;
+
+        Serializer entry = shader->getJSON();
+        entry["vertex_shader"] = names.first;
+        entry["fragment_shader"] = names.second;
+        entry["valid"] = valid;
+        manifest["shaders"][nShaders++] = std::move(entry);
+    }
+    manifest.save(std::string(SHADER_SAVE_PATH) + SHADER_MANIFEST_FILE);
+
+    std::cout << "Baked " << nShaders << " shaders to " << SHADER_SAVE_PATH << " (" << nSkipped << " parameter sets skipped";
+    if (window != nullptr) std::cout << ", " << nFailed << " failed to build";
+    std::cout << ")." << std::endl;
+
+    if (window != nullptr) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+    return (nFailed > 0) ? 1 : 0;
+}
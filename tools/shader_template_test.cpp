@@ -0,0 +1,212 @@
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#include "io/file_io.hpp"
+#include "io/parser.hpp"
+#include "gui/elements.hpp"
+#include "gui/shader.hpp"
+#include "gui/shader_template.hpp"
+
+/* SHADER TEMPLATE TEST
+ *
+ * Checks that shaders generated from the shader template (see shader_template.hpp) are byte for byte the same as the shaders the string
+ * based generator made before it. The old generator is kept here as the reference: for each shader it reads the raw component files,
+ * cuts out the general and keyed snippets of each one with p_getKeyedSubstr(), gathers every section of the concatenated snippets in the
+ * order the sections appear and splices the placeholders into them one at a time. Nothing is shared with the template but the component
+ * files and the keys that the parameters pick snippets by, so a difference in how blocks or sections are parsed, ordered, or filled
+ * shows up here.
+ *
+ * Every combination of the parameters in elements.hpp is generated with Shader::generate() and compared with the reference. Combinations
+ * that the reference can't fill (e.g. a stencil output, which has no component) have to fail to generate too. Doesn't need an OpenGL
+ * context.
+ *
+ * Run from the build directory, like the program itself. Returns 1 if any source differs.
+ */
+
+// the number of values each parameter can take (see elements.hpp)
+const unsigned int N_RENDERING_STYLES = R_DEFERRED_LIGHTING + 1, N_OUTPUT_BUFFERS = B_STENCIL + 1, N_MATERIAL_STYLES = M_UBER + 1,
+                   N_LIGHTING_STYLES = L_ALL_ENABLED + 1, N_SHADOW_STYLES = S_SHADOW_MAPPING + 1, N_TEXTURE_STYLES = T_ARRAY_2D + 1,
+                   N_POSTPROCESSING = P_SHADOW_MAP + 1;
+
+// the keys and file names that shader parameters pick component snippets by (see shader.cpp)
+extern std::string GENERAL_KEY, RENDERING_KEYS[], OUTPUT_KEYS[], LIGHTING_KEYS[], SHADOW_KEYS[], MATERIAL_KEYS[], TEXTURE_KEYS[],
+                   POSTPROCESSING_KEYS[], DEPTH_PREPASS_KEY, GBUFFER_KEY, DEFERRED_MATERIAL_KEY, DEFERRED_SHADOW_KEY, RENDERING_FILE,
+                   OUTPUT_FILE, LIGHTING_FILE, MATERIAL_FILE, SHADOW_FILE, TEXTURE_FILE, POSTPROCESSING_FILE;
+// the structural keys of the sections, in the order they are written
+static const std::string STRUCTURAL_KEYS[] = { "@GLOBAL\n", "@STRUCTS\n", "@IN\n", "@OUT\n", "@UNIFORMS\n", "@FUNCTIONS\n", "@MAIN\n" };
+
+// read a component file (each file is only read once, the reference generator would read it for every shader)
+static const std::string& readComponent(const std::string& fileName) {
+    static std::unordered_map<std::string, std::string> files;
+    auto f = files.find(fileName);
+    if (f == files.end()) {
+        std::string text;
+        f = files.emplace(fileName, f_readText(SHADER_COMPONENTS_PATH + fileName, text)).first;
+    }
+    return f->second;
+}
+// append the general snippet and the keyed snippet of a component file
+static void addComponent(std::string& components, const std::string& fileName, const std::string& key) {
+    const std::string& source = readComponent(fileName);
+    if (p_hasKey(source, GENERAL_KEY)) components += p_getKeyedSubstr(source, "@@", GENERAL_KEY);
+    components += p_getKeyedSubstr(source, "@@", key);
+}
+
+// splice the placeholders marked by a flag into a section one at a time (in place), returns false if a placeholder is never defined
+static bool splicePlaceholders(std::string& section, const std::string& flag) {
+    // keeps running until there are no more of the specified flags
+    while (section.find(flag) != std::string::npos) {
+        // look for the first and second appearances of the flag. These are the opening and closing flags of the first placeholder.
+        size_t var_start = section.find(flag), var_end = section.find(flag, var_start + 1), fill_start = 0, fill_end = 0;
+        // the text contained within the flags is either the placeholder or the snippet that should replace the placeholder
+        std::string var = section.substr(var_start, var_end - var_start), fill = "";
+        // if var has a line break in it, it must be the snippet that replaces the placeholder
+        if (var.find('\n') != std::string::npos) {
+            // the placeholder is the text that occurs before the line break plus a closing flag
+            var = var.substr(0, var.find('\n')) + flag;
+            // the replacement text is everything after the line break until the closing flag
+            fill = section.substr(var_start + var.length() - flag.length() + 1,
+                                  var_end - var_start - var.length() + flag.length() - 1);
+            // erase the replacement text, then search for the placeholder and replace it with the replacement text
+            section.erase(var_start, var_end - var_start + flag.length() + 1);
+            fill_start = section.find(var);
+            if (fill_start != std::string::npos) {
+                fill_end = section.find(flag, fill_start + 1);
+                section.replace(fill_start, fill_end - fill_start + flag.length(), fill);
+            }
+        // otherwise, var is already a placeholder
+        } else {
+            // add a line break and look for the replacement text
+            var += '\n';
+            if (section.find(var) == std::string::npos) return false;
+            fill_start = section.find(var), fill_end = section.find(flag, fill_start + 1);
+            fill = section.substr(fill_start + var.length(), fill_end - fill_start - var.length());
+            // replace the placeholder with the replacement text, then account for the change in text positions and erase the replacement
+            // text
+            section.replace(var_start, var_end - var_start + flag.length(), fill);
+            size_t l = fill_end - fill_start + flag.length() + 1;
+            fill_start += (var_start < fill_start) ? fill.length() - var_end + var_start - flag.length() : 0;
+            section.erase(fill_start, l);
+        }
+    }
+    return true;
+}
+// append each section gathered from the concatenated snippets with its placeholders spliced in, returns false if a placeholder is never
+// defined
+static bool assembleSource(std::string& source, const std::string& components) {
+    bool filled = true;
+    for (const std::string& key : STRUCTURAL_KEYS) {
+        std::string section = "";
+        size_t c = components.find(key);
+        while (c != std::string::npos) {
+            section += p_getKeyedSubstr(components.substr(c), '@', key);
+            c = components.find(key, c + 1);
+        }
+        // '&' definitions can be made of "&&" references, so "&&" placeholders are spliced first
+        filled = splicePlaceholders(section, "&&") && filled;
+        filled = splicePlaceholders(section, "&") && filled;
+        if (section.length() > 0) source += '\n' + section;
+    }
+    return filled;
+}
+
+static std::string getVersion() {
+    std::string version = "#version " + std::to_string((int) (VERSION * 100)) + " ";
+    switch(PROFILE) {
+    case P_CORE: { version += "core"; } break;
+    }
+    return version + "\n";
+}
+// the reference vertex and fragment sources of a shader
+static std::string spliceVertexShader(const Shader& shader, bool& filled) {
+    std::string source = getVersion(), components = "";
+    addComponent(components, "v_" + RENDERING_FILE,
+                 (shader.isDepthPrepass()) ? DEPTH_PREPASS_KEY : RENDERING_KEYS[shader.getVertexStyle()]);
+    addComponent(components, "v_" + TEXTURE_FILE, TEXTURE_KEYS[shader.getTextureStyle()]);
+    if (shader.getVertexStyle() == R_LIGHTING_3D && !shader.isDepthPrepass())
+        addComponent(components, "v_" + SHADOW_FILE, SHADOW_KEYS[shader.getShadowStyle()]);
+    filled = assembleSource(source, components);
+
+    // layout positions are numbered in the order they appear
+    size_t c = 0, pos = source.find('$');
+    while (pos != std::string::npos) {
+        source.replace(pos, 1, std::to_string(c++));
+        pos = source.find('$');
+    }
+    return source;
+}
+static std::string spliceFragmentShader(const Shader& shader, bool& filled) {
+    std::string source = getVersion(), components = "";
+    const unsigned int renderingStyle = shader.getRenderingStyle();
+    if (shader.isDepthPrepass()) {
+        addComponent(components, "f_" + OUTPUT_FILE, DEPTH_PREPASS_KEY);
+    } else if (renderingStyle == R_GBUFFER_3D) {
+        addComponent(components, "f_" + RENDERING_FILE, RENDERING_KEYS[renderingStyle]);
+        addComponent(components, "f_" + TEXTURE_FILE, TEXTURE_KEYS[shader.getTextureStyle()]);
+        addComponent(components, "f_" + MATERIAL_FILE, MATERIAL_KEYS[shader.getMaterialStyle()]);
+        addComponent(components, "f_" + OUTPUT_FILE, GBUFFER_KEY);
+    } else {
+        addComponent(components, "f_" + RENDERING_FILE, RENDERING_KEYS[renderingStyle]);
+        addComponent(components, "f_" + OUTPUT_FILE, OUTPUT_KEYS[shader.getOutputBuffer()]);
+        addComponent(components, "f_" + TEXTURE_FILE, TEXTURE_KEYS[shader.getTextureStyle()]);
+        if (renderingStyle == R_LIGHTING_3D) {
+            addComponent(components, "f_" + LIGHTING_FILE, LIGHTING_KEYS[shader.getLightingStyle()]);
+            addComponent(components, "f_" + SHADOW_FILE, SHADOW_KEYS[shader.getShadowStyle()]);
+            addComponent(components, "f_" + MATERIAL_FILE, MATERIAL_KEYS[shader.getMaterialStyle()]);
+        } else if (renderingStyle == R_DEFERRED_LIGHTING) {
+            addComponent(components, "f_" + LIGHTING_FILE, LIGHTING_KEYS[shader.getLightingStyle()]);
+            addComponent(components, "f_" + SHADOW_FILE,
+                         (shader.getShadowStyle() == S_SHADOW_MAPPING) ? DEFERRED_SHADOW_KEY : SHADOW_KEYS[shader.getShadowStyle()]);
+            addComponent(components, "f_" + MATERIAL_FILE, DEFERRED_MATERIAL_KEY);
+        } else addComponent(components, "f_" + POSTPROCESSING_FILE, POSTPROCESSING_KEYS[shader.getPostprocessing()]);
+    }
+    filled = assembleSource(source, components);
+    return source;
+}
+
+// compare a generated source with the reference (counting the sources that differ)
+static void compare(const std::string& generated, const std::string& spliced, const std::string& name, unsigned int& nFailed) {
+    if (generated == spliced) return;
+    size_t c = 0;
+    while (c < generated.length() && c < spliced.length() && generated[c] == spliced[c]) c++;
+    std::cout << "FAILED::" << name << ": the sources differ from character " << c << " (" << generated.length()
+        << " characters generated, " << spliced.length() << " spliced)." << std::endl;
+    nFailed++;
+}
+
+int main() {
+    unsigned int nSources = 0, nFailed = 0;
+    for (unsigned int r = 0; r < N_RENDERING_STYLES; r++) for (unsigned int o = 0; o < N_OUTPUT_BUFFERS; o++)
+    for (unsigned int m = 0; m < N_MATERIAL_STYLES; m++) for (unsigned int l = 0; l < N_LIGHTING_STYLES; l++)
+    for (unsigned int s = 0; s < N_SHADOW_STYLES; s++) for (unsigned int t = 0; t < N_TEXTURE_STYLES; t++)
+    for (unsigned int p = 0; p < N_POSTPROCESSING; p++) {
+        std::unique_ptr<Shader> shader = std::make_unique<Shader>(r, o, m, l, s, t, p);
+        // the template reports the placeholders of shaders that can't be filled, which aren't failures here
+        std::ostringstream errors;
+        std::streambuf* out = std::cout.rdbuf(errors.rdbuf());
+        bool generated = shader->generate();
+        std::cout.rdbuf(out);
+
+        bool vFilled = false, fFilled = false;
+        std::string vSource = spliceVertexShader(*shader, vFilled), fSource = spliceFragmentShader(*shader, fFilled);
+        std::string name = shader->genVertexShaderName() + ", " + shader->genFragmentShaderName();
+        if (generated && !(vFilled && fFilled)) {
+            std::cout << "FAILED::" << name << ": generated a shader that can't be spliced." << std::endl;
+            nFailed++;
+        } else if (!generated && vFilled && fFilled) {
+            std::cout << "FAILED::" << name << ": couldn't generate the shader:\n" << errors.str();
+            nFailed++;
+        }
+        // sources that can't be filled are written differently (the template leaves their sections unfilled)
+        if (vFilled) compare(shader->getVertexSource(), vSource, shader->genVertexShaderName(), nFailed);
+        if (fFilled) compare(shader->getFragmentSource(), fSource, shader->genFragmentShaderName(), nFailed);
+        nSources += 2;
+    }
+
+    if (nFailed == 0) std::cout << "Every source matched (" << nSources << " sources)." << std::endl;
+    else std::cout << nFailed << " checks failed (" << nSources << " sources)." << std::endl;
+    return (nFailed > 0) ? 1 : 0;
+}